@@ -249,20 +249,58 @@ public:
 
             // Compute generalized forces from muscles.
             const auto& momArms = _momentArms[i_mesh];
-            genForce += momArms.template cast<adouble>() * muscleForces;
+            genForce += momArms.template cast<T>() * muscleForces;
         }
 
         // Achieve the motion.
         // ===================
-        out.path = _desiredMoments.col(i_mesh).template cast<adouble>()
+        out.path = _desiredMoments.col(i_mesh).template cast<T>()
                  - genForce;
     }
+    bool calc_differential_algebraic_equations_jacobian(
+            const tropter::Input<T>& in,
+            tropter::OutputJacobian<T> out) const override {
+        const auto& i_mesh = in.mesh_index;
+
+        // The net generalized forces are linear in the controls, so the
+        // Jacobian does not depend on the controls.
+        for (Eigen::Index i_act = 0; i_act < _numCoordActuators; ++i_act) {
+            out.path_controls(_coordActuatorDOFs[i_act], i_act)
+                    = -_optimalForce[i_act];
+        }
+        if (_numMuscles) {
+            // With a rigid tendon, muscle force is affine in activation.
+            tropter::VectorX<T> muscleForceSlopes(_numMuscles);
+            for (Eigen::Index i_act = 0; i_act < _numMuscles; ++i_act) {
+                const T& musTenLen = _muscleTendonLengths(i_act, i_mesh);
+                const T& musTenVel = _muscleTendonVelocities(i_act, i_mesh);
+                const auto& muscle = _muscles[i_act];
+                muscleForceSlopes[i_act] =
+                        muscle.calcRigidTendonFiberForceAlongTendon(
+                                1.0, musTenLen, musTenVel)
+                        - muscle.calcRigidTendonFiberForceAlongTendon(
+                                0.0, musTenLen, musTenVel);
+            }
+            const auto& momArms = _momentArms[i_mesh];
+            out.path_controls.rightCols(_numMuscles) =
+                    -momArms.template cast<T>()
+                    * muscleForceSlopes.asDiagonal();
+        }
+        return true;
+    }
     void calc_integral_cost(const tropter::Input<T>& in,
             T& integrand) const override {
 
         const auto& controls = in.controls;
         integrand = controls.squaredNorm();
     }
+    bool calc_integral_cost_gradient(const tropter::Input<T>& in,
+            Eigen::Ref<tropter::VectorX<T>>,
+            Eigen::Ref<tropter::VectorX<T>> controls_gradient,
+            Eigen::Ref<tropter::VectorX<T>>) const override {
+        controls_gradient = 2 * in.controls;
+        return true;
+    }
     GlobalStaticOptimization::Solution deconstruct_iterate(
             const tropter::Iterate& ocpVars) const {
 
@@ -365,12 +403,40 @@ private:
     std::vector<DeGrooteFregly2016MuscleStandalone<T>> _muscles;
 };
 
+/// Create and solve the optimal control problem. The scalar type determines
+/// how the derivatives are computed: double for the derivatives provided by
+/// the problem, or adouble for ADOL-C.
+template<typename T>
+static GlobalStaticOptimization::Solution solveGSOProblem(
+        const GlobalStaticOptimization& mrs, const Model& model,
+        const InverseMuscleSolverMotionData& motionData, int numMeshPoints) {
+    auto ocp = std::make_shared<GSOProblemSeparate<T>>(mrs, model,
+            motionData);
+    ocp->print_description();
+    tropter::DirectCollocationSolver<T> dircol(ocp, "trapezoidal",
+            "ipopt", numMeshPoints);
+    tropter::Solution ocp_solution = dircol.solve();
+    // TODO remove
+    ocp_solution.write("GlobalStaticOptimization_OCP_solution.csv");
+    // dircol.print_constraint_values(ocp_solution);
+    return ocp->deconstruct_iterate(ocp_solution);
+}
+
+GlobalStaticOptimization::GlobalStaticOptimization() {
+    constructProperties();
+}
+
 GlobalStaticOptimization::GlobalStaticOptimization(
         const std::string& setupFilePath) :
         InverseMuscleSolver(setupFilePath) {
+    constructProperties();
     updateFromXMLDocument();
 }
 
+void GlobalStaticOptimization::constructProperties() {
+    constructProperty_derivative_method("provided");
+}
+
 GlobalStaticOptimization::Solution
 GlobalStaticOptimization::solve() const {
 
@@ -517,19 +583,18 @@ GlobalStaticOptimization::solve() const {
 
     // Solve the optimal control problem.
     // ----------------------------------
-    auto ocp = std::make_shared<GSOProblemSeparate<adouble>>(*this, model,
-            motionData);
-    ocp->print_description();
-    tropter::DirectCollocationSolver<adouble> dircol(ocp, "trapezoidal",
-            "ipopt", numMeshPoints);
-    tropter::Solution ocp_solution = dircol.solve();
+    OPENSIM_THROW_IF(get_derivative_method() != "provided" &&
+                     get_derivative_method() != "adolc",
+            Exception, "Invalid value (" + get_derivative_method() + ") for "
+            "derivative_method; should be 'provided' or 'adolc'.");
+    // With the provided derivatives, we need not record a tape.
+    Solution solution = get_derivative_method() == "provided"
+            ? solveGSOProblem<double>(*this, model, motionData, numMeshPoints)
+            : solveGSOProblem<adouble>(*this, model, motionData,
+                    numMeshPoints);
 
     // Return the solution.
     // --------------------
-    // TODO remove
-    ocp_solution.write("GlobalStaticOptimization_OCP_solution.csv");
-    // dircol.print_constraint_values(ocp_solution);
-    Solution solution = ocp->deconstruct_iterate(ocp_solution);
     if (get_write_solution() != "false") {
         IO::makeDir(get_write_solution());
         std::string prefix = getName().empty() ?
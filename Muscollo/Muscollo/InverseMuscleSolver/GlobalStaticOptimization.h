@@ -31,6 +31,14 @@ class OSIMMUSCOLLO_API GlobalStaticOptimization : public InverseMuscleSolver {
             InverseMuscleSolver);
 public:
 
+    OpenSim_DECLARE_PROPERTY(derivative_method, std::string,
+        "How the optimizer obtains derivatives. "
+        "'provided': the problem provides the Jacobian of its constraints and "
+                "the gradient of its cost; the Hessian is obtained from finite "
+                "differences of these. "
+        "'adolc': automatic differentiation with ADOL-C. "
+        "Default: 'provided'.");
+
     // TODO rename to Iterate?
     struct OSIMMUSCOLLO_API Solution {
         /// The activation trajectories for all enabled (appliesForce) muscles.
@@ -59,7 +67,7 @@ public:
         void write(const std::string& prefix) const;
     };
 
-    GlobalStaticOptimization() = default;
+    GlobalStaticOptimization();
 
     /// Load a solver from an XML setup file.
     ///
@@ -80,6 +88,9 @@ public:
     ///     length, fiber velocity, tendon force, and other control signals.
     Solution solve() const;
 
+private:
+    void constructProperties();
+
 };
 
 } // namespace OpenSim
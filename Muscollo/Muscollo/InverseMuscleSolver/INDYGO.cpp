@@ -647,6 +647,39 @@ private:
     std::vector<DeGrooteFregly2016MuscleStandalone<T>> _muscles;
 };
 
+/// Create and solve the optimal control problem. The scalar type determines
+/// how the derivatives are computed: adouble for ADOL-C, or double for
+/// finite differences. If `mrsGuess` is null, the guess is formed from the
+/// bounds.
+template<typename T>
+static INDYGO::Solution solveINDYGOProblem(const INDYGO& mrs,
+        const Model& model, const InverseMuscleSolverMotionData& motionData,
+        int numMeshPoints, const INDYGO::Solution* mrsGuess) {
+    auto ocp = std::make_shared<INDYGOProblemSeparate<T>>(mrs,
+            model, motionData, mrs.get_fiber_dynamics_mode());
+    ocp->print_description();
+    tropter::DirectCollocationSolver<T> dircol(ocp, "trapezoidal",
+            "ipopt", numMeshPoints);
+    // TODO Consider trying using the quasi-Newton mode; it seems to work
+    // well for some problems but not well for larger problems.
+    // dircol.get_opt_solver().set_hessian_approximation("limited-memory");
+    std::cout << std::string(79, '=') << std::endl;
+    std::cout << "Running the Muscle Redundancy Solver." << std::endl;
+    std::cout << std::string(79, '-') << std::endl;
+    tropter::Solution ocp_solution;
+    if (mrsGuess) {
+        tropter::Iterate guess = ocp->construct_iterate(*mrsGuess);
+        // guess.write("DEBUG_INDYGO_guess.csv");
+        ocp_solution = dircol.solve(guess);
+    } else {
+        ocp_solution = dircol.solve();
+    }
+    // TODO remove:
+    ocp_solution.write("INDYGO_OCP_solution.csv");
+    // dircol.print_constraint_values(ocp_solution);
+    return ocp->deconstruct_iterate(ocp_solution);
+}
+
 INDYGO::INDYGO() {
     constructProperties();
 }
@@ -662,6 +695,7 @@ void INDYGO::constructProperties() {
     constructProperty_zero_initial_activation(false);
     constructProperty_fiber_dynamics_mode("fiber_length");
     constructProperty_activation_dynamics_mode("explicit");
+    constructProperty_derivative_method("adolc");
 }
 
 INDYGO::Solution INDYGO::solve() const {
@@ -843,10 +877,10 @@ INDYGO::Solution INDYGO::solve() const {
     OPENSIM_THROW_IF(get_activation_dynamics_mode() == "implicit", Exception,
             "Implicit activation dynamics is not supported yet.");
 
-    // Create the optimal control problem.
-    // -----------------------------------
-    auto ocp = std::make_shared<INDYGOProblemSeparate<adouble>>(*this,
-            model, motionData, get_fiber_dynamics_mode());
+    OPENSIM_THROW_IF(get_derivative_method() != "adolc" &&
+                     get_derivative_method() != "finite_difference",
+            Exception, "Invalid value (" + get_derivative_method() + ") for "
+            "derivative_method; should be 'adolc' or 'finite_difference'.");
 
     // Solve for an initial guess with static optimization.
     // ----------------------------------------------------
@@ -854,7 +888,7 @@ INDYGO::Solution INDYGO::solve() const {
                      get_initial_guess() != "static_optimization", Exception,
             "Invalid value (" + get_initial_guess() + ") for "
             "initial_guess; should be 'static_optimization' or 'bounds'.");
-    tropter::Iterate guess;
+    INDYGO::Solution mrsGuess;
     if (get_initial_guess() == "static_optimization") {
         std::cout << std::string(79, '=') << std::endl;
         std::cout << "Computing an initial guess with static optimization."
@@ -889,7 +923,6 @@ INDYGO::Solution INDYGO::solve() const {
         // Convert the static optimization solution into a guess.
         GlobalStaticOptimization::Solution gsoSolution = gso.solve();
         // gsoSolution.write("DEBUG_INDYGO_GSO_solution");
-        INDYGO::Solution mrsGuess;
         mrsGuess.excitation = gsoSolution.activation;
         mrsGuess.activation = gsoSolution.activation;
         mrsGuess.norm_fiber_length = gsoSolution.norm_fiber_length;
@@ -901,8 +934,6 @@ INDYGO::Solution INDYGO::solve() const {
         // zero (after getting a table with the correct dimensions).
         mrsGuess.tendon_force_rate_control = gsoSolution.norm_tendon_force;
         mrsGuess.tendon_force_rate_control.updMatrix().setToZero();
-        guess = ocp->construct_iterate(mrsGuess);
-        // guess.write("DEBUG_INDYGO_guess.csv");
     } else {
         // This is the behavior if no guess is provided.
         std::cout << std::string(79, '=') << std::endl;
@@ -916,32 +947,16 @@ INDYGO::Solution INDYGO::solve() const {
 
     // Solve the optimal control problem.
     // ----------------------------------
-    ocp->print_description();
-    tropter::DirectCollocationSolver<adouble> dircol(ocp, "trapezoidal",
-            "ipopt", numMeshPoints);
-    // TODO Consider trying using the quasi-Newton mode; it seems to work
-    // well for some problems but not well for larger problems.
-    // dircol.get_opt_solver().set_hessian_approximation("limited-memory");
-    std::cout << std::string(79, '=') << std::endl;
-    std::cout << "Running the Muscle Redundancy Solver." << std::endl;
-    std::cout << std::string(79, '-') << std::endl;
-    tropter::Solution ocp_solution;
-    if (get_initial_guess() == "static_optimization") {
-        ocp_solution = dircol.solve(guess);
-    } else if (get_initial_guess() == "bounds") {
-        ocp_solution = dircol.solve();
-    } else {
-        OPENSIM_THROW_FRMOBJ(Exception, "Expected 'initial_guess' property "
-                "to be 'static_optimization or 'bounds', but got '"
-                + get_initial_guess() + "'.");
-    }
+    const INDYGO::Solution* guess =
+            get_initial_guess() == "static_optimization" ? &mrsGuess : nullptr;
+    Solution solution = get_derivative_method() == "adolc"
+            ? solveINDYGOProblem<adouble>(*this, model, motionData,
+                    numMeshPoints, guess)
+            : solveINDYGOProblem<double>(*this, model, motionData,
+                    numMeshPoints, guess);
 
     // Return the solution.
     // --------------------
-    // TODO remove:
-    ocp_solution.write("INDYGO_OCP_solution.csv");
-    // dircol.print_constraint_values(ocp_solution);
-    Solution solution = ocp->deconstruct_iterate(ocp_solution);
     if (get_write_solution() != "false") {
         IO::makeDir(get_write_solution());
         std::string prefix = getName().empty() ? "INDYGO" : getName();
@@ -167,6 +167,13 @@ public:
         "The implicit mode may be up to 2 times faster. "
         "Default: 'explicit'.");
 
+    OpenSim_DECLARE_PROPERTY(derivative_method, std::string,
+        "How the optimizer obtains derivatives. "
+        "'adolc': automatic differentiation with ADOL-C. "
+        "'finite_difference': finite differences of the constraints and "
+                "objective, without recording ADOL-C tapes. "
+        "Default: 'adolc'.");
+
     struct OSIMMUSCOLLO_API Solution {
         /// The excitation trajectories for all enabled (appliesForce) muscles.
         /// This will be empty if there are no enabled muscles.
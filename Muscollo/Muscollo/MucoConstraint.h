@@ -273,6 +273,11 @@ public:
 
     /// For use by solvers. This also performs error checks on the Problem.
     void initialize(const Model& model, const int& pathConstraintIndex) const;
+    /// For use by solvers. The stage to which the state must be realized
+    /// before calling calcPathConstraintErrors().
+    SimTK::Stage getStageDependency() const {
+        return getStageDependencyImpl();
+    }
     
 protected:
     OpenSim_DECLARE_UNNAMED_PROPERTY(MucoConstraintInfo, "The bounds and "
@@ -294,11 +299,13 @@ protected:
         const_cast<MucoPathConstraint*>(this)
             ->updConstraintInfo().setNumEquations(numEqs);
     }
-    /// @precondition The state is realized to SimTK::Stage::Position.
-    /// If you need access to the controls, you must realize to Velocity:
-    /// @code
-    /// getModel().realizeVelocity(state);
-    /// @endcode
+    /// By default, the state is realized to Velocity with the controls set.
+    /// Override this to request a lower stage or Acceleration.
+    virtual SimTK::Stage getStageDependencyImpl() const {
+        return SimTK::Stage::Velocity;
+    }
+    /// @precondition The state is realized to the stage returned by
+    /// getStageDependencyImpl() (SimTK::Stage::Velocity by default).
     virtual void calcPathConstraintErrorsImpl(const SimTK::State& state,
         SimTK::Vector& errors) const = 0;
     /// For use within virtual function implementations.
@@ -98,7 +98,6 @@ void MucoControlCost::initializeImpl() const {
 
 void MucoControlCost::calcIntegralCostImpl(const SimTK::State& state,
         double& integrand) const {
-    getModel().realizeVelocity(state); // TODO would avoid this, ideally.
     const auto& controls = getModel().getControls(state);
     integrand = 0;
     assert((int)m_weights.size() == controls.size());
@@ -106,3 +105,20 @@ void MucoControlCost::calcIntegralCostImpl(const SimTK::State& state,
         integrand += m_weights[i] * controls[i] * controls[i];
     }
 }
+
+bool MucoControlCost::getDependenciesImpl(std::vector<int>&,
+        std::vector<int>& controlIndices) const {
+    for (int i = 0; i < (int)m_weights.size(); ++i) {
+        if (m_weights[i] != 0) controlIndices.push_back(i);
+    }
+    return true;
+}
+
+void MucoControlCost::calcIntegralCostGradientImpl(const SimTK::State& state,
+        int, SimTK::Vector&, SimTK::Vector& controlGradient) const {
+    const auto& controls = getModel().getControls(state);
+    assert(controlGradient.size() == controls.size());
+    for (int i = 0; i < controls.size(); ++i) {
+        controlGradient[i] = 2 * m_weights[i] * controls[i];
+    }
+}
@@ -41,8 +41,18 @@ public:
     void setWeight(const std::string& controlName, const double& weight);
 protected:
     void initializeImpl() const override;
+    SimTK::Stage getStageDependencyImpl() const override {
+        return SimTK::Stage::Velocity;
+    }
+    bool hasEndpointCostImpl() const override { return false; }
     void calcIntegralCostImpl(const SimTK::State& state,
             double& integrand) const override;
+    bool hasIntegralCostGradientImpl() const override { return true; }
+    void calcIntegralCostGradientImpl(const SimTK::State& state,
+            int meshIndex, SimTK::Vector& stateGradient,
+            SimTK::Vector& controlGradient) const override;
+    bool getDependenciesImpl(std::vector<int>& stateIndices,
+            std::vector<int>& controlIndices) const override;
 private:
     void constructProperties();
     OpenSim_DECLARE_PROPERTY(control_weights, MucoWeightSet,
@@ -28,8 +28,6 @@ namespace OpenSim {
 
 class Model;
 
-// TODO give option to specify gradient and hessian analytically.
-
 /// A term in the cost functional, to be minimized.
 /// @ingroup mucocost
 class OSIMMUSCOLLO_API MucoCost : public Object {
@@ -40,12 +38,29 @@ public:
 
     MucoCost();
 
-    /// This includes the weight.
-    SimTK::Real calcIntegralCost(const SimTK::State& state) const {
+    /// This includes the weight. The mesh index (see initializeOnMesh()) is
+    /// ignored if the time of the state does not match.
+    SimTK::Real calcIntegralCost(const SimTK::State& state,
+            int meshIndex = -1) const {
         double integrand = 0;
-        calcIntegralCostImpl(state, integrand);
+        calcIntegralCostOnMeshImpl(state, validateMeshIndex(state, meshIndex),
+                integrand);
         return get_weight() * integrand;
     }
+    /// For use by solvers. Add the weighted gradient of the integrand with
+    /// respect to Y and the model's controls to the provided vectors.
+    void calcIntegralCostGradient(const SimTK::State& state, int meshIndex,
+            SimTK::Vector& stateGradient,
+            SimTK::Vector& controlGradient) const {
+        m_state_gradient.resize(stateGradient.size());
+        m_state_gradient = 0;
+        m_control_gradient.resize(controlGradient.size());
+        m_control_gradient = 0;
+        calcIntegralCostGradientImpl(state, validateMeshIndex(state, meshIndex),
+                m_state_gradient, m_control_gradient);
+        stateGradient += get_weight() * m_state_gradient;
+        controlGradient += get_weight() * m_control_gradient;
+    }
     /// This includes the weight.
     // We use SimTK::Real instead of double for when we support adoubles.
     SimTK::Real calcEndpointCost(const SimTK::State& finalState) const {
@@ -54,9 +69,44 @@ public:
         return get_weight() * cost;
     }
     /// For use by solvers. This also performs error checks on the Problem.
+    /// This does nothing if the model and properties have not changed.
     void initialize(const Model& model) const {
+        if (m_model.get() == &model && isObjectUpToDateWithProperties()) {
+            return;
+        }
         m_model.reset(&model);
+        m_mesh_times.clear();
         initializeImpl();
+        const_cast<MucoCost*>(this)->setObjectIsUpToDateWithProperties();
+    }
+    /// For use by solvers. Provide the mesh times (empty if not known before
+    /// solving) so the cost can precompute quantities at the mesh points.
+    void initializeOnMesh(const SimTK::Vector& meshTimes) const {
+        m_mesh_times = meshTimes;
+        initializeOnMeshImpl();
+    }
+    /// For use by solvers. The stage to which the state must be realized
+    /// before calling calcIntegralCost() or calcEndpointCost().
+    SimTK::Stage getStageDependency() const {
+        return getStageDependencyImpl();
+    }
+    /// For use by solvers. Solvers need not evaluate calcIntegralCost() if
+    /// this is false.
+    bool hasIntegralCost() const { return hasIntegralCostImpl(); }
+    /// For use by solvers. Solvers need not evaluate calcEndpointCost() if
+    /// this is false.
+    bool hasEndpointCost() const { return hasEndpointCostImpl(); }
+    /// For use by solvers. If true, use calcIntegralCostGradient() instead of
+    /// finite differences.
+    bool hasIntegralCostGradient() const {
+        return hasIntegralCost() && hasIntegralCostGradientImpl();
+    }
+    /// For use by solvers. Append the indices (in Y and the model's controls)
+    /// of the variables the cost depends on and return true, or return false
+    /// if the cost may depend on all variables.
+    bool getDependencies(std::vector<int>& stateIndices,
+            std::vector<int>& controlIndices) const {
+        return getDependenciesImpl(stateIndices, controlIndices);
     }
 
     /// Print the name, type, and weight for this cost.
@@ -64,18 +114,54 @@ public:
 
 protected:
     /// Perform any caching. Make sure to first clear any caches, as this is
-    /// invoked every time the problem is solved.
+    /// invoked whenever the model or a property of the cost has changed.
+    /// Only use the cost's properties and the model (not other member
+    /// variables) to determine the cache, unless modifying those member
+    /// variables also modifies a property.
     /// Upon entry, getModel() is available.
     /// Use this opportunity to check for errors in user input.
     virtual void initializeImpl() const {}
-    /// @precondition The state is realized to SimTK::Stage::Position.
-    /// If you need access to the controls, you must realize to Velocity:
-    /// @code
-    /// getModel().realizeVelocity(state);
-    /// @endcode
+    /// By default, the state is realized to Velocity with the controls set.
+    /// Override this to request a lower stage (e.g., Position if the cost does
+    /// not use the controls) or Acceleration.
+    virtual SimTK::Stage getStageDependencyImpl() const {
+        return SimTK::Stage::Velocity;
+    }
+    /// Override this to return false if the cost does not implement
+    /// calcIntegralCostImpl().
+    virtual bool hasIntegralCostImpl() const { return true; }
+    /// Override this to return false if the cost does not implement
+    /// calcEndpointCostImpl().
+    virtual bool hasEndpointCostImpl() const { return true; }
+    /// Perform any caching that depends on getMeshTimes() (may be empty).
+    virtual void initializeOnMeshImpl() const {}
+    /// @precondition The state is realized to the stage returned by
+    /// getStageDependencyImpl() (SimTK::Stage::Velocity by default).
     virtual void calcIntegralCostImpl(const SimTK::State& state,
             double& integrand) const;
+    /// Override this instead of calcIntegralCostImpl() to use quantities
+    /// precomputed at `getMeshTimes()[meshIndex]`; `meshIndex` may be -1.
+    virtual void calcIntegralCostOnMeshImpl(const SimTK::State& state,
+            int /*meshIndex*/, double& integrand) const {
+        calcIntegralCostImpl(state, integrand);
+    }
+    /// Override this to return true if the cost implements
+    /// calcIntegralCostGradientImpl().
+    virtual bool hasIntegralCostGradientImpl() const { return false; }
+    /// The gradient of the unweighted integrand with respect to Y and the
+    /// model's controls. Both vectors are sized and zeroed upon entry.
+    virtual void calcIntegralCostGradientImpl(const SimTK::State&,
+            int /*meshIndex*/, SimTK::Vector& /*stateGradient*/,
+            SimTK::Vector& /*controlGradient*/) const {}
+    /// Override this to declare (see getDependencies()) every variable the
+    /// cost depends on; extra or repeated indices are okay.
+    virtual bool getDependenciesImpl(std::vector<int>& /*stateIndices*/,
+            std::vector<int>& /*controlIndices*/) const {
+        return false;
+    }
     /// The endpoint cost cannot depend on actuator controls.
+    /// @precondition The state is realized to the stage returned by
+    /// getStageDependencyImpl().
     virtual void calcEndpointCostImpl(const SimTK::State& finalState,
             SimTK::Real& cost) const;
     /// For use within virtual function implementations.
@@ -84,10 +170,33 @@ protected:
                 "Model is not available until the start of initializing.");
         return m_model.getRef();
     }
+    /// The mesh times passed to initializeOnMesh(); may be empty.
+    const SimTK::Vector& getMeshTimes() const { return m_mesh_times; }
 private:
     void constructProperties();
 
+    /// Cause the next call to initialize() to initialize the cost, even if
+    /// the model and the properties have not changed.
+    void clearInitialization() const { m_model.reset(); }
+    // MucoPhase clears the initialization if the phase (e.g., its model)
+    // has changed.
+    friend class MucoPhase;
+
+    /// The mesh index if it corresponds to the time of the state, and -1
+    /// otherwise.
+    int validateMeshIndex(const SimTK::State& state, int meshIndex) const {
+        if (meshIndex >= m_mesh_times.size() ||
+                (meshIndex >= 0 && !SimTK::isNumericallyEqual(
+                        state.getTime(), m_mesh_times[meshIndex]))) {
+            return -1;
+        }
+        return meshIndex;
+    }
+
     mutable SimTK::ReferencePtr<const Model> m_model;
+    mutable SimTK::Vector m_mesh_times;
+    mutable SimTK::Vector m_state_gradient;
+    mutable SimTK::Vector m_control_gradient;
 
 };
 
@@ -102,10 +211,19 @@ inline void MucoCost::calcEndpointCostImpl(const SimTK::State&,
 class OSIMMUSCOLLO_API MucoFinalTimeCost : public MucoCost {
 OpenSim_DECLARE_CONCRETE_OBJECT(MucoFinalTimeCost, MucoCost);
 protected:
+    SimTK::Stage getStageDependencyImpl() const override {
+        return SimTK::Stage::Time;
+    }
+    bool hasIntegralCostImpl() const override { return false; }
     void calcEndpointCostImpl(const SimTK::State& finalState,
             SimTK::Real& cost) const override {
         cost = finalState.getTime();
     }
+    /// This cost does not depend on any state variables or controls.
+    bool getDependenciesImpl(std::vector<int>&,
+            std::vector<int>&) const override {
+        return true;
+    }
 };
 
 
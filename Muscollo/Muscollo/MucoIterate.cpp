@@ -23,6 +23,8 @@
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Simulation/Model/Model.h>
 
+#include <sstream>
+
 using namespace OpenSim;
 
 MucoIterate::MucoIterate(const SimTK::Vector& time,
@@ -129,6 +131,22 @@ void MucoIterate::setParameter(const std::string& name,
     m_parameters.updElt(0, index) = value;
 }
 
+void MucoIterate::setDuals(const SimTK::Vector& variableLowerBoundDuals,
+        const SimTK::Vector& variableUpperBoundDuals,
+        const SimTK::Vector& constraintDuals) {
+    ensureUnsealed();
+    OPENSIM_THROW_IF(
+            variableLowerBoundDuals.size() != variableUpperBoundDuals.size(),
+            Exception,
+            "Expected the lower and upper bound duals to have the same "
+            "length, but they have lengths " +
+            std::to_string(variableLowerBoundDuals.size()) + " and " +
+            std::to_string(variableUpperBoundDuals.size()) + ".");
+    m_variable_lower_bound_duals = variableLowerBoundDuals;
+    m_variable_upper_bound_duals = variableUpperBoundDuals;
+    m_constraint_duals = constraintDuals;
+}
+
 void MucoIterate::setStatesTrajectory(const TimeSeriesTable& states,
         bool allowMissingColumns, bool allowExtraColumns) {
     ensureUnsealed();
@@ -230,6 +248,7 @@ double MucoIterate::resampleWithNumTimes(int numTimes) {
     m_states.resize(numTimes, numStates);
     m_controls.resize(numTimes, numControls);
     m_multipliers.resize(numTimes, numMultipliers);
+    clearDuals();
     SimTK::Vector time(1);
     for (int itime = 0; itime < m_time.size(); ++itime) {
         time[0] = m_time[itime];
@@ -263,6 +282,28 @@ double MucoIterate::resampleWithFrequency(double desiredFrequency) {
     return (double)actualNumTimes / duration;
 }
 
+// The duals are stored in the file header as space-separated numbers; we
+// use enough digits that the values are preserved exactly.
+std::string convertDualsToString(const SimTK::Vector& duals) {
+    std::ostringstream stream;
+    stream.precision(17);
+    for (int i = 0; i < duals.size(); ++i) {
+        if (i) stream << " ";
+        stream << duals[i];
+    }
+    return stream.str();
+}
+
+SimTK::Vector convertStringToDuals(const std::string& str) {
+    std::istringstream stream(str);
+    std::vector<double> values;
+    double value;
+    while (stream >> value) values.push_back(value);
+    OPENSIM_THROW_IF(!stream.eof(), Exception,
+            "Could not parse the duals in the file header.");
+    return SimTK::Vector((int)values.size(), values.data());
+}
+
 MucoIterate::MucoIterate(const std::string& filepath) {
     FileAdapter::OutputTables tables = FileAdapter::readFile(filepath);
 
@@ -349,11 +390,29 @@ MucoIterate::MucoIterate(const std::string& filepath) {
                 numStates + numControls + numMultipliers, 1,
                 numParameters).getAsRowVectorBase();
     }
+    if (metadata.hasKey("variable_lower_bound_duals")) {
+        auto getDuals = [&metadata](const std::string& key) {
+            return convertStringToDuals(
+                    metadata.getValueForKey(key).getValue<std::string>());
+        };
+        setDuals(getDuals("variable_lower_bound_duals"),
+                getDuals("variable_upper_bound_duals"),
+                getDuals("constraint_duals"));
+    }
 }
 
 void MucoIterate::write(const std::string& filepath) const {
     ensureUnsealed();
     TimeSeriesTable table0 = convertToTable();
+    if (hasDuals()) {
+        auto& metadata = table0.updTableMetaData();
+        metadata.setValueForKey("variable_lower_bound_duals",
+                convertDualsToString(m_variable_lower_bound_duals));
+        metadata.setValueForKey("variable_upper_bound_duals",
+                convertDualsToString(m_variable_upper_bound_duals));
+        metadata.setValueForKey("constraint_duals",
+                convertDualsToString(m_constraint_duals));
+    }
     DataAdapter::InputTables tables = {{"table", &table0}};
     FileAdapter::writeFile(tables, filepath);
 }
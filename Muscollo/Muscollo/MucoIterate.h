@@ -23,6 +23,8 @@
 
 #include "osimMuscolloDLL.h"
 
+#include <map>
+
 namespace OpenSim {
 
 class MucoProblem;
@@ -49,7 +51,10 @@ not matter). Order does matter for the column names and corresponding data
 columns. The columns *must* follow this order: time, states, controls,
 parameters. For parameter columns, the value of the parameter is stored in
 the first row of the column, while the rest of the rows are filled with
-NaNs.
+NaNs. If the iterate contains the multipliers of the optimization problem
+(see hasDuals()), the header also contains the entries
+variable_lower_bound_duals, variable_upper_bound_duals, and constraint_duals,
+each a space-separated list of numbers.
 @samplefile
 num_controls=<number-of-control-variables>
 num_parameters=<number-of-parameter-variables>
@@ -114,6 +119,7 @@ public:
         m_controls.setToNaN();
         m_multipliers.resize(numTimes, m_multipliers.ncol());
         m_multipliers.setToNaN();
+        clearDuals();
     }
     /// Uniformly resample (interpolate) the iterate so that it retains the
     /// same initial and final times but now has the provided number of time
@@ -269,6 +275,39 @@ public:
             bool allowMissingColumns = false, bool allowExtraColumns = false);
     /// @}
 
+    /// @name Multipliers of the optimization problem (warm starting)
+    /// An iterate obtained from a solver may also contain the multipliers
+    /// (dual variables) of the discretized optimization problem: one for each
+    /// lower bound and each upper bound on the optimization variables, and
+    /// one for each constraint. These are *not* the Lagrange multipliers for
+    /// kinematic constraints (see getMultipliersTrajectory()). If this
+    /// iterate is used as a guess for a problem with the same structure and
+    /// the same number of mesh points, the solver can use these to warm start
+    /// the optimization; otherwise, they are ignored. These are stored in the
+    /// file header by write(), and are cleared if the number of times
+    /// changes.
+    /// @{
+
+    bool hasDuals() const
+    {   ensureUnsealed(); return m_variable_lower_bound_duals.size() != 0; }
+    const SimTK::Vector& getVariableLowerBoundDuals() const
+    {   ensureUnsealed(); return m_variable_lower_bound_duals; }
+    const SimTK::Vector& getVariableUpperBoundDuals() const
+    {   ensureUnsealed(); return m_variable_upper_bound_duals; }
+    const SimTK::Vector& getConstraintDuals() const
+    {   ensureUnsealed(); return m_constraint_duals; }
+    /// The lower and upper bound duals must have the same length.
+    void setDuals(const SimTK::Vector& variableLowerBoundDuals,
+            const SimTK::Vector& variableUpperBoundDuals,
+            const SimTK::Vector& constraintDuals);
+    void clearDuals() {
+        ensureUnsealed();
+        m_variable_lower_bound_duals.clear();
+        m_variable_upper_bound_duals.clear();
+        m_constraint_duals.clear();
+    }
+    /// @}
+
     /// @name Accessors
     /// @{
 
@@ -396,6 +435,10 @@ private:
     SimTK::Matrix m_multipliers;
     // Dimensions: 1 x parameters
     SimTK::RowVector m_parameters;
+    // Multipliers of the optimization problem; empty if not available.
+    SimTK::Vector m_variable_lower_bound_duals;
+    SimTK::Vector m_variable_upper_bound_duals;
+    SimTK::Vector m_constraint_duals;
 
     // We use "seal" instead of "lock" because locks have a specific meaning
     // with threading (e.g., std::unique_lock()).
@@ -432,6 +475,14 @@ public:
     /// Number of solver iterations at which this solution was obtained
     /// (-1 if not set).
     int getNumIterations() const { return m_numIterations; }
+    /// Solver-dependent statistics about the solve, such as the number of
+    /// calls to, and time (in seconds) spent in, each function of the
+    /// optimization problem (empty if the solver does not provide any). For
+    /// MucoTropterSolver, the keys are the names of the fields of
+    /// tropter::optimization::EvaluationStatistics (e.g.,
+    /// "num_objective_evals", "objective_time").
+    const std::map<std::string, double>& getSolverStatistics() const
+    {   return m_solverStatistics; }
 
     /// @name Access control
     /// @{
@@ -455,9 +506,12 @@ private:
     void setStatus(std::string status) { m_status = std::move(status); }
     void setNumIterations(int numIterations)
     {   m_numIterations = numIterations; };
+    void setSolverStatistics(std::map<std::string, double> statistics)
+    {   m_solverStatistics = std::move(statistics); }
     bool m_success = true;
     std::string m_status;
     int m_numIterations = -1;
+    std::map<std::string, double> m_solverStatistics;
     // Allow solvers to set success, status, and construct a solution.
     friend class MucoSolver;
 };
@@ -27,22 +27,51 @@ MucoJointReactionNormCost::MucoJointReactionNormCost() {
 
 void MucoJointReactionNormCost::constructProperties() {
     constructProperty_joint_path("");
+    constructProperty_joint_paths();
 }
 
 void MucoJointReactionNormCost::initializeImpl() const {
 
-    OPENSIM_THROW_IF_FRMOBJ(get_joint_path().empty(), Exception,
+    // The joint_paths property was added after joint_path, so both are used.
+    std::vector<std::string> paths;
+    if (!get_joint_path().empty()) paths.push_back(get_joint_path());
+    for (int i = 0; i < getProperty_joint_paths().size(); ++i) {
+        paths.push_back(get_joint_paths(i));
+    }
+    OPENSIM_THROW_IF_FRMOBJ(paths.empty(), Exception,
         "Empty model joint path detected. Please provide a valid joint path.");
 
-    OPENSIM_THROW_IF_FRMOBJ(!getModel().hasComponent<Joint>(get_joint_path()),
-        Exception, "Joint at path " + get_joint_path() + " not found in the "
-        "model. Please provide a valid joint path.");
+    m_mobilizedBodyIndices.clear();
+    for (const auto& path : paths) {
+        OPENSIM_THROW_IF_FRMOBJ(path.empty(), Exception,
+            "Empty model joint path detected. Please provide a valid joint "
+            "path.");
+
+        OPENSIM_THROW_IF_FRMOBJ(!getModel().hasComponent<Joint>(path),
+            Exception, "Joint at path " + path + " not found in the "
+            "model. Please provide a valid joint path.");
+
+        // Avoid looking up the joint by its path when computing the cost.
+        const auto& joint = getModel().getComponent<Joint>(path);
+        m_mobilizedBodyIndices.push_back(
+                joint.getChildFrame().getMobilizedBodyIndex());
+    }
+    m_reactionForces.resize(getModel().getMatterSubsystem().getNumBodies());
 }
 
 void MucoJointReactionNormCost::calcIntegralCostImpl(const SimTK::State& state,
         double& integrand) const {
 
+    // This is what Joint::calcReactionOnChildExpressedInGround() computes,
+    // but we compute the reactions for all mobilizers (at the mobilizer's
+    // outboard frame, which is the joint's child frame, expressed in ground)
+    // only once for all of the joints. Solvers usually realize the state to
+    // Acceleration already, in which case this does nothing.
     getModel().realizeAcceleration(state);
-    const auto& joint = getModel().getComponent<Joint>(get_joint_path());
-    integrand = joint.calcReactionOnChildExpressedInGround(state).norm();
+    getModel().getMatterSubsystem().calcMobilizerReactionForces(state,
+            m_reactionForces);
+    integrand = 0;
+    for (const auto& index : m_mobilizedBodyIndices) {
+        integrand += m_reactionForces[index].norm();
+    }
 }
\ No newline at end of file
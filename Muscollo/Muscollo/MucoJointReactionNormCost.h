@@ -20,13 +20,17 @@
 
 #include "MucoCost.h"
 
+#include <simbody/internal/common.h>
+
 namespace OpenSim {
 
-/// Minimize the reaction loads on the child body of a specified joint. 
-/// The norm of the reaction forces and moments integrated over the phase is 
-/// the specific quantity minimized.
-/// This cost requires realizing to the Acceleration stage.
-// TODO allow a list property of multiple joints?
+/// Minimize the reaction loads on the child bodies of one or more specified
+/// joints. The norm of the reaction forces and moments, summed over the
+/// joints and integrated over the phase, is the specific quantity minimized.
+/// This cost requires realizing to the Acceleration stage. The reaction loads
+/// for all the joints are obtained from a single computation, so minimizing
+/// the loads of multiple joints with one cost is cheaper than using one cost
+/// per joint.
 // TODO allow specification of the components of the reaction load SpatialVec
 //      to be minimized.
 // TODO allow specification of either child or parent reaction loads to 
@@ -36,13 +40,25 @@ OpenSim_DECLARE_CONCRETE_OBJECT(MucoJointReactionNormCost, MucoCost);
 public: 
     MucoJointReactionNormCost();
     /// Provide a valid model path for joint whose reaction loads will be
-    /// minimized. 
+    /// minimized. This replaces any previously provided joint paths.
     // TODO when using implicit dynamics, we will need to revisit this cost.
-    void setJointPath(const std::string& path) 
-    {   set_joint_path(path); }
+    void setJointPath(const std::string& path) {
+        set_joint_path(path);
+        updProperty_joint_paths().clear();
+    }
+    /// Add a joint whose reaction loads will be minimized, in addition to any
+    /// joints already provided.
+    void addJointPath(const std::string& path) {
+        if (get_joint_path().empty()) set_joint_path(path);
+        else append_joint_paths(path);
+    }
 
 protected:
     void initializeImpl() const override;
+    SimTK::Stage getStageDependencyImpl() const override {
+        return SimTK::Stage::Acceleration;
+    }
+    bool hasEndpointCostImpl() const override { return false; }
     void calcIntegralCostImpl(const SimTK::State& state,
             double& integrand) const override;
 
@@ -50,6 +66,13 @@ private:
     void constructProperties();
     OpenSim_DECLARE_PROPERTY(joint_path, std::string, "The model path for the "
             "joint with minimized reaction loads.");
+    OpenSim_DECLARE_LIST_PROPERTY(joint_paths, std::string, "The model paths "
+            "for additional joints with minimized reaction loads (optional).");
+
+    /// The mobilized body for the child frame of each joint.
+    mutable std::vector<SimTK::MobilizedBodyIndex> m_mobilizedBodyIndices;
+    /// Workspace for the reaction loads of all mobilizers.
+    mutable SimTK::Vector_<SimTK::SpatialVec> m_reactionForces;
 };
 
 } // namespace OpenSim
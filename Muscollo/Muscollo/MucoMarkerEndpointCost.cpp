@@ -28,11 +28,18 @@ void MucoMarkerEndpointCost::initializeImpl() const {
 
 void MucoMarkerEndpointCost::calcEndpointCostImpl(
         const SimTK::State& finalState, double& cost) const {
-    getModel().realizePosition(finalState);
     const auto& actualLocation = m_point->getLocationInGround(finalState);
     cost = (actualLocation - get_reference_location()).normSqr();
 }
 
+bool MucoMarkerEndpointCost::getDependenciesImpl(
+        std::vector<int>& stateIndices, std::vector<int>&) const {
+    // The generalized coordinates are at the start of Y.
+    const int numQ = getModel().getWorkingState().getNQ();
+    for (int iq = 0; iq < numQ; ++iq) stateIndices.push_back(iq);
+    return true;
+}
+
 void MucoMarkerEndpointCost::constructProperties() {
     constructProperty_point_name("");
     constructProperty_reference_location(SimTK::Vec3(0));
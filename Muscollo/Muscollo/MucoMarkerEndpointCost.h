@@ -48,8 +48,16 @@ public:
 
 protected:
     void initializeImpl() const override;
+    SimTK::Stage getStageDependencyImpl() const override {
+        return SimTK::Stage::Position;
+    }
+    bool hasIntegralCostImpl() const override { return false; }
     void calcEndpointCostImpl(const SimTK::State& finalState,
         double& cost) const override;
+    /// The location of the point depends only on the generalized
+    /// coordinates.
+    bool getDependenciesImpl(std::vector<int>& stateIndices,
+            std::vector<int>& controlIndices) const override;
 private:
 
     OpenSim_DECLARE_PROPERTY(point_name, std::string,
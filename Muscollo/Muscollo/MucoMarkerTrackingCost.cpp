@@ -16,37 +16,38 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
- #include "MucoMarkerTrackingCost.h"
- #include <OpenSim/Simulation/Model/Model.h>
- #include <OpenSim/Simulation/Model/Marker.h>
+#include "MucoMarkerTrackingCost.h"
+#include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/Model/Marker.h>
 
- using namespace OpenSim;
+#include <numeric>
+
+using namespace OpenSim;
+
+void MucoMarkerTrackingCost::initializeImpl() const {
 
- void MucoMarkerTrackingCost::initializeImpl() const {
-    
-    // Cache reference pointers to model markers.
-    m_model_markers.clear();
     // TODO: When should we load a markers file?
     if (get_markers_reference().get_marker_file() != "") {
         const_cast<MucoMarkerTrackingCost*>(this)->upd_markers_reference().
                 loadMarkersFile(get_markers_reference().get_marker_file());
     }
+
+    // Find the model marker for each reference marker.
+    std::vector<const Marker*> modelMarkers;
+    std::vector<int> refindices;
     const auto& markRefNames = get_markers_reference().getNames();
     const auto& markerSet = getModel().getMarkerSet();
     int iset = -1;
     for (int i = 0; i < (int)markRefNames.size(); ++i) {
         if (getModel().hasComponent<Marker>(markRefNames[i])) {
-            const auto& m = getModel().getComponent<Marker>(markRefNames[i]);
-            // Store a pointer to the current model marker.
-            m_model_markers.emplace_back(&m);
-            // Store the reference index corresponding to the current model
-            // marker.
-            m_refindices.push_back(i);
+            modelMarkers.push_back(
+                    &getModel().getComponent<Marker>(markRefNames[i]));
+            refindices.push_back(i);
         } else if ((iset = markerSet.getIndex(markRefNames[i])) != -1) {
             // Allow the marker ref names to be names of markers in the
             // MarkerSet.
-            m_model_markers.emplace_back(&markerSet.get(iset));
-            m_refindices.push_back(i);
+            modelMarkers.push_back(&markerSet.get(iset));
+            refindices.push_back(i);
         } else {
             if (get_allow_unused_references()) {
                 continue;
@@ -64,32 +65,146 @@
     const SimTK::State& s = getModel().getWorkingState();
     get_markers_reference().getWeights(s, m_marker_weights);
 
+    // Sort the markers by the body to which they are attached (stable, to
+    // keep the reference order within a body).
+    const int numMarkers = (int)modelMarkers.size();
+    std::vector<SimTK::MobilizedBodyIndex> markerBodies(numMarkers);
+    for (int i = 0; i < numMarkers; ++i) {
+        markerBodies[i] =
+                modelMarkers[i]->getParentFrame().getMobilizedBodyIndex();
+    }
+    std::vector<int> order(numMarkers);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+            [&markerBodies](int a, int b) {
+                return markerBodies[a] < markerBodies[b];
+            });
+
+    m_bodies.clear();
+    m_bodyBegin.clear();
+    m_refindices.resize(numMarkers);
+    m_weights.resize(numMarkers);
+    m_stations.resize(3 * numMarkers);
+    for (int isorted = 0; isorted < numMarkers; ++isorted) {
+        const int i = order[isorted];
+        if (m_bodies.empty() || m_bodies.back() != markerBodies[i]) {
+            m_bodies.push_back(markerBodies[i]);
+            m_bodyBegin.push_back(isorted);
+        }
+        m_refindices[isorted] = refindices[i];
+        m_weights[isorted] = m_marker_weights[refindices[i]];
+        // The marker's location in the frame of its body.
+        const auto& frame = modelMarkers[i]->getParentFrame();
+        const SimTK::Vec3 station = frame.findTransformInBaseFrame() *
+                modelMarkers[i]->get_location();
+        for (int j = 0; j < 3; ++j) {
+            m_stations[j * numMarkers + isorted] = station[j];
+        }
+    }
+    m_bodyBegin.push_back(numMarkers);
+    m_locations.resize(3 * numMarkers);
+    m_refLocations.resize(3 * numMarkers);
+    m_refLocationsOnMesh.clear();
+
     // Get and flatten TimeSeriesTableVec3 to doubles and create a set of
     // reference splines, one for each component of the coordinate 
     // trajectories.
     m_refsplines = GCVSplineSet(
         get_markers_reference().getMarkerTable().flatten());
- }
-
- void MucoMarkerTrackingCost::calcIntegralCostImpl(const SimTK::State& state, 
-        double& integrand) const {
-     const auto& time = state.getTime();
-     getModel().realizePosition(state);
-     SimTK::Vector timeVec(1, time);
-
-     for (int i = 0; i < (int)m_model_markers.size(); ++i) {
-         const auto& modelValue =
-             m_model_markers[i]->getLocationInGround(state);
-         SimTK::Vec3 refValue;
-
-         // Get the markers reference index corresponding to the current 
-         // model marker and get the reference value.
-         int refidx = m_refindices[i];
-         refValue[0] = m_refsplines[3*refidx].calcValue(timeVec);
-         refValue[1] = m_refsplines[3*refidx + 1].calcValue(timeVec);
-         refValue[2] = m_refsplines[3*refidx + 2].calcValue(timeVec);
-
-         integrand +=
-            m_marker_weights[refidx] * (modelValue - refValue).normSqr();
-     }
- }
+}
+
+void MucoMarkerTrackingCost::calcReferenceLocations(double time) const {
+    const int numMarkers = (int)m_refindices.size();
+    SimTK::Vector timeVec(1, time);
+    for (int i = 0; i < numMarkers; ++i) {
+        const int refidx = m_refindices[i];
+        for (int j = 0; j < 3; ++j) {
+            m_refLocations[j * numMarkers + i] =
+                    m_refsplines[3 * refidx + j].calcValue(timeVec);
+        }
+    }
+}
+
+void MucoMarkerTrackingCost::initializeOnMeshImpl() const {
+    const SimTK::Vector& meshTimes = getMeshTimes();
+    m_refLocationsOnMesh.resize((int)m_refLocations.size(), meshTimes.size());
+    for (int imesh = 0; imesh < meshTimes.size(); ++imesh) {
+        calcReferenceLocations(meshTimes[imesh]);
+        std::copy(m_refLocations.begin(), m_refLocations.end(),
+                &m_refLocationsOnMesh(0, imesh));
+    }
+}
+
+bool MucoMarkerTrackingCost::getDependenciesImpl(
+        std::vector<int>& stateIndices, std::vector<int>&) const {
+    // The generalized coordinates are at the start of Y.
+    const SimTK::State& state = getModel().getWorkingState();
+    const SimTK::SimbodyMatterSubsystem& matter =
+            getModel().getMatterSubsystem();
+    std::vector<bool> visited(matter.getNumBodies(), false);
+    for (const auto& index : m_bodies) {
+        const SimTK::MobilizedBody* body = &matter.getMobilizedBody(index);
+        while (!body->isGround() && !visited[body->getMobilizedBodyIndex()]) {
+            visited[body->getMobilizedBodyIndex()] = true;
+            const int firstQ = body->getFirstQIndex(state);
+            for (int iq = 0; iq < body->getNumQ(state); ++iq) {
+                stateIndices.push_back(firstQ + iq);
+            }
+            body = &body->getParentMobilizedBody();
+        }
+    }
+    return true;
+}
+
+void MucoMarkerTrackingCost::calcIntegralCostOnMeshImpl(
+        const SimTK::State& state, int meshIndex, double& integrand) const {
+    const int numMarkers = (int)m_refindices.size();
+    if (!numMarkers) return;
+
+    // Compute the locations of all markers in ground, one body at a time.
+    const SimTK::SimbodyMatterSubsystem& matter =
+            getModel().getMatterSubsystem();
+    const double* sx = m_stations.data();
+    const double* sy = sx + numMarkers;
+    const double* sz = sy + numMarkers;
+    double* px = m_locations.data();
+    double* py = px + numMarkers;
+    double* pz = py + numMarkers;
+    for (int ibody = 0; ibody < (int)m_bodies.size(); ++ibody) {
+        const SimTK::MobilizedBody& body =
+                matter.getMobilizedBody(m_bodies[ibody]);
+        const SimTK::Transform& X_GB = body.getBodyTransform(state);
+        const SimTK::Rotation& R = X_GB.R();
+        const SimTK::Vec3& p = X_GB.p();
+        const double R00 = R(0, 0), R01 = R(0, 1), R02 = R(0, 2);
+        const double R10 = R(1, 0), R11 = R(1, 1), R12 = R(1, 2);
+        const double R20 = R(2, 0), R21 = R(2, 1), R22 = R(2, 2);
+        for (int i = m_bodyBegin[ibody]; i < m_bodyBegin[ibody + 1]; ++i) {
+            px[i] = p[0] + R00 * sx[i] + R01 * sy[i] + R02 * sz[i];
+            py[i] = p[1] + R10 * sx[i] + R11 * sy[i] + R12 * sz[i];
+            pz[i] = p[2] + R20 * sx[i] + R21 * sy[i] + R22 * sz[i];
+        }
+    }
+
+    // Get the reference locations, precomputed if possible.
+    const double* rx;
+    if (meshIndex != -1) {
+        rx = &m_refLocationsOnMesh(0, meshIndex);
+    } else {
+        calcReferenceLocations(state.getTime());
+        rx = m_refLocations.data();
+    }
+    const double* ry = rx + numMarkers;
+    const double* rz = ry + numMarkers;
+
+    // Sum the weighted squared errors.
+    const double* w = m_weights.data();
+    double sum = 0;
+    for (int i = 0; i < numMarkers; ++i) {
+        const double ex = px[i] - rx[i];
+        const double ey = py[i] - ry[i];
+        const double ez = pz[i] - rz[i];
+        sum += w[i] * (ex * ex + ey * ey + ez * ez);
+    }
+    integrand += sum;
+}
@@ -26,8 +26,6 @@
 
 namespace OpenSim {
 
-class Marker;
-
 /// The squared difference between a model marker location and an experimental
 /// reference marker location, summed over the markers for which an 
 /// experimental data location is provided, and integrated over the phase.
@@ -65,8 +63,17 @@ public:
 
 protected:
     void initializeImpl() const override;
-    void calcIntegralCostImpl(const SimTK::State& state,
+    SimTK::Stage getStageDependencyImpl() const override {
+        return SimTK::Stage::Position;
+    }
+    bool hasEndpointCostImpl() const override { return false; }
+    void initializeOnMeshImpl() const override;
+    void calcIntegralCostOnMeshImpl(const SimTK::State& state, int meshIndex,
         double& integrand) const override;
+    /// The cost depends on the generalized coordinates of the mobilizers
+    /// between ground and the bodies to which the markers are attached.
+    bool getDependenciesImpl(std::vector<int>& stateIndices,
+            std::vector<int>& controlIndices) const override;
 private:
     OpenSim_DECLARE_PROPERTY(markers_reference, MarkersReference,
             "MarkersReference object containing the marker trajectories to be "
@@ -84,10 +91,36 @@ private:
         constructProperty_allow_unused_references(false);
     };
 
+    /// Compute the reference locations at the given time into
+    /// m_refLocations, in the same layout as the columns of
+    /// m_refLocationsOnMesh.
+    void calcReferenceLocations(double time) const;
+
     mutable GCVSplineSet m_refsplines;
-    mutable std::vector<SimTK::ReferencePtr<const Marker>> m_model_markers;
-    mutable std::vector<int> m_refindices;
     mutable SimTK::Array_<double> m_marker_weights;
+
+    // The tracked markers are sorted by the body to which they are attached,
+    // so that each body's transform is used for all of its markers at once.
+    // The markers for body m_bodies[i] are [m_bodyBegin[i], m_bodyBegin[i+1]).
+    // The remaining arrays are indexed by the sorted marker index.
+    mutable std::vector<SimTK::MobilizedBodyIndex> m_bodies;
+    mutable std::vector<int> m_bodyBegin;
+    /// The index of each marker in the MarkersReference.
+    mutable std::vector<int> m_refindices;
+    /// The weight for each marker.
+    mutable std::vector<double> m_weights;
+    /// The locations of the markers in their body's frame, stored as all the
+    /// x coordinates, then all the y coordinates, then all the z coordinates.
+    mutable std::vector<double> m_stations;
+
+    /// The reference locations at the mesh times (if provided); column i
+    /// contains the locations (in the same layout as m_stations) for mesh
+    /// point i.
+    mutable SimTK::Matrix m_refLocationsOnMesh;
+    // Workspaces for the model and reference locations, in the same layout as
+    // m_stations.
+    mutable std::vector<double> m_locations;
+    mutable std::vector<double> m_refLocations;
 };
 
 } // namespace OpenSim
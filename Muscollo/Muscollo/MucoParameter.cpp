@@ -70,6 +70,7 @@ void MucoParameter::constructProperties() {
     constructProperty_component_paths();
     constructProperty_property_name("");
     constructProperty_property_element();
+    constructProperty_requires_init_system(true);
 }
 
 void MucoParameter::initialize(Model& model) const {
@@ -79,6 +80,7 @@ void MucoParameter::initialize(Model& model) const {
     OPENSIM_THROW_IF_FRMOBJ(get_property_name().empty(), Exception,
         "A component property name must be provided.");
 
+    m_property_refs.clear();
     for (int i = 0; i < (int)getProperty_component_paths().size(); ++i) {
         // Get model component.
         auto& component = model.updComponent(get_component_paths(i));
@@ -116,6 +116,13 @@ public:
     {   set_property_name(propertyName); }
     void appendComponentPath(const std::string& componentPath)
     {   append_component_paths(componentPath); }
+    /// Set this to false only if the property is read each time it is used
+    /// (e.g., SpringGeneralizedForce stiffness), to avoid calling initSystem()
+    /// after each new value; otherwise, the dynamics are silently incorrect.
+    bool requiresInitSystem() const
+    {   return get_requires_init_system(); }
+    void setRequiresInitSystem(bool requiresInitSystem)
+    {   set_requires_init_system(requiresInitSystem); }
 
     /// For use by solvers. This performs error checks and caches information
     /// about the model that is useful during the optimization.
@@ -139,6 +146,10 @@ private:
         "model property associated with the MucoParameter.");
     OpenSim_DECLARE_OPTIONAL_PROPERTY(property_element, int, "For non-scalar "
         "model properties, the index of the element to be optimized.");
+    OpenSim_DECLARE_PROPERTY(requires_init_system, bool, "Must the model's "
+        "system be rebuilt after applying a new value? Set to false only if "
+        "every component reads the property each time it computes its "
+        "contribution (default: true).");
 
     mutable std::vector<SimTK::ReferencePtr<AbstractProperty>> m_property_refs;
     enum DataType {
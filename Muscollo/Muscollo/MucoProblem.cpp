@@ -19,6 +19,8 @@
 #include "MucoProblem.h"
 #include "MuscolloUtilities.h"
 
+#include <algorithm>
+
 #include <simbody/internal/Constraint.h>
 
 using namespace OpenSim;
@@ -422,8 +424,42 @@ void MucoPhase::initialize(Model& model) const {
         const_cast<MucoParameter&>(get_parameters(i)).initialize(model);
     }
 
+    m_integral_cost_indices.clear();
+    m_endpoint_cost_indices.clear();
+    m_integral_cost_gradient_indices.clear();
+    m_integral_cost_findiff_indices.clear();
+    m_integral_cost_stage = SimTK::Stage::Empty;
+    m_endpoint_cost_stage = SimTK::Stage::Empty;
+    m_integral_cost_findiff_stage = SimTK::Stage::Empty;
+    // The costs are only initialized again if the model or their properties
+    // changed. If the phase changed (e.g., a new model was set), the passed-in
+    // model might be at the same address as the model the costs were
+    // initialized with, so we must initialize the costs again.
+    const bool phaseChanged = !isObjectUpToDateWithProperties();
     for (int i = 0; i < getProperty_costs().size(); ++i) {
-        const_cast<MucoCost&>(get_costs(i)).initialize(model);
+        const auto& cost = get_costs(i);
+        if (phaseChanged) cost.clearInitialization();
+        const_cast<MucoCost&>(cost).initialize(model);
+        // Solvers only evaluate the costs that have the relevant term, and
+        // only realize to the highest stage those costs require.
+        if (cost.hasIntegralCost()) {
+            m_integral_cost_indices.push_back(i);
+            m_integral_cost_stage = std::max(m_integral_cost_stage,
+                    cost.getStageDependency());
+            if (cost.hasIntegralCostGradient()) {
+                m_integral_cost_gradient_indices.push_back(i);
+            } else {
+                m_integral_cost_findiff_indices.push_back(i);
+                m_integral_cost_findiff_stage = std::max(
+                        m_integral_cost_findiff_stage,
+                        cost.getStageDependency());
+            }
+        }
+        if (cost.hasEndpointCost()) {
+            m_endpoint_cost_indices.push_back(i);
+            m_endpoint_cost_stage = std::max(m_endpoint_cost_stage,
+                    cost.getStageDependency());
+        }
     }
     
     // Get property values for constraint and Lagrange multipliers.
@@ -489,12 +525,16 @@ void MucoPhase::initialize(Model& model) const {
     }
 
     m_num_path_constraint_eqs = 0;
+    m_path_constraint_stage = SimTK::Stage::Empty;
     for (int i = 0; i < getProperty_path_constraints().size(); ++i) {
         const_cast<MucoPathConstraint&>(get_path_constraints(i)).initialize(
             model, m_num_path_constraint_eqs);
         m_num_path_constraint_eqs += 
             get_path_constraints(i).getConstraintInfo().getNumEquations();
+        m_path_constraint_stage = std::max(m_path_constraint_stage,
+                get_path_constraints(i).getStageDependency());
     }
+    const_cast<MucoPhase*>(this)->setObjectIsUpToDateWithProperties();
 }
 void MucoPhase::applyParametersToModel(
         const SimTK::Vector& parameterValues) const {
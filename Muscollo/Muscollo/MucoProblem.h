@@ -287,28 +287,143 @@ public:
     /// Invoked by the solver in preparation for solving the problem.
     /// The passed-in model is a non-const reference because MucoParameter needs
     /// the ability to make changes to the model.
+    /// Costs are initialized only if the passed-in model differs from the one
+    /// they were last initialized with, or if a property of the phase or of
+    /// the cost has changed since; solvers can call this repeatedly.
     void initialize(Model&) const;
+    /// Cause the next call to initialize() to initialize all costs. Solvers
+    /// must call this before initializing with a new copy of the model, as
+    /// the copy may reside at the address of a previous (destroyed) model.
+    void clearInitialization() const {
+        const_cast<MucoPhase*>(this)->clearObjectIsUpToDateWithProperties();
+    }
+    /// Invoked by the solver after initialize() to provide the times of the
+    /// mesh points to the costs, if the times are known before solving
+    /// (see MucoCost::initializeOnMesh()).
+    void initializeOnMesh(const SimTK::Vector& meshTimes) const {
+        for (int i = 0; i < getProperty_costs().size(); ++i) {
+            get_costs(i).initializeOnMesh(meshTimes);
+        }
+    }
+    /// The number of costs with an integral term. If this is zero, solvers
+    /// need not call calcIntegralCost().
+    int getNumIntegralCosts() const
+    {   return (int)m_integral_cost_indices.size(); }
+    /// The number of costs with an endpoint term. If this is zero, solvers
+    /// need not call calcEndpointCost().
+    int getNumEndpointCosts() const
+    {   return (int)m_endpoint_cost_indices.size(); }
+    /// The stage to which the state must be realized before calling
+    /// calcIntegralCost(); this is the highest stage required by the costs
+    /// with an integral term.
+    SimTK::Stage getIntegralCostStageDependency() const
+    {   return m_integral_cost_stage; }
+    /// The stage to which the state must be realized before calling
+    /// calcEndpointCost().
+    SimTK::Stage getEndpointCostStageDependency() const
+    {   return m_endpoint_cost_stage; }
+    /// The stage to which the state must be realized before calling
+    /// calcPathConstraintErrors().
+    SimTK::Stage getPathConstraintStageDependency() const
+    {   return m_path_constraint_stage; }
     /// Calculate the sum of integrand over all the integral cost terms in this
     /// phase for the provided state. That is, the returned value is *not* an
     /// integral over time.
-    SimTK::Real calcIntegralCost(const SimTK::State& state) const {
+    /// The mesh index is passed on to MucoCost::calcIntegralCost().
+    /// @precondition The state is realized to
+    /// getIntegralCostStageDependency().
+    SimTK::Real calcIntegralCost(const SimTK::State& state,
+            int meshIndex = -1) const {
         SimTK::Real integrand = 0;
-        for (int i = 0; i < getProperty_costs().size(); ++i) {
-            integrand += get_costs(i).calcIntegralCost(state);
+        for (const int& i : m_integral_cost_indices) {
+            integrand += get_costs(i).calcIntegralCost(state, meshIndex);
+        }
+        return integrand;
+    }
+    /// The number of costs with an integral term that provide its gradient
+    /// (see MucoCost::hasIntegralCostGradient()).
+    int getNumIntegralCostsWithGradient() const
+    {   return (int)m_integral_cost_gradient_indices.size(); }
+    /// The number of costs with an integral term that do not provide its
+    /// gradient; solvers must compute the gradient of these costs with
+    /// finite differences of calcIntegralCostWithoutGradient().
+    int getNumIntegralCostsWithoutGradient() const
+    {   return (int)m_integral_cost_findiff_indices.size(); }
+    /// The stage to which the state must be realized before calling
+    /// calcIntegralCostWithoutGradient().
+    SimTK::Stage getIntegralCostWithoutGradientStageDependency() const
+    {   return m_integral_cost_findiff_stage; }
+    /// Add the gradient of the integrand of the costs that provide it to
+    /// `stateGradient` (with respect to the state variables Y) and
+    /// `controlGradient` (with respect to the model's controls).
+    /// @precondition The state is realized to
+    /// getIntegralCostStageDependency().
+    void calcIntegralCostGradient(const SimTK::State& state, int meshIndex,
+            SimTK::Vector& stateGradient,
+            SimTK::Vector& controlGradient) const {
+        for (const int& i : m_integral_cost_gradient_indices) {
+            get_costs(i).calcIntegralCostGradient(state, meshIndex,
+                    stateGradient, controlGradient);
+        }
+    }
+    /// Same as calcIntegralCost(), but only including the costs that do not
+    /// provide the gradient of their integrand.
+    /// @precondition The state is realized to
+    /// getIntegralCostWithoutGradientStageDependency().
+    SimTK::Real calcIntegralCostWithoutGradient(const SimTK::State& state,
+            int meshIndex = -1) const {
+        SimTK::Real integrand = 0;
+        for (const int& i : m_integral_cost_findiff_indices) {
+            integrand += get_costs(i).calcIntegralCost(state, meshIndex);
         }
         return integrand;
     }
+    /// Get the indices of the state variables (in the order of
+    /// SimTK::State::getY()) and controls on which the integral costs depend,
+    /// and of the state variables on which the endpoint costs depend (see
+    /// MucoCost::getDependencies()). The indices are appended to the provided
+    /// vectors and may contain duplicates. This returns false if any cost
+    /// does not declare its dependencies.
+    bool getCostDependencies(std::vector<int>& integralStateIndices,
+            std::vector<int>& integralControlIndices,
+            std::vector<int>& endpointStateIndices) const {
+        std::vector<int> stateIndices;
+        std::vector<int> controlIndices;
+        for (int i = 0; i < getProperty_costs().size(); ++i) {
+            const auto& cost = get_costs(i);
+            stateIndices.clear();
+            controlIndices.clear();
+            if (!cost.getDependencies(stateIndices, controlIndices)) {
+                return false;
+            }
+            if (cost.hasIntegralCost()) {
+                integralStateIndices.insert(integralStateIndices.end(),
+                        stateIndices.begin(), stateIndices.end());
+                integralControlIndices.insert(integralControlIndices.end(),
+                        controlIndices.begin(), controlIndices.end());
+            }
+            if (cost.hasEndpointCost()) {
+                endpointStateIndices.insert(endpointStateIndices.end(),
+                        stateIndices.begin(), stateIndices.end());
+            }
+        }
+        return true;
+    }
     /// Calculate the sum of all the endpoint cost terms in this phase.
+    /// @precondition The state is realized to
+    /// getEndpointCostStageDependency().
     SimTK::Real calcEndpointCost(const SimTK::State& finalState) const {
         SimTK::Real cost = 0;
         // TODO cannot use controls.
-        for (int i = 0; i < getProperty_costs().size(); ++i) {
-            cost = get_costs(i).calcEndpointCost(finalState);
+        for (const int& i : m_endpoint_cost_indices) {
+            cost += get_costs(i).calcEndpointCost(finalState);
         }
         return cost;
     }
     /// Calculate the errors in all the scalar path constraint equations in this
     /// phase.
+    /// @precondition The state is realized to
+    /// getPathConstraintStageDependency().
     void calcPathConstraintErrors(const SimTK::State& state, 
         SimTK::Vector& errors) const {
         
@@ -391,6 +506,14 @@ private:
     void constructProperties();
     mutable int m_num_path_constraint_eqs = -1;
     mutable int m_num_multibody_constraint_eqs = -1;
+    mutable std::vector<int> m_integral_cost_indices;
+    mutable std::vector<int> m_endpoint_cost_indices;
+    mutable std::vector<int> m_integral_cost_gradient_indices;
+    mutable std::vector<int> m_integral_cost_findiff_indices;
+    mutable SimTK::Stage m_integral_cost_stage = SimTK::Stage::Empty;
+    mutable SimTK::Stage m_endpoint_cost_stage = SimTK::Stage::Empty;
+    mutable SimTK::Stage m_integral_cost_findiff_stage = SimTK::Stage::Empty;
+    mutable SimTK::Stage m_path_constraint_stage = SimTK::Stage::Empty;
     mutable std::unordered_map<std::string, MucoVariableInfo>
         m_state_infos;
     mutable std::unordered_map<std::string, MucoVariableInfo>
@@ -476,6 +599,11 @@ public:
     // intermediate can determine what parts of the MucoProblem to
     // reveal/allow changing.
     void initialize(Model&) const;
+    /// @copydoc MucoPhase::clearInitialization()
+    void clearInitialization() const {
+        for (int i = 0; i < getProperty_phases().size(); ++i)
+            get_phases(i).clearInitialization();
+    }
 
     /// @}
 
@@ -43,10 +43,12 @@ MucoSolution MucoSolver::solve() const {
 }
 
 void MucoSolver::setSolutionStats(MucoSolution& sol,
-        bool success, const std::string& status, int numIterations) {
+        bool success, const std::string& status, int numIterations,
+        std::map<std::string, double> statistics) {
     sol.setSuccess(success);
     sol.setStatus(status);
     sol.setNumIterations(numIterations);
+    sol.setSolverStatistics(std::move(statistics));
 }
 
 
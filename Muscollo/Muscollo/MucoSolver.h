@@ -82,8 +82,11 @@ protected:
     /// This is a service for derived classes, because
     /// MucoSolution::setStatus(), MucoSolution::setSuccess(), etc. are private
     /// but this class is a friend of MucoSolution.
+    /// The statistics are solver-dependent (see
+    /// MucoSolution::getSolverStatistics()).
     static void setSolutionStats(MucoSolution&,
-            bool success, const std::string& status, int numIterations);
+            bool success, const std::string& status, int numIterations,
+            std::map<std::string, double> statistics = {});
 
 private:
 
@@ -62,6 +62,7 @@ void MucoStateTrackingCost::initializeImpl() const {
     // Clear member variables so they're not used by a subsequent cost 
     // function by accident.
     m_refsplines.clearAndDestroy();
+    m_refValuesOnMesh.clear();
     m_sysYIndices.clear();
     m_state_weights.clear();
 
@@ -100,17 +101,63 @@ void MucoStateTrackingCost::initializeImpl() const {
     }
 }
 
-void MucoStateTrackingCost::calcIntegralCostImpl(/*int meshIndex,*/
-        const SimTK::State& state, double& integrand) const {
-    const auto& time = state.getTime();
+void MucoStateTrackingCost::initializeOnMeshImpl() const {
+    const SimTK::Vector& meshTimes = getMeshTimes();
+    m_refValuesOnMesh.resize(m_refsplines.getSize(), meshTimes.size());
+    SimTK::Vector timeVec(1);
+    for (int imesh = 0; imesh < meshTimes.size(); ++imesh) {
+        timeVec[0] = meshTimes[imesh];
+        for (int iref = 0; iref < m_refsplines.getSize(); ++iref) {
+            m_refValuesOnMesh(iref, imesh) =
+                    m_refsplines[iref].calcValue(timeVec);
+        }
+    }
+}
+
+void MucoStateTrackingCost::calcIntegralCostOnMeshImpl(
+        const SimTK::State& state, int meshIndex, double& integrand) const {
+    const auto& y = state.getY();
+    const int numRefs = m_refsplines.getSize();
+    if (!numRefs) return;
+    if (meshIndex != -1) {
+        // The reference values for this mesh point are contiguous.
+        const double* refValues = &m_refValuesOnMesh(0, meshIndex);
+        for (int iref = 0; iref < numRefs; ++iref) {
+            const double error = y[m_sysYIndices[iref]] - refValues[iref];
+            integrand += m_state_weights[iref] * error * error;
+        }
+    } else {
+        // The mesh times are not known in advance (e.g., the final time is
+        // a variable), so evaluate the splines.
+        SimTK::Vector timeVec(1, state.getTime());
+        for (int iref = 0; iref < numRefs; ++iref) {
+            const auto& modelValue = y[m_sysYIndices[iref]];
+            const auto& refValue = m_refsplines[iref].calcValue(timeVec);
+            integrand += m_state_weights[iref] * pow(modelValue - refValue, 2);
+        }
+    }
+}
 
-    SimTK::Vector timeVec(1, time);
+bool MucoStateTrackingCost::getDependenciesImpl(
+        std::vector<int>& stateIndices, std::vector<int>&) const {
+    for (int iref = 0; iref < (int)m_sysYIndices.size(); ++iref) {
+        if (m_state_weights[iref] != 0) {
+            stateIndices.push_back(m_sysYIndices[iref]);
+        }
+    }
+    return true;
+}
 
-    // TODO cache the reference coordinate values at the mesh points, rather
-    // than evaluating the spline.
+void MucoStateTrackingCost::calcIntegralCostGradientImpl(
+        const SimTK::State& state, int meshIndex,
+        SimTK::Vector& stateGradient, SimTK::Vector&) const {
+    const auto& y = state.getY();
+    SimTK::Vector timeVec(1, state.getTime());
     for (int iref = 0; iref < m_refsplines.getSize(); ++iref) {
-        const auto& modelValue = state.getY()[m_sysYIndices[iref]];
-        const auto& refValue = m_refsplines[iref].calcValue(timeVec);
-        integrand += m_state_weights[iref] * pow(modelValue - refValue, 2);
+        const double refValue = meshIndex != -1 ?
+                m_refValuesOnMesh(iref, meshIndex) :
+                m_refsplines[iref].calcValue(timeVec);
+        const int iy = m_sysYIndices[iref];
+        stateGradient[iy] += 2 * m_state_weights[iref] * (y[iy] - refValue);
     }
 }
@@ -45,7 +45,9 @@ public:
     /// states you want to track. Each column label must be the path of a state
     /// variable, e.g., `knee/flexion/value`. Calling this function clears the
     /// table provided via setReference(), if any.
-    /// The file is not loaded until the MucoProblem is initialized.
+    /// The file is not loaded until the MucoProblem is initialized, and is
+    /// not loaded again when the problem is initialized again unless a
+    /// property of the cost or the problem has changed.
     // TODO path relative to working directory or setup file?
     void setReferenceFile(const std::string& filepath) {
         m_table = TimeSeriesTable();
@@ -90,8 +92,20 @@ public:
 protected:
     // TODO check that the reference covers the entire possible time range.
     void initializeImpl() const override;
-    void calcIntegralCostImpl(const SimTK::State& state,
+    /// This cost only uses the time and the state variables.
+    SimTK::Stage getStageDependencyImpl() const override {
+        return SimTK::Stage::Time;
+    }
+    bool hasEndpointCostImpl() const override { return false; }
+    void initializeOnMeshImpl() const override;
+    void calcIntegralCostOnMeshImpl(const SimTK::State& state, int meshIndex,
             double& integrand) const override;
+    bool hasIntegralCostGradientImpl() const override { return true; }
+    void calcIntegralCostGradientImpl(const SimTK::State& state,
+            int meshIndex, SimTK::Vector& stateGradient,
+            SimTK::Vector& controlGradient) const override;
+    bool getDependenciesImpl(std::vector<int>& stateIndices,
+            std::vector<int>& controlIndices) const override;
 private:
     OpenSim_DECLARE_PROPERTY(reference_file, std::string,
             "Path to file (.sto, .csv, ...) containing values of states "
@@ -114,6 +128,9 @@ private:
 
     TimeSeriesTable m_table;
     mutable GCVSplineSet m_refsplines;
+    /// The reference values at the mesh times (if provided), with one column
+    /// per mesh point.
+    mutable SimTK::Matrix m_refValuesOnMesh;
     /// The indices in Y corresponding to the provided reference coordinates.
     mutable std::vector<int> m_sysYIndices;
     mutable std::vector<double> m_state_weights;
@@ -24,6 +24,12 @@
 
 #include <tropter/tropter.h>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+
 using namespace OpenSim;
 
 using tropter::VectorX;
@@ -103,8 +109,21 @@ MucoIterateType convert(const tropIterateType& tropSol) {
     }
     // This produces an empty RowVector if numParameters is zero.
     SimTK::RowVector parameters(numParameters, tropSol.parameters.data());
-    return {time, state_names, control_names, multiplier_names, parameter_names, 
-            states, controls, multipliers, parameters};
+    MucoIterateType mucoIter(time, state_names, control_names,
+            multiplier_names, parameter_names, states, controls, multipliers,
+            parameters);
+    // Keep the multipliers of the optimization problem so that this iterate
+    // can be used to warm start another solve.
+    if (tropSol.variable_lower_multipliers.size()) {
+        auto convertToVector = [](const Eigen::VectorXd& v) {
+            return SimTK::Vector((int)v.size(), v.data());
+        };
+        mucoIter.setDuals(
+                convertToVector(tropSol.variable_lower_multipliers),
+                convertToVector(tropSol.variable_upper_multipliers),
+                convertToVector(tropSol.constraint_multipliers));
+    }
+    return mucoIter;
 }
 
 MucoSolution convert(const tropter::Solution& tropSol) {
@@ -160,6 +179,18 @@ tropter::Iterate convert(const MucoIterate& mucoIter) {
     } else {
         tropIter.parameters.resize(numParameters);
     }
+    if (mucoIter.hasDuals()) {
+        auto convertToEigen = [](const SimTK::Vector& v) -> VectorXd {
+            if (!v.size()) return VectorXd();
+            return Map<const VectorXd>(&v[0], v.size());
+        };
+        tropIter.variable_lower_multipliers =
+                convertToEigen(mucoIter.getVariableLowerBoundDuals());
+        tropIter.variable_upper_multipliers =
+                convertToEigen(mucoIter.getVariableUpperBoundDuals());
+        tropIter.constraint_multipliers =
+                convertToEigen(mucoIter.getConstraintDuals());
+    }
     return tropIter;
 }
 
@@ -173,6 +204,106 @@ tropter::FinalBounds convert(const MucoFinalBounds& mb) {
     return {mb.getLower(), mb.getUpper()};
 }
 
+/// Counts the number of times each stage of a SimTK::State is realized, and
+/// the time spent doing so, by the part of the optimal control problem that
+/// required the realization. Stages realized explicitly through realize() are
+/// timed individually. Costs and path constraints may realize the state
+/// themselves; for these, use record(), which infers the realized stages from
+/// the stage of the state before and after the call, and attributes the
+/// entire time of the call to the caller.
+class RealizationStatistics {
+public:
+    enum Caller {
+        DAE,
+        IntegralCost,
+        EndpointCost,
+        PathConstraints,
+        NumCallers
+    };
+    RealizationStatistics() { reset(); }
+    void reset() {
+        for (auto& counts : m_counts) counts.fill(0);
+        m_timesInNs.fill(0);
+    }
+    RealizationStatistics& operator+=(const RealizationStatistics& other) {
+        for (int icaller = 0; icaller < NumCallers; ++icaller) {
+            for (int istage = 0; istage < SimTK::Stage::NValid; ++istage) {
+                m_counts[icaller][istage] += other.m_counts[icaller][istage];
+            }
+            m_timesInNs[icaller] += other.m_timesInNs[icaller];
+        }
+        return *this;
+    }
+    /// Realize the state to the given stage, one stage at a time.
+    void realize(const SimTK::System& system, const SimTK::State& state,
+            SimTK::Stage stage, Caller caller) {
+        for (int istage = state.getSystemStage().getValue() + 1;
+                istage <= stage.getValue(); ++istage) {
+            const Stopwatch stopwatch;
+            system.realize(state, SimTK::Stage(istage));
+            m_timesInNs[caller] += stopwatch.getElapsedTimeInNs();
+            ++m_counts[caller][istage];
+        }
+    }
+    /// Record the stages realized between `before` and `after`, and the time
+    /// spent in the call that realized them.
+    void record(Caller caller, SimTK::Stage before, SimTK::Stage after,
+            long long elapsedTimeInNs) {
+        for (int istage = before.getValue() + 1; istage <= after.getValue();
+                ++istage) {
+            ++m_counts[caller][istage];
+        }
+        m_timesInNs[caller] += elapsedTimeInNs;
+    }
+    /// Add the counts (e.g., "realize_dae_velocity") and times in seconds
+    /// (e.g., "realize_dae_elapsed_time") to the given map.
+    void addTo(std::map<std::string, double>& statistics) const {
+        for (int icaller = 0; icaller < NumCallers; ++icaller) {
+            const std::string prefix =
+                    std::string("realize_") + getCallerName(icaller) + "_";
+            for (int istage = SimTK::Stage::Time;
+                    istage <= SimTK::Stage::Acceleration; ++istage) {
+                std::string stageName = SimTK::Stage(istage).getName();
+                std::transform(stageName.begin(), stageName.end(),
+                        stageName.begin(), ::tolower);
+                statistics[prefix + stageName] = m_counts[icaller][istage];
+            }
+            statistics[prefix + "elapsed_time"] =
+                    SimTK::nsToSec(m_timesInNs[icaller]);
+        }
+    }
+    void print(std::ostream& stream = std::cout) const {
+        const auto flags = stream.flags();
+        stream << "Number of realizations by stage, and time spent (s):\n";
+        stream << std::setw(18) << "";
+        for (int istage = SimTK::Stage::Time;
+                istage <= SimTK::Stage::Acceleration; ++istage) {
+            stream << std::setw(14) << SimTK::Stage(istage).getName();
+        }
+        stream << std::setw(14) << "time" << "\n";
+        for (int icaller = 0; icaller < NumCallers; ++icaller) {
+            stream << std::setw(18) << std::left << getCallerName(icaller)
+                    << std::right;
+            for (int istage = SimTK::Stage::Time;
+                    istage <= SimTK::Stage::Acceleration; ++istage) {
+                stream << std::setw(14) << m_counts[icaller][istage];
+            }
+            stream << std::setw(14) << SimTK::nsToSec(m_timesInNs[icaller])
+                    << "\n";
+        }
+        stream.flush();
+        stream.flags(flags);
+    }
+private:
+    static const char* getCallerName(int caller) {
+        static const char* names[NumCallers] =
+                {"dae", "integral_cost", "endpoint_cost", "path_constraints"};
+        return names[caller];
+    }
+    std::array<std::array<int, SimTK::Stage::NValid>, NumCallers> m_counts;
+    std::array<long long, NumCallers> m_timesInNs;
+};
+
 template <typename T>
 class MucoTropterSolver::OCProblem : public tropter::Problem<T> {
 public:
@@ -181,22 +312,16 @@ public:
             : tropter::Problem<T>(solver.getProblem().getName()),
               m_mucoTropterSolver(solver),
               m_mucoProb(solver.getProblem()),
-              m_phase0(m_mucoProb.getPhase(0)) {
-        m_model = m_phase0.getModel();
-        // Disable all controllers.
-        // TODO temporary; don't want to actually do this.
-        m_model.finalizeFromProperties();
-        auto controllers = m_model.updComponentList<Controller>();
-        for (auto& controller : controllers) {
-            controller.set_enabled(false);
-        }
-        m_state = m_model.initSystem();
-        // TODO avoid multiple calls to initialize
-        m_mucoProb.initialize(m_model);
+              m_phase0(m_mucoProb.getPhase(0)),
+              m_implicit(solver.get_dynamics_mode() == "implicit") {
+        m_context.reset(new Context());
+        m_context->problem = &m_mucoProb;
+        initializeContext(*m_context);
+        const Model& model = m_context->model;
 
         this->set_time(convert(m_phase0.getTimeInitialBounds()),
                 convert(m_phase0.getTimeFinalBounds()));
-        auto svNamesInSysOrder = createStateVariableNamesInSystemOrder(m_model);
+        auto svNamesInSysOrder = createStateVariableNamesInSystemOrder(model);
         for (const auto& svName : svNamesInSysOrder) {
             const auto& info = m_phase0.getStateInfo(svName);
             this->add_state(svName, convert(info.getBounds()),
@@ -291,147 +416,240 @@ public:
             }
         }
         m_numPathConstraintEqs = m_phase0.getNumPathConstraintEquations();
-        // Allocate path constraint error memory.
-        m_pathConstraintErrors.resize(m_numPathConstraintEqs);
-        m_pathConstraintErrors.setToZero();
 
-        for (const auto& actu : m_model.getComponentList<Actuator>()) {
+        for (const auto& actu : model.getComponentList<Actuator>()) {
             // TODO handle a variable number of control signals.
             const auto& actuName = actu.getAbsolutePathString();
             const auto& info = m_phase0.getControlInfo(actuName);
             this->add_control(actuName, convert(info.getBounds()),
                     convert(info.getInitialBounds()),
                     convert(info.getFinalBounds()));
+            ++m_numActuatorControls;
+        }
+
+        if (m_implicit) {
+            // The generalized accelerations are controls, and the residual
+            // generalized forces (from inverse dynamics) must be zero.
+            const SimTK::State& state = m_context->state;
+            OPENSIM_THROW_IF(state.getNZ() != 0, Exception,
+                "The implicit dynamics mode does not yet support models with "
+                "auxiliary state variables (e.g., muscle activation), as "
+                "computing their derivatives requires realizing to "
+                "Acceleration.");
+            // Realizing to Acceleration would provide the accelerations from
+            // forward dynamics rather than those from the controls.
+            OPENSIM_THROW_IF(
+                    m_phase0.getIntegralCostStageDependency()
+                            >= SimTK::Stage::Acceleration ||
+                    m_phase0.getEndpointCostStageDependency()
+                            >= SimTK::Stage::Acceleration ||
+                    m_phase0.getPathConstraintStageDependency()
+                            >= SimTK::Stage::Acceleration, Exception,
+                "The implicit dynamics mode does not yet support costs or "
+                "path constraints that depend on the Acceleration stage "
+                "(e.g., MucoJointReactionNormCost).");
+            const double bound = solver.get_implicit_acceleration_bound();
+            for (int iu = 0; iu < state.getNU(); ++iu) {
+                const std::string& speedName =
+                        svNamesInSysOrder[state.getNQ() + iu];
+                std::string name = speedName;
+                const std::string speed = "/speed";
+                if (name.size() > speed.size() && name.compare(
+                        name.size() - speed.size(), speed.size(), speed) == 0) {
+                    name = name.substr(0, name.size() - speed.size());
+                }
+                this->add_control(name + "/accel", {-bound, bound});
+                this->add_path_constraint(name + "/residual", {0, 0});
+                m_speedNames.push_back(speedName);
+                m_accelerationControlNames.push_back(name + "/accel");
+            }
         }
         for (std::string name : m_phase0.createParameterNames()) {
             const MucoParameter& parameter = m_phase0.getParameter(name);
             this->add_parameter(name, convert(parameter.getBounds()));
         }
+
+        if (solver.get_compute_forces_at_velocity_stage()) {
+            std::string reason;
+            m_computeForcesAtVelocityStage =
+                    canComputeForcesAtVelocityStage(*m_context,
+                            svNamesInSysOrder, reason);
+            if (!m_computeForcesAtVelocityStage && solver.get_verbosity()) {
+                std::cout << "[MucoTropterSolver] Realizing to Dynamics to "
+                        "compute forces, since " << reason << std::endl;
+            }
+        }
     }
-    void initialize_on_mesh(const Eigen::VectorXd&) const override {
-        m_mucoProb.initialize(m_model);
+    void initialize_on_mesh(const Eigen::VectorXd& mesh) const override {
+        // If the initial and final times are fixed, the costs can precompute
+        // quantities at the mesh times.
+        const int numMeshPoints = (int)mesh.size();
+        SimTK::Vector meshTimes;
+        const auto initialBounds = m_phase0.getTimeInitialBounds();
+        const auto finalBounds = m_phase0.getTimeFinalBounds();
+        if (initialBounds.isEquality() && finalBounds.isEquality()) {
+            const double initialTime = initialBounds.getLower();
+            const double duration = finalBounds.getLower() - initialTime;
+            meshTimes.resize(numMeshPoints);
+            for (int i = 0; i < numMeshPoints; ++i) {
+                meshTimes[i] = initialTime + duration * mesh[i];
+            }
+        }
+        initializeContextOnMesh(*m_context, numMeshPoints, meshTimes);
     }
     void initialize_on_iterate(const Eigen::VectorXd& parameters)
             const override {
         // If they exist, apply parameter values to the model.
-        this->applyParametersToModel(parameters);
+        applyParametersToModel(*m_context, parameters);
     }
     void calc_differential_algebraic_equations(
             const tropter::Input<T>& in,
             tropter::Output<T> out) const override {
-
-        // TODO convert to implicit formulation.
+        Context& ctx = getContext();
 
         const auto& states = in.states;
-        const auto& controls = in.controls;
         const auto& adjuncts = in.adjuncts;
 
-        m_state.setTime(in.time);
-        std::copy(states.data(), states.data() + states.size(),
-                &m_state.updY()[0]);
-        //
-        // TODO do not copy? I think this will still make a copy:
-        // TODO use m_state.updY() = SimTK::Vector(states.size(), states.data(), true);
-        //m_state.setY(SimTK::Vector(states.size(), states.data(), true));
-
-        // Set the controls for actuators in the OpenSim model.
-        if (m_model.getNumControls()) {
-            auto& osimControls = m_model.updControls(m_state);
-            std::copy(controls.data(), controls.data() + controls.size(),
-                &osimControls[0]);
-            m_model.realizeVelocity(m_state);
-            m_model.setControls(m_state, osimControls);
-        }
+        // Set the time, states, and controls for actuators in the OpenSim
+        // model.
+        SimTK::State& state = updMeshPointState(ctx, in,
+                SimTK::Stage::Velocity, RealizationStatistics::DAE);
 
         // If enabled constraints exist in the model, compute accelerations
-        // based on Lagrange multipliers.
-        if (m_numMultibodyConstraintEqs) {
-            // TODO Antoine and Gil said realizing Dynamics is a lot costlier than
-            // realizing to Velocity and computing forces manually.
-            m_model.realizeDynamics(m_state);
-
-            const SimTK::MultibodySystem& multibody = 
-                m_model.getMultibodySystem();
-            const SimTK::Vector_<SimTK::SpatialVec>& appliedBodyForces =
-                multibody.getRigidBodyForces(m_state, SimTK::Stage::Dynamics);
-            const SimTK::Vector& appliedMobilityForces = 
-                multibody.getMobilityForces(m_state, SimTK::Stage::Dynamics);
+        // based on Lagrange multipliers. In implicit mode, compute the
+        // residual generalized forces for the given accelerations.
+        if (m_numMultibodyConstraintEqs || m_implicit) {
+            // The total forces are accumulated in the context's workspace.
+            auto& bodyForces = ctx.bodyForces;
+            auto& mobilityForces = ctx.mobilityForces;
+            if (m_computeForcesAtVelocityStage) {
+                realize(ctx, state, SimTK::Stage::Velocity,
+                        RealizationStatistics::DAE);
+                calcAppliedForces(ctx, state);
+            } else {
+                realize(ctx, state, SimTK::Stage::Dynamics,
+                        RealizationStatistics::DAE);
+                const SimTK::MultibodySystem& multibody =
+                    ctx.model.getMultibodySystem();
+                bodyForces = multibody.getRigidBodyForces(state,
+                        SimTK::Stage::Dynamics);
+                mobilityForces = multibody.getMobilityForces(state,
+                        SimTK::Stage::Dynamics);
+            }
 
             const SimTK::SimbodyMatterSubsystem& matter = 
-                m_model.getMatterSubsystem();
-            SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces;
-            SimTK::Vector constraintMobilityForces;
-            // Multipliers are negated so constraint forces can be used like 
-            // applied forces.
-            SimTK::Vector multipliers(m_numMultibodyConstraintEqs, 
-                adjuncts.data());
-            matter.calcConstraintForcesFromMultipliers(m_state, -multipliers,
-                constraintBodyForces, constraintMobilityForces);
-
-            SimTK::Vector& udot = m_state.updUDot();
-            matter.calcAccelerationIgnoringConstraints(m_state,
-                appliedMobilityForces + constraintMobilityForces,
-                appliedBodyForces + constraintBodyForces, udot, A_GB);
+                ctx.model.getMatterSubsystem();
+            if (m_numMultibodyConstraintEqs) {
+                // Multipliers are negated so constraint forces can be used
+                // like applied forces.
+                ctx.multipliers.resize(m_numMultibodyConstraintEqs);
+                for (int i = 0; i < m_numMultibodyConstraintEqs; ++i) {
+                    ctx.multipliers[i] = -adjuncts[i];
+                }
+                matter.calcConstraintForcesFromMultipliers(state,
+                    ctx.multipliers,
+                    ctx.constraintBodyForces, ctx.constraintMobilityForces);
+                bodyForces += ctx.constraintBodyForces;
+                mobilityForces += ctx.constraintMobilityForces;
+            }
+
+            if (m_implicit) {
+                // The generalized accelerations are the controls following
+                // those for the actuators.
+                const int nu = state.getNU();
+                ctx.udot.resize(nu);
+                std::copy(in.controls.data() + m_numActuatorControls,
+                        in.controls.data() + m_numActuatorControls + nu,
+                        &ctx.udot[0]);
+                matter.calcResidualForceIgnoringConstraints(state,
+                    mobilityForces, bodyForces, ctx.udot, ctx.residual);
+                std::copy(&ctx.residual[0], &ctx.residual[0] + nu,
+                        out.path.data() + m_numMultibodyConstraintEqs
+                                + m_numPathConstraintEqs);
+            } else {
+                SimTK::Vector& udot = state.updUDot();
+                matter.calcAccelerationIgnoringConstraints(state,
+                    mobilityForces, bodyForces, udot, ctx.A_GB);
+            }
            
             // Constraint errors.
             // TODO double-check that disable constraints don't show up in 
             // state
-            std::copy(&m_state.getQErr()[0], 
-                &m_state.getQErr()[0] + m_mpSum,
-                out.path.data());
+            if (m_mpSum) {
+                std::copy(&state.getQErr()[0],
+                    &state.getQErr()[0] + m_mpSum,
+                    out.path.data());
+            }
             // TODO if (!get_enforce_holonomic_constraints_only()) {
-            //    std::copy(&m_state.getUErr()[0],
-            //        &m_state.getUErr()[0] + m_mpSum + m_mvSum,
+            //    std::copy(&state.getUErr()[0],
+            //        &state.getUErr()[0] + m_mpSum + m_mvSum,
             //        out.path.data() + m_mpSum);
-            //    std::copy(&m_state.getUDotErr()[0],
-            //        &m_state.getUDotErr()[0] + m_mpSum + m_mvSum + m_maSum,
+            //    std::copy(&state.getUDotErr()[0],
+            //        &state.getUDotErr()[0] + m_mpSum + m_mvSum + m_maSum,
             //        out.path.data() + 2*m_mpSum + m_mvSum);
             //}
 
         } else {
             // TODO Antoine and Gil said realizing Dynamics is a lot costlier than
             // realizing to Velocity and computing forces manually.
-            m_model.realizeAcceleration(m_state);
+            realize(ctx, state, SimTK::Stage::Acceleration,
+                    RealizationStatistics::DAE);
         }
 
         // Copy errors from generic path constraints into output struct.
-        m_phase0.calcPathConstraintErrors(m_state, m_pathConstraintErrors);
-        std::copy(m_pathConstraintErrors.begin(),
-                  m_pathConstraintErrors.end(),
-                  out.path.data() + m_numMultibodyConstraintEqs);
+        if (m_numPathConstraintEqs) {
+            realize(ctx, state, ctx.phase->getPathConstraintStageDependency(),
+                    RealizationStatistics::PathConstraints);
+            const auto before = state.getSystemStage();
+            const Stopwatch stopwatch;
+            ctx.phase->calcPathConstraintErrors(state,
+                    ctx.pathConstraintErrors);
+            ctx.realizationStats.record(RealizationStatistics::PathConstraints,
+                    before, state.getSystemStage(),
+                    stopwatch.getElapsedTimeInNs());
+            std::copy(ctx.pathConstraintErrors.begin(),
+                      ctx.pathConstraintErrors.end(),
+                      out.path.data() + m_numMultibodyConstraintEqs);
+        }
 
         // Copy state derivative values to output struct.
-        std::copy(&m_state.getYDot()[0], &m_state.getYDot()[0] + states.size(),
-                  out.dynamics.data());   
+        if (m_implicit) {
+            const int nq = state.getNQ();
+            std::copy(&state.getQDot()[0], &state.getQDot()[0] + nq,
+                      out.dynamics.data());
+            std::copy(&ctx.udot[0], &ctx.udot[0] + state.getNU(),
+                      out.dynamics.data() + nq);
+        } else {
+            std::copy(&state.getYDot()[0],
+                      &state.getYDot()[0] + states.size(),
+                      out.dynamics.data());
+        }
     }
     
     void calc_integral_cost(const tropter::Input<T>& in, 
             T& integrand) const override {
         // Unpack variables.
-        const auto& time = in.time;
-        const auto& states = in.states;
-        const auto& controls = in.controls;
         const auto& adjuncts = in.adjuncts;
 
-        // TODO would it make sense to a vector of States, one for each mesh
-        // point, so that each can preserve their cache?
-        m_state.setTime(time);
-        std::copy(states.data(), states.data() + states.size(),
-                &m_state.updY()[0]);
-
-        // Set the controls for actuators in the OpenSim model. 
-        if (m_model.getNumControls()) {
-            auto& osimControls = m_model.updControls(m_state);
-            std::copy(controls.data(), controls.data() + controls.size(),
-                    &osimControls[0]);
-            m_model.realizePosition(m_state);
-            m_model.setControls(m_state, osimControls);
-        } else {
-            m_model.realizePosition(m_state);
+        integrand = 0;
+        Context& ctx = getContext();
+        if (ctx.phase->getNumIntegralCosts()) {
+            // The DAE for this mesh point was likely evaluated with the same
+            // values, in which case the state is already realized.
+            const SimTK::Stage stage =
+                    ctx.phase->getIntegralCostStageDependency();
+            SimTK::State& state = updMeshPointState(ctx, in, stage,
+                    RealizationStatistics::IntegralCost);
+            realize(ctx, state, stage, RealizationStatistics::IntegralCost);
+
+            const auto before = state.getSystemStage();
+            const Stopwatch stopwatch;
+            integrand = ctx.phase->calcIntegralCost(state, in.mesh_index);
+            ctx.realizationStats.record(RealizationStatistics::IntegralCost,
+                    before, state.getSystemStage(),
+                    stopwatch.getElapsedTimeInNs());
         }
 
-        integrand = m_phase0.calcIntegralCost(m_state);
-
         // TODO if (get_enforce_holonomic_constraints_only()) {
         // Add squared multiplers cost to integrand. Since we currently don't
         // include the derivatives of the holonomic contraint equations as path
@@ -444,28 +662,254 @@ public:
         // }
         
     }
+    bool calc_integral_cost_gradient(const tropter::Input<T>& in,
+            Eigen::Ref<VectorX<T>> states_gradient,
+            Eigen::Ref<VectorX<T>> controls_gradient,
+            Eigen::Ref<VectorX<T>> adjuncts_gradient) const override {
+        Context& ctx = getContext();
+        const MucoPhase& phase = *ctx.phase;
+        const int numStates = (int)in.states.size();
+        const int numControls = ctx.model.getNumControls();
+
+        // Costs that provide the gradient of their integrand.
+        if (phase.getNumIntegralCostsWithGradient()) {
+            const SimTK::Stage stage = phase.getIntegralCostStageDependency();
+            SimTK::State& state = updMeshPointState(ctx, in, stage,
+                    RealizationStatistics::IntegralCost);
+            realize(ctx, state, stage, RealizationStatistics::IntegralCost);
+            ctx.costStateGradient.resize(numStates);
+            ctx.costStateGradient = 0;
+            ctx.costControlGradient.resize(numControls);
+            ctx.costControlGradient = 0;
+            phase.calcIntegralCostGradient(state, in.mesh_index,
+                    ctx.costStateGradient, ctx.costControlGradient);
+            for (int i = 0; i < numStates; ++i) {
+                states_gradient[i] += ctx.costStateGradient[i];
+            }
+            for (int i = 0; i < numControls; ++i) {
+                controls_gradient[i] += ctx.costControlGradient[i];
+            }
+        }
+
+        // Central differences for the remaining costs. The integrand only
+        // depends on the variables at this mesh point, so we perturb a
+        // scratch state rather than evaluating the entire objective (and
+        // leave the cache of the mesh point's state intact).
+        if (phase.getNumIntegralCostsWithoutGradient()) {
+            const SimTK::Stage stage =
+                    phase.getIntegralCostWithoutGradientStageDependency();
+            const bool usesControls =
+                    numControls && stage >= SimTK::Stage::Velocity;
+            SimTK::State& state = ctx.state;
+            if (state.getTime() != in.time) state.setTime(in.time);
+            auto& y = ctx.perturbedY;
+            y.resize(numStates);
+            std::copy(in.states.data(), in.states.data() + numStates, &y[0]);
+            auto& controls = ctx.perturbedControls;
+            controls.resize(numControls);
+            std::copy(in.controls.data(), in.controls.data() + numControls,
+                    &controls[0]);
+            const auto calcIntegrand = [&]() {
+                updateStateVariablesIfChanged(state, &y[0]);
+                if (usesControls) {
+                    applyControls(ctx, state, &controls[0],
+                            RealizationStatistics::IntegralCost);
+                }
+                realize(ctx, state, stage, RealizationStatistics::IntegralCost);
+                return phase.calcIntegralCostWithoutGradient(state,
+                        in.mesh_index);
+            };
+            // TODO use a better estimate for this step size.
+            const double eps = std::sqrt(SimTK::Eps);
+            for (int i = 0; i < numStates; ++i) {
+                y[i] = in.states[i] + eps;
+                const double integrandPos = calcIntegrand();
+                y[i] = in.states[i] - eps;
+                const double integrandNeg = calcIntegrand();
+                y[i] = in.states[i];
+                states_gradient[i] += (integrandPos - integrandNeg) / (2 * eps);
+            }
+            if (usesControls) {
+                for (int i = 0; i < numControls; ++i) {
+                    controls[i] = in.controls[i] + eps;
+                    const double integrandPos = calcIntegrand();
+                    controls[i] = in.controls[i] - eps;
+                    const double integrandNeg = calcIntegrand();
+                    controls[i] = in.controls[i];
+                    controls_gradient[i] +=
+                            (integrandPos - integrandNeg) / (2 * eps);
+                }
+            }
+        }
+
+        // Squared multipliers cost (see calc_integral_cost()).
+        for (int i = 0; i < m_numMultibodyConstraintEqs; ++i) {
+            adjuncts_gradient[i] += 2 *
+                    m_mucoTropterSolver.get_multiplier_weight() *
+                    in.adjuncts[i];
+        }
+        return true;
+    }
+    bool calc_cost_dependencies(std::vector<int>& integral_cost_states,
+            std::vector<int>& integral_cost_controls,
+            std::vector<int>& integral_cost_adjuncts,
+            std::vector<int>& endpoint_cost_states) const override {
+        // The tropter states are in the order of Y, and the first tropter
+        // controls are the model's controls.
+        if (!m_phase0.getCostDependencies(integral_cost_states,
+                integral_cost_controls, endpoint_cost_states)) {
+            return false;
+        }
+        // Squared multipliers cost (see calc_integral_cost()).
+        for (int i = 0; i < m_numMultibodyConstraintEqs; ++i) {
+            integral_cost_adjuncts.push_back(i);
+        }
+        return true;
+    }
     void calc_endpoint_cost(const T& final_time, const VectorX<T>& states,
             const VectorX<T>& /*parameters*/, T& cost) const override {
-        // TODO avoid all of this if there are no endpoint costs.
-        m_state.setTime(final_time);
-        std::copy(states.data(), states.data() + states.size(),
-                &m_state.updY()[0]);
-        // TODO cannot use control signals...
-        m_model.updControls(m_state).setToNaN();
-        cost = m_phase0.calcEndpointCost(m_state);
+        Context& ctx = getContext();
+        if (!ctx.phase->getNumEndpointCosts()) {
+            cost = 0;
+            return;
+        }
+        if (ctx.state.getTime() != final_time) ctx.state.setTime(final_time);
+        updateStateVariablesIfChanged(ctx.state, states.data());
+        const SimTK::Stage stage = ctx.phase->getEndpointCostStageDependency();
+        if (stage >= SimTK::Stage::Velocity) {
+            // TODO cannot use control signals...
+            ctx.model.updControls(ctx.state).setToNaN();
+        }
+        realize(ctx, ctx.state, stage, RealizationStatistics::EndpointCost);
+        const auto before = ctx.state.getSystemStage();
+        const Stopwatch stopwatch;
+        cost = ctx.phase->calcEndpointCost(ctx.state);
+        ctx.realizationStats.record(RealizationStatistics::EndpointCost,
+                before, ctx.state.getSystemStage(),
+                stopwatch.getElapsedTimeInNs());
+    }
+
+    bool isImplicit() const { return m_implicit; }
+
+    /// In implicit mode, the names of the controls for the generalized
+    /// accelerations; these are not part of the MucoProblem.
+    const std::vector<std::string>& getAccelerationControlNames() const {
+        return m_accelerationControlNames;
+    }
+
+    /// In implicit mode, add the controls for the generalized accelerations
+    /// to an iterate that does not have them (e.g., the solution with
+    /// explicit dynamics) by differentiating the speeds, and order the
+    /// controls as in this problem. The multipliers of the optimization
+    /// problem are discarded, as they do not apply to this problem.
+    void addAccelerationControls(tropter::Iterate& iterate) const {
+        if (!m_implicit || iterate.time.size() == 0) return;
+        const auto& controlNames = this->get_control_names();
+        if (iterate.control_names == controlNames) return;
+
+        const int numTimes = (int)iterate.time.size();
+        Eigen::MatrixXd controls(controlNames.size(), numTimes);
+        auto findIndex = [](const std::vector<std::string>& names,
+                const std::string& name) {
+            return (int)(std::find(names.begin(), names.end(), name)
+                    - names.begin());
+        };
+        for (int ic = 0; ic < (int)controlNames.size(); ++ic) {
+            const int index = findIndex(iterate.control_names,
+                    controlNames[ic]);
+            if (index < (int)iterate.control_names.size()) {
+                controls.row(ic) = iterate.controls.row(index);
+                continue;
+            }
+            const int iaccel = ic - m_numActuatorControls;
+            OPENSIM_THROW_IF(iaccel < 0, Exception,
+                    "Expected the guess to contain control '"
+                    + controlNames[ic] + "'.");
+            const int ispeed = findIndex(iterate.state_names,
+                    m_speedNames[iaccel]);
+            OPENSIM_THROW_IF(ispeed == (int)iterate.state_names.size(),
+                    Exception, "Expected the guess to contain state '"
+                    + m_speedNames[iaccel] + "'.");
+            // Central differences on the interior and one-sided differences
+            // at the ends.
+            const auto& time = iterate.time;
+            const auto speed = iterate.states.row(ispeed);
+            for (int it = 0; it < numTimes; ++it) {
+                const int ibefore = std::max(it - 1, 0);
+                const int iafter = std::min(it + 1, numTimes - 1);
+                const double interval = time[iafter] - time[ibefore];
+                controls(ic, it) = interval == 0 ? 0 :
+                        (speed[iafter] - speed[ibefore]) / interval;
+            }
+        }
+        iterate.controls = controls;
+        iterate.control_names = controlNames;
+        iterate.variable_lower_multipliers.resize(0);
+        iterate.variable_upper_multipliers.resize(0);
+        iterate.constraint_multipliers.resize(0);
+    }
+
+    /// The realizations performed since the last call to
+    /// resetRealizationStatistics().
+    RealizationStatistics getRealizationStatistics() const {
+        return m_context->realizationStats;
+    }
+    void resetRealizationStatistics() const {
+        m_context->realizationStats.reset();
     }
 
 private:
     const MucoTropterSolver& m_mucoTropterSolver;
     const MucoProblem& m_mucoProb;
     const MucoPhase& m_phase0;
-    mutable Model m_model;
-    mutable SimTK::State m_state;
-    // This member variable avoids unnecessary extra allocation of memory for
-    // spatial accelerations, which are incidental to the computation of
-    // generalized accelerations when specifying the dynamics with model 
-    // constraints present.
-    mutable SimTK::Vector_<SimTK::SpatialVec> A_GB;
+
+    /// Everything that is modified while evaluating the problem. The problem
+    /// (like tropter's transcriptions) must not be evaluated from multiple
+    /// threads at once.
+    struct Context {
+        const MucoProblem* problem = nullptr;
+        const MucoPhase* phase = nullptr;
+        Model model;
+        SimTK::State state;
+        // This member variable avoids unnecessary extra allocation of memory
+        // for spatial accelerations, which are incidental to the computation
+        // of generalized accelerations when specifying the dynamics with
+        // model constraints present.
+        SimTK::Vector_<SimTK::SpatialVec> A_GB;
+        // Workspace for computing generalized accelerations from the applied
+        // forces and the multipliers when the model has constraints.
+        SimTK::Vector_<SimTK::SpatialVec> bodyForces;
+        SimTK::Vector mobilityForces;
+        SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces;
+        SimTK::Vector constraintMobilityForces;
+        SimTK::Vector multipliers;
+        // Generalized accelerations and residual forces in implicit mode.
+        SimTK::Vector udot;
+        SimTK::Vector residual;
+        // Workspace for the contribution of a single force element.
+        SimTK::Vector_<SimTK::SpatialVec> forceBodyForces;
+        SimTK::Vector_<SimTK::Vec3> forceParticleForces;
+        SimTK::Vector forceMobilityForces;
+        // Cached path constraint errors.
+        SimTK::Vector pathConstraintErrors;
+        // Workspace for the gradient of the integral cost at a mesh point.
+        SimTK::Vector costStateGradient;
+        SimTK::Vector costControlGradient;
+        SimTK::Vector perturbedY;
+        SimTK::Vector perturbedControls;
+        RealizationStatistics realizationStats;
+        // One state per mesh point, so that each mesh point preserves its
+        // cache across evaluations that do not change all of its values
+        // (e.g., finite differences with respect to a control). The
+        // controls last set in each state are stored alongside.
+        std::vector<SimTK::State> meshStates;
+        std::vector<SimTK::Vector> meshControls;
+        // The parameter values last applied to the model.
+        Eigen::VectorXd appliedParameters;
+        // Does any parameter require rebuilding the system when applied?
+        bool parametersRequireInitSystem = true;
+    };
+    std::unique_ptr<Context> m_context;
     // The number of scalar holonomic constraint equations enabled in the model. 
     // This does not count equations for derivatives of scalar holonomic 
     // constraints. 
@@ -479,20 +923,265 @@ private:
     // The total number of scalar constraint equations associated with
     // MucoPathConstraints added to the MucoProblem.
     mutable int m_numPathConstraintEqs = 0;
-    // Cached path constraint errors.
-    mutable SimTK::Vector m_pathConstraintErrors;
+    // Are the multibody dynamics expressed implicitly (see the dynamics_mode
+    // property)?
+    const bool m_implicit;
+    // The number of controls for the model's actuators; in implicit mode,
+    // the generalized accelerations follow these controls.
+    int m_numActuatorControls = 0;
+    // In implicit mode, the names of the speed states and of the
+    // corresponding acceleration controls, in the order of the speeds in the
+    // SimTK::State.
+    std::vector<std::string> m_speedNames;
+    std::vector<std::string> m_accelerationControlNames;
+    // Were the forces requested to be computed at the Velocity stage (see
+    // the compute_forces_at_velocity_stage property), and does the model
+    // allow it (see canComputeForcesAtVelocityStage())?
+    bool m_computeForcesAtVelocityStage = false;
+
+    void initializeContext(Context& context) const {
+        context.phase = &context.problem->getPhase(0);
+        context.model = context.phase->getModel();
+        // Disable all controllers.
+        // TODO temporary; don't want to actually do this.
+        context.model.finalizeFromProperties();
+        auto controllers = context.model.updComponentList<Controller>();
+        for (auto& controller : controllers) {
+            controller.set_enabled(false);
+        }
+        context.state = context.model.initSystem();
+        // The context's model is a new copy, so the costs must be initialized
+        // even if the problem has not changed. Later calls to
+        // initializeProblem() (e.g., for each mesh) skip unchanged costs.
+        context.problem->clearInitialization();
+        initializeProblem(context);
+        // Allocate path constraint error memory.
+        context.pathConstraintErrors.resize(
+                context.phase->getNumPathConstraintEquations());
+        context.pathConstraintErrors.setToZero();
+    }
+
+    void initializeProblem(Context& context) const {
+        context.problem->initialize(context.model);
+        context.parametersRequireInitSystem = false;
+        for (const auto& name : context.phase->createParameterNames()) {
+            if (context.phase->getParameter(name).requiresInitSystem()) {
+                context.parametersRequireInitSystem = true;
+            }
+        }
+    }
+
+    void initializeContextOnMesh(Context& context, int numMeshPoints,
+            const SimTK::Vector& meshTimes) const {
+        initializeProblem(context);
+        context.phase->initializeOnMesh(meshTimes);
+        context.meshStates.assign(numMeshPoints, context.state);
+        context.meshControls.assign(numMeshPoints,
+                SimTK::Vector(context.model.getNumControls(), SimTK::NaN));
+    }
+
+    /// Update the state for the mesh point of the given input, only
+    /// invalidating the stages that depend on values that changed. The
+    /// controls are only set if the caller requires a `stage` of Velocity or
+    /// higher (setting them requires realizing to Velocity).
+    SimTK::State& updMeshPointState(Context& ctx,
+            const tropter::Input<T>& in, SimTK::Stage stage,
+            RealizationStatistics::Caller caller) const {
+        if (in.mesh_index >= (int)ctx.meshStates.size()) {
+            ctx.meshStates.resize(in.mesh_index + 1, ctx.state);
+            ctx.meshControls.resize(in.mesh_index + 1,
+                    SimTK::Vector(ctx.model.getNumControls(), SimTK::NaN));
+        }
+        SimTK::State& state = ctx.meshStates[in.mesh_index];
+        if (state.getTime() != in.time) state.setTime(in.time);
+        updateStateVariablesIfChanged(state, in.states.data());
+
+        // In implicit mode, the controls also contain the generalized
+        // accelerations, which are not part of the state.
+        const auto* controls = in.controls.data();
+        const int numControls = ctx.model.getNumControls();
+        if (numControls && stage >= SimTK::Stage::Velocity) {
+            SimTK::Vector& lastControls = ctx.meshControls[in.mesh_index];
+            const bool controlsChanged = !std::equal(controls,
+                    controls + numControls, &lastControls[0]);
+            // The model's controls are a Velocity-stage cache variable, so
+            // they must be set again if the Velocity stage was invalidated.
+            if (controlsChanged ||
+                    state.getSystemStage() < SimTK::Stage::Velocity) {
+                applyControls(ctx, state, controls, caller);
+                std::copy(controls, controls + numControls, &lastControls[0]);
+            }
+        }
+        return state;
+    }
+
+    /// Set the model's controls in the state, which requires realizing to
+    /// Velocity.
+    void applyControls(Context& ctx, SimTK::State& state,
+            const double* controls,
+            RealizationStatistics::Caller caller) const {
+        auto& osimControls = ctx.model.updControls(state);
+        std::copy(controls, controls + ctx.model.getNumControls(),
+                &osimControls[0]);
+        realize(ctx, state, SimTK::Stage::Velocity, caller);
+        ctx.model.setControls(state, osimControls);
+        state.invalidateAllCacheAtOrAbove(SimTK::Stage::Dynamics);
+    }
+
+    Context& getContext() const { return *m_context; }
+
+    /// Sum the forces from all enabled force elements into the context's
+    /// bodyForces and mobilityForces. This requires only the Velocity stage,
+    /// and gives the same result as getRigidBodyForces() and
+    /// getMobilityForces() after realizing to Dynamics, without the other
+    /// Dynamics-stage computations, but only if every applied force comes
+    /// from a force element in the model's force subsystem and no force
+    /// element relies on a cache variable that depends on the Dynamics stage.
+    /// Use canComputeForcesAtVelocityStage() to check this.
+    void calcAppliedForces(Context& ctx, const SimTK::State& state) const {
+        const SimTK::SimbodyMatterSubsystem& matter =
+                ctx.model.getMatterSubsystem();
+        ctx.bodyForces.resize(matter.getNumBodies());
+        ctx.bodyForces.setToZero();
+        ctx.mobilityForces.resize(state.getNU());
+        ctx.mobilityForces.setToZero();
+        const SimTK::GeneralForceSubsystem& forces =
+                ctx.model.getForceSubsystem();
+        for (SimTK::ForceIndex iforce(0); iforce < forces.getNumForces();
+                ++iforce) {
+            const SimTK::Force& force = forces.getForce(iforce);
+            if (force.isDisabled(state)) continue;
+            force.calcForceContribution(state, ctx.forceBodyForces,
+                    ctx.forceParticleForces, ctx.forceMobilityForces);
+            ctx.bodyForces += ctx.forceBodyForces;
+            ctx.mobilityForces += ctx.forceMobilityForces;
+        }
+    }
+
+    /// We cannot tell from the model whether each force element can compute
+    /// its contribution from the Velocity stage, so we compare
+    /// calcAppliedForces() with the forces after realizing to Dynamics, at a
+    /// few pseudo-random states and controls within the bounds (near the
+    /// default values for unbounded variables). If a force element throws or
+    /// the forces differ, we provide the reason and return false. A force
+    /// element that behaves differently only outside of these samples goes
+    /// undetected.
+    bool canComputeForcesAtVelocityStage(Context& ctx,
+            const std::vector<std::string>& svNamesInSysOrder,
+            std::string& reason) const {
+        const Model& model = ctx.model;
+        SimTK::Random::Uniform random(0, 1);
+        random.setSeed(0);
+        const auto sample = [&random](const MucoBounds& bounds,
+                double defaultValue) {
+            if (std::isfinite(bounds.getLower()) &&
+                    std::isfinite(bounds.getUpper())) {
+                return bounds.getLower() + random.getValue() *
+                        (bounds.getUpper() - bounds.getLower());
+            }
+            return defaultValue + random.getValue() - 0.5;
+        };
+        std::vector<std::string> actuNames;
+        for (const auto& actu : model.getComponentList<Actuator>()) {
+            actuNames.push_back(actu.getAbsolutePathString());
+        }
+        const int numSamples = 3;
+        for (int isample = 0; isample < numSamples; ++isample) {
+            SimTK::State state = ctx.state;
+            for (int iy = 0; iy < state.getNY(); ++iy) {
+                state.updY()[iy] = sample(
+                        m_phase0.getStateInfo(svNamesInSysOrder[iy])
+                                .getBounds(), ctx.state.getY()[iy]);
+            }
+            if (model.getNumControls()) {
+                auto& controls = model.updControls(state);
+                for (int ic = 0; ic < (int)actuNames.size(); ++ic) {
+                    controls[ic] = sample(
+                            m_phase0.getControlInfo(actuNames[ic])
+                                    .getBounds(), 0.5);
+                }
+                model.realizeVelocity(state);
+                model.setControls(state, controls);
+                state.invalidateAllCacheAtOrAbove(SimTK::Stage::Dynamics);
+            } else {
+                model.realizeVelocity(state);
+            }
+            try {
+                calcAppliedForces(ctx, state);
+            } catch (const std::exception& e) {
+                reason = "a force element could not be evaluated at the "
+                        "Velocity stage: " + std::string(e.what());
+                return false;
+            }
+            model.realizeDynamics(state);
+            const SimTK::MultibodySystem& multibody =
+                    model.getMultibodySystem();
+            const auto& bodyForces = multibody.getRigidBodyForces(state,
+                    SimTK::Stage::Dynamics);
+            const auto& mobilityForces = multibody.getMobilityForces(state,
+                    SimTK::Stage::Dynamics);
+            double maxError = 0;
+            double maxForce = 0;
+            for (int ib = 0; ib < bodyForces.size(); ++ib) {
+                for (int k = 0; k < 2; ++k) {
+                    for (int j = 0; j < 3; ++j) {
+                        const double expected = bodyForces[ib][k][j];
+                        maxForce = std::max(maxForce, std::abs(expected));
+                        maxError = std::max(maxError,
+                                std::abs(ctx.bodyForces[ib][k][j] - expected));
+                    }
+                }
+            }
+            for (int iu = 0; iu < mobilityForces.size(); ++iu) {
+                maxForce = std::max(maxForce, std::abs(mobilityForces[iu]));
+                maxError = std::max(maxError,
+                        std::abs(ctx.mobilityForces[iu] - mobilityForces[iu]));
+            }
+            if (maxError > 1e-10 * (1 + maxForce)) {
+                reason = "the sum of the force elements' contributions at the "
+                        "Velocity stage differs from the forces at the "
+                        "Dynamics stage.";
+                return false;
+            }
+        }
+        return true;
+    }
 
-    void applyParametersToModel(const VectorX<T>& parameters) const
+    void realize(Context& context, const SimTK::State& state,
+            SimTK::Stage stage, RealizationStatistics::Caller caller) const {
+        context.realizationStats.realize(context.model.getSystem(),
+                state, stage, caller);
+    }
+
+    /// This is called for every evaluation of the objective and constraints,
+    /// so we avoid work if the parameters have not changed (e.g., when
+    /// perturbing other variables for finite differences), and only rebuild
+    /// the system if a parameter requires it.
+    void applyParametersToModel(Context& context,
+            const Eigen::VectorXd& parameters) const
     {
         if (parameters.size()) {
+            if (context.appliedParameters.size() == parameters.size() &&
+                    context.appliedParameters == parameters) {
+                return;
+            }
             // Warning: memory borrowed, not copied (when third argument to
             // SimTK::Vector constructor is true)
             SimTK::Vector mucoParams(
-                (int)m_phase0.createParameterNames().size(),
+                (int)context.phase->createParameterNames().size(),
                 parameters.data(), true);
 
-            m_phase0.applyParametersToModel(mucoParams);
-            m_model.initSystem();
+            context.phase->applyParametersToModel(mucoParams);
+            if (context.parametersRequireInitSystem) {
+                context.model.initSystem();
+            }
+            context.appliedParameters = parameters;
+            // The cached quantities in the states may depend on the
+            // parameters.
+            context.state.invalidateAll(SimTK::Stage::Instance);
+            for (auto& state : context.meshStates) {
+                state.invalidateAll(SimTK::Stage::Instance);
+            }
         }
     }
 };
@@ -503,15 +1192,24 @@ MucoTropterSolver::MucoTropterSolver() {
 
 void MucoTropterSolver::constructProperties() {
     constructProperty_num_mesh_points(100);
+    constructProperty_num_control_mesh_points(0);
     constructProperty_verbosity(2);
     constructProperty_optim_solver("ipopt");
     constructProperty_optim_max_iterations(-1);
     constructProperty_optim_convergence_tolerance(-1);
     constructProperty_optim_constraint_tolerance(-1);
+    constructProperty_optim_max_wall_time(-1);
+    constructProperty_optim_iteration_log_file("");
     constructProperty_optim_hessian_approximation("limited-memory");
     constructProperty_optim_sparsity_detection("random");
+    constructProperty_optim_remove_fixed_variables(false);
+    constructProperty_optim_automatic_scaling(false);
+    constructProperty_optim_jacobian_constant_detection(false);
     constructProperty_optim_ipopt_print_level(-1);
     constructProperty_multiplier_weight(100.0);
+    constructProperty_dynamics_mode("explicit");
+    constructProperty_implicit_acceleration_bound(1000);
+    constructProperty_compute_forces_at_velocity_stage(false);
     // TODO constructProperty_enforce_holonomic_constraints_only(true);
 
     constructProperty_guess_file("");
@@ -519,8 +1217,14 @@ void MucoTropterSolver::constructProperties() {
 
 std::shared_ptr<const tropter::Problem<double>>
 MucoTropterSolver::getTropterProblem() const {
-    if (!m_tropProblem) {
+    checkPropertyInSet(*this, getProperty_dynamics_mode(),
+            {"explicit", "implicit"});
+    // The problem depends on the solver's properties (e.g., the dynamics
+    // mode and the bounds on the acceleration controls).
+    if (!m_tropProblem || !isObjectUpToDateWithProperties()) {
         m_tropProblem = std::make_shared<OCProblem<double>>(*this);
+        const_cast<MucoTropterSolver*>(this)
+                ->setObjectIsUpToDateWithProperties();
     }
     return m_tropProblem;
 }
@@ -617,11 +1321,50 @@ MucoIterate MucoTropterSolver::createGuessTimeStepping() const {
             problem, statesTable, controlsTable);
 }
 
+/// Throw an exception if the guess is not compatible with the problem. In
+/// implicit mode, the guess may contain the controls for the generalized
+/// accelerations (which are not part of the MucoProblem) or not.
+void checkGuessIsCompatible(const MucoIterate& guess,
+        const MucoProblem& problem,
+        const std::vector<std::string>& accelerationControlNames) {
+    const auto& controlNames = guess.getControlNames();
+    std::vector<std::string> problemControlNames;
+    std::vector<int> problemControlIndices;
+    for (int ic = 0; ic < (int)controlNames.size(); ++ic) {
+        if (std::find(accelerationControlNames.begin(),
+                accelerationControlNames.end(), controlNames[ic]) ==
+                accelerationControlNames.end()) {
+            problemControlNames.push_back(controlNames[ic]);
+            problemControlIndices.push_back(ic);
+        }
+    }
+    if (problemControlNames.size() == controlNames.size()) {
+        guess.isCompatible(problem, true);
+        return;
+    }
+    SimTK::Matrix problemControls;
+    if (!problemControlNames.empty()) {
+        const auto& controls = guess.getControlsTrajectory();
+        problemControls.resize(guess.getNumTimes(),
+                (int)problemControlNames.size());
+        for (int ic = 0; ic < (int)problemControlIndices.size(); ++ic) {
+            problemControls.updCol(ic) =
+                    controls.col(problemControlIndices[ic]);
+        }
+    }
+    MucoIterate(guess.getTime(), guess.getStateNames(), problemControlNames,
+            guess.getMultiplierNames(), guess.getParameterNames(),
+            guess.getStatesTrajectory(), problemControls,
+            guess.getMultipliersTrajectory(), guess.getParameters())
+            .isCompatible(problem, true);
+}
+
 void MucoTropterSolver::setGuess(MucoIterate guess) {
     // Ensure the guess is compatible with this solver/problem.
     // Make sure to initialize the problem. TODO put in a better place.
     getTropterProblem();
-    guess.isCompatible(getProblem(), true);
+    checkGuessIsCompatible(guess, getProblem(),
+            m_tropProblem->getAccelerationControlNames());
     clearGuess();
     m_guessFromAPI = std::move(guess);
 }
@@ -643,7 +1386,9 @@ const MucoIterate& MucoTropterSolver::getGuess() const {
             assert(m_guessFromAPI.empty());
             // No need to load from file again if we've already loaded it.
             MucoIterate guessFromFile(get_guess_file());
-            guessFromFile.isCompatible(getProblem(), true);
+            getTropterProblem();
+            checkGuessIsCompatible(guessFromFile, getProblem(),
+                    m_tropProblem->getAccelerationControlNames());
             m_guessFromFile = guessFromFile;
             m_guessToUse.reset(&m_guessFromFile);
         } else {
@@ -668,6 +1413,7 @@ MucoSolution MucoTropterSolver::solveImpl() const {
     const Stopwatch stopwatch;
 
     auto ocp = getTropterProblem();
+    m_tropProblem->resetRealizationStatistics();
 
     checkPropertyInSet(*this, getProperty_verbosity(), {0, 1, 2});
 
@@ -690,7 +1436,14 @@ MucoSolution MucoTropterSolver::solveImpl() const {
     tropter::DirectCollocationSolver<double> dircol(ocp, "trapezoidal",
             get_optim_solver(), N);
 
+    checkPropertyInRangeOrSet(*this, getProperty_num_control_mesh_points(),
+            2, N, {0});
+    if (get_num_control_mesh_points()) {
+        dircol.set_num_control_mesh_points(get_num_control_mesh_points());
+    }
+
     dircol.set_verbosity(get_verbosity() >= 1);
+    dircol.set_remove_fixed_variables(get_optim_remove_fixed_variables());
 
     auto& optsolver = dircol.get_opt_solver();
 
@@ -710,6 +1463,12 @@ MucoSolution MucoTropterSolver::solveImpl() const {
     if (get_optim_constraint_tolerance() != -1)
         optsolver.set_constraint_tolerance(get_optim_constraint_tolerance());
 
+    checkPropertyInRangeOrSet(*this, getProperty_optim_max_wall_time(),
+            0.0, SimTK::NTraits<double>::getInfinity(), {-1.0});
+    if (get_optim_max_wall_time() != -1)
+        optsolver.set_max_wall_time(get_optim_max_wall_time());
+    optsolver.set_iteration_log_file(get_optim_iteration_log_file());
+
     optsolver.set_hessian_approximation(get_optim_hessian_approximation());
 
     if (get_optim_solver() == "ipopt") {
@@ -728,6 +1487,9 @@ MucoSolution MucoTropterSolver::solveImpl() const {
     checkPropertyInSet(*this, getProperty_optim_sparsity_detection(),
             {"random", "initial-guess"});
     optsolver.set_sparsity_detection(get_optim_sparsity_detection());
+    optsolver.set_automatic_scaling(get_optim_automatic_scaling());
+    optsolver.set_findiff_jacobian_constant_detection(
+            get_optim_jacobian_constant_detection());
 
     // Set advanced settings.
     //for (int i = 0; i < getProperty_optim_solver_options(); ++i) {
@@ -735,17 +1497,38 @@ MucoSolution MucoTropterSolver::solveImpl() const {
     //}
 
     tropter::Iterate tropIterate = convert(getGuess());
+    m_tropProblem->addAccelerationControls(tropIterate);
     tropter::Solution tropSolution = dircol.solve(tropIterate);
 
+    const auto realizationStats = m_tropProblem->getRealizationStatistics();
     if (get_verbosity()) {
         dircol.print_constraint_values(tropSolution);
+        realizationStats.print();
     }
 
     MucoSolution mucoSolution = convert(tropSolution);
 
+    const auto& tropStats = tropSolution.statistics;
+    std::map<std::string, double> statistics;
+    statistics["num_objective_evals"] = tropStats.num_objective_evals;
+    statistics["num_gradient_evals"] = tropStats.num_gradient_evals;
+    statistics["num_constraints_evals"] = tropStats.num_constraints_evals;
+    statistics["num_jacobian_evals"] = tropStats.num_jacobian_evals;
+    statistics["num_hessian_evals"] = tropStats.num_hessian_evals;
+    statistics["objective_time"] = tropStats.objective_time;
+    statistics["gradient_time"] = tropStats.gradient_time;
+    statistics["constraints_time"] = tropStats.constraints_time;
+    statistics["jacobian_time"] = tropStats.jacobian_time;
+    statistics["hessian_time"] = tropStats.hessian_time;
+    statistics["sparsity_detection_time"] = tropStats.sparsity_detection_time;
+    statistics["coloring_time"] = tropStats.coloring_time;
+    statistics["recovery_time"] = tropStats.recovery_time;
+    realizationStats.addTo(statistics);
+
     // TODO move this to convert():
     MucoSolver::setSolutionStats(mucoSolution, tropSolution.success,
-            tropSolution.status, tropSolution.num_iterations);
+            tropSolution.status, tropSolution.num_iterations,
+            std::move(statistics));
 
     if (get_verbosity()) {
         std::cout << std::string(79, '-') << "\n";
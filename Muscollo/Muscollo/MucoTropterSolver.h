@@ -46,6 +46,10 @@ OpenSim_DECLARE_CONCRETE_OBJECT(MucoTropterSolver, MucoSolver);
 public:
     OpenSim_DECLARE_PROPERTY(num_mesh_points, int,
     "The number of mesh points for discretizing the problem (default: 100).");
+    OpenSim_DECLARE_PROPERTY(num_control_mesh_points, int,
+    "The number of equally-spaced points at which the controls are "
+    "variables; the controls are linearly interpolated to the mesh points. "
+    "0 for controls at every mesh point (default: 0).");
     OpenSim_DECLARE_PROPERTY(verbosity, int,
     "0 for silent. 1 for only Muscollo's own output. "
     "2 for output from tropter and the underlying solver (default: 2).");
@@ -60,11 +64,30 @@ public:
     OpenSim_DECLARE_PROPERTY(optim_constraint_tolerance, double,
     "Tolerance used to determine if the constraints are satisfied "
     "(-1 for solver's default)");
+    OpenSim_DECLARE_PROPERTY(optim_max_wall_time, double,
+    "Stop the optimization after this many seconds of elapsed (wall-clock) "
+    "time; checked at the end of each iteration (IPOPT only; "
+    "-1 for no limit).");
+    OpenSim_DECLARE_PROPERTY(optim_iteration_log_file, std::string,
+    "Write the objective, infeasibilities, step sizes, and time spent in "
+    "each function for each iteration to this CSV file (IPOPT only; "
+    "empty for no file).");
     OpenSim_DECLARE_PROPERTY(optim_hessian_approximation, std::string,
     "'limited-memory' (default) for quasi-Newton, or 'exact' for full Newton.");
     OpenSim_DECLARE_PROPERTY(optim_sparsity_detection, std::string,
     "Iterate used to detect sparsity pattern of Jacobian/Hessian; "
     "'random' (default) or 'initial-guess'");
+    OpenSim_DECLARE_PROPERTY(optim_automatic_scaling, bool,
+    "Scale variables by their bounds and constraints by their Jacobian at "
+    "the initial guess (IPOPT only; default: false).");
+    OpenSim_DECLARE_PROPERTY(optim_remove_fixed_variables, bool,
+    "Remove variables with equal lower and upper bounds (e.g., fixed initial "
+    "states) from the optimization problem (default: false).");
+    OpenSim_DECLARE_PROPERTY(optim_jacobian_constant_detection, bool,
+    "Detect the entries of the constraint Jacobian that do not change "
+    "between iterates, compute them only once, and, if the whole Jacobian "
+    "is constant, tell IPOPT not to re-evaluate it. Only use this with "
+    "smooth models (no contact; default: false).");
     OpenSim_DECLARE_PROPERTY(optim_ipopt_print_level, int,
     "IPOPT's verbosity (see IPOPT documentation).");
     OpenSim_DECLARE_PROPERTY(multiplier_weight, double,
@@ -72,6 +95,23 @@ public:
     "control problem when only enforcing holonomic constraints in the model. A "
     "relatively high weight of 100 is set by default (so model actuators are  "
     "preferred).")
+    OpenSim_DECLARE_PROPERTY(dynamics_mode, std::string,
+    "'explicit' (default) to compute the generalized accelerations with "
+    "forward dynamics, or 'implicit' to add the generalized accelerations as "
+    "controls (named <coordinate>/accel) and enforce the multibody dynamics "
+    "as path constraints on the residual generalized forces from inverse "
+    "dynamics. Implicit mode does not support auxiliary state variables.");
+    OpenSim_DECLARE_PROPERTY(implicit_acceleration_bound, double,
+    "In implicit mode, the generalized accelerations are bounded by "
+    "[-bound, bound] (default: 1000).");
+    OpenSim_DECLARE_PROPERTY(compute_forces_at_velocity_stage, bool,
+    "For models with kinematic constraints, sum the forces from the model's "
+    "force elements after realizing only to Velocity, rather than realizing "
+    "to Dynamics (default: false). This requires that each force element "
+    "can compute its contribution from the Velocity stage. The solver checks "
+    "this at a few sampled states and controls within the bounds and "
+    "realizes to Dynamics if the check fails, but the check cannot detect "
+    "force elements that differ only elsewhere.");
     // TODO OpenSim_DECLARE_LIST_PROPERTY(enforce_constraint_kinematic_levels, 
     //   std::string, "");
     // TODO must make more general for multiple phases, mesh refinement.
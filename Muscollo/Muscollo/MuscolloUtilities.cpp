@@ -27,6 +27,7 @@
 #include <OpenSim/Simulation/Control/PrescribedController.h>
 #include <OpenSim/Common/GCVSpline.h>
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 
@@ -307,6 +308,27 @@ OpenSim::createSystemYIndexMap(const Model& model) {
     return sysYIndices;
 }
 
+// This preserves, for example, the position-level cache if only the speeds
+// changed.
+void OpenSim::updateStateVariablesIfChanged(SimTK::State& state,
+        const double* y) {
+    const int nq = state.getNQ();
+    const int nu = state.getNU();
+    const int nz = state.getNZ();
+    // Y is ordered Q, U, Z.
+    if (nq && !std::equal(y, y + nq, &state.getQ()[0])) {
+        std::copy(y, y + nq, &state.updQ()[0]);
+    }
+    y += nq;
+    if (nu && !std::equal(y, y + nu, &state.getU()[0])) {
+        std::copy(y, y + nu, &state.updU()[0]);
+    }
+    y += nu;
+    if (nz && !std::equal(y, y + nz, &state.getZ()[0])) {
+        std::copy(y, y + nz, &state.updZ()[0]);
+    }
+}
+
 std::string OpenSim::format_c(const char* format, ...) {
     // Get buffer size.
     va_list args;
@@ -77,6 +77,12 @@ OSIMMUSCOLLO_API void visualize(Model, TimeSeriesTable);
 OSIMMUSCOLLO_API void prescribeControlsToModel(const MucoIterate& iterate, 
     Model& model);
 
+/// Copy the state variable values `y` (in the order of SimTK::State::getY())
+/// into the state, only writing (and thereby invalidating the cache for) the
+/// Q, U, or Z values that changed.
+OSIMMUSCOLLO_API
+void updateStateVariablesIfChanged(SimTK::State& state, const double* y);
+
 #ifndef SWIG
 /// The map provides the index of each state variable in
 /// SimTK::State::getY() from its state variable path string.
@@ -0,0 +1,57 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Muscollo: sandboxInverseMuscleSolverDerivatives.cpp                *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2017 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Compare the time to solve the gait10dof18musc problem (right leg) with each
+// derivative_method of GlobalStaticOptimization ('provided' versus 'adolc')
+// and INDYGO ('adolc' versus 'finite_difference'). Build in Release.
+
+#include <Muscollo/InverseMuscleSolver/GlobalStaticOptimization.h>
+#include <Muscollo/InverseMuscleSolver/INDYGO.h>
+#include <Muscollo/MuscolloUtilities.h>
+
+using namespace OpenSim;
+
+void runGSO(const std::string& derivativeMethod) {
+    GlobalStaticOptimization gso("testGait10dof18musc_GSO_setup.xml");
+    gso.set_derivative_method(derivativeMethod);
+    const Stopwatch stopwatch;
+    GlobalStaticOptimization::Solution solution = gso.solve();
+    std::cout << "[sandbox] GlobalStaticOptimization derivative_method: "
+            << derivativeMethod << " wall time: "
+            << stopwatch.getElapsedTimeFormatted() << std::endl;
+}
+
+void runINDYGO(const std::string& derivativeMethod) {
+    INDYGO mrs("testGait10dof18musc_INDYGO_setup.xml");
+    mrs.set_derivative_method(derivativeMethod);
+    const Stopwatch stopwatch;
+    INDYGO::Solution solution = mrs.solve();
+    std::cout << "[sandbox] INDYGO derivative_method: "
+            << derivativeMethod << " wall time: "
+            << stopwatch.getElapsedTimeFormatted() << std::endl;
+}
+
+int main() {
+    for (const std::string method : {"provided", "adolc"}) {
+        runGSO(method);
+    }
+    for (const std::string method : {"adolc", "finite_difference"}) {
+        runINDYGO(method);
+    }
+    return EXIT_SUCCESS;
+}
@@ -710,6 +710,35 @@ void test2Muscles2DOFs_GSO_GenForces(
     compareSolution_GSO(solution, ocpSolution, reserveOptimalForce);
 }
 
+// The derivatives provided by the problem give the same solution as ADOL-C.
+void test2Muscles2DOFs_GSO_DerivativeMethod(
+        const std::pair<TimeSeriesTable, TimeSeriesTable>& data,
+        const Model& model) {
+    const auto& kinematics = data.second;
+
+    auto solve = [&](const std::string& derivativeMethod) {
+        GlobalStaticOptimization gso;
+        gso.setModel(model);
+        gso.setKinematicsData(kinematics);
+        gso.set_lowpass_cutoff_frequency_for_joint_moments(80);
+        gso.set_create_reserve_actuators(0.001);
+        gso.set_mesh_point_frequency(500);
+        gso.set_derivative_method(derivativeMethod);
+        return gso.solve();
+    };
+    GlobalStaticOptimization::Solution provided = solve("provided");
+    GlobalStaticOptimization::Solution adolc = solve("adolc");
+    for (const auto& label : adolc.activation.getColumnLabels()) {
+        compare(provided.activation, label, adolc.activation, label, 1e-4);
+    }
+    for (const auto& label : adolc.other_controls.getColumnLabels()) {
+        compare(provided.other_controls, label, adolc.other_controls, label,
+                1e-4);
+    }
+
+    SimTK_TEST_MUST_THROW_EXC(solve("unknown"), Exception);
+}
+
 void compareSolution_INDYGO(const INDYGO::Solution& actual,
                          const TimeSeriesTable& expected,
                          const double& reserveOptimalForce) {
@@ -781,6 +810,26 @@ void test2Muscles2DOFs_INDYGO(
     compareSolution_INDYGO(solution, ocpSolution, reserveOptimalForce);
 }
 
+// Solve without ADOL-C, using finite differences for the derivatives.
+void test2Muscles2DOFs_INDYGO_FiniteDifference(
+        const std::pair<TimeSeriesTable, TimeSeriesTable>& data,
+        const Model& model) {
+    const auto& ocpSolution = data.first;
+    const auto& kinematics = data.second;
+
+    INDYGO mrs;
+    mrs.setModel(model);
+    mrs.setKinematicsData(kinematics);
+    mrs.set_lowpass_cutoff_frequency_for_joint_moments(20);
+    const double reserveOptimalForce = 0.01;
+    mrs.set_create_reserve_actuators(reserveOptimalForce);
+    mrs.set_zero_initial_activation(true);
+    mrs.set_derivative_method("finite_difference");
+    INDYGO::Solution solution = mrs.solve();
+
+    compareSolution_INDYGO(solution, ocpSolution, reserveOptimalForce);
+}
+
 // Load INDYGO from an XML file.
 void test2Muscles2DOFs_INDYGO_Filebased(
         const std::pair<TimeSeriesTable, TimeSeriesTable>& data) {
@@ -854,10 +903,14 @@ int main() {
             SimTK_SUBTEST2(test2Muscles2DOFs_GSO, data, model);
             SimTK_SUBTEST1(test2Muscles2DOFs_GSO_Filebased, data);
             SimTK_SUBTEST2(test2Muscles2DOFs_GSO_GenForces, data, model);
+            SimTK_SUBTEST2(test2Muscles2DOFs_GSO_DerivativeMethod, data,
+                    model);
         }
         {
             auto data = solveForTrajectory_INDYGO(model);
             SimTK_SUBTEST2(test2Muscles2DOFs_INDYGO, data, model);
+            SimTK_SUBTEST2(test2Muscles2DOFs_INDYGO_FiniteDifference, data,
+                    model);
             SimTK_SUBTEST1(test2Muscles2DOFs_INDYGO_Filebased, data);
             SimTK_SUBTEST2(test2Muscles2DOFs_INDYGO_GenForces, data, model);
         }
@@ -526,6 +526,12 @@ void testDoublePendulumPointOnLine() {
     solution.write("testConstraints_testDoublePendulumPointOnLine.sto");
     //muco.visualize(solution);
 
+    // Summing the forces after realizing only to Velocity gives the same
+    // solution.
+    ms.set_compute_forces_at_velocity_stage(true);
+    MucoSolution solutionVelocityStage = muco.solve();
+    SimTK_TEST(solutionVelocityStage.isNumericallyEqual(solution, 1e-3));
+
     model.initSystem();
     StatesTrajectory states = solution.exportToStatesTrajectory(mp);
     for (const auto& s : states) {
@@ -544,6 +550,60 @@ void testDoublePendulumPointOnLine() {
     runForwardSimulation(model, solution, 1e-1);
 }
 
+/// Summing the force elements' contributions at the Velocity stage must give
+/// the same solution as realizing to Dynamics for a model with a path-based
+/// force, and the controls must reproduce the solution in a forward
+/// simulation (which realizes to Acceleration).
+void testDoublePendulumPathSpringVelocityStage() {
+    MucoTool muco;
+    muco.setName("double_pendulum_path_spring");
+    MucoProblem& mp = muco.updProblem();
+    Model model = createDoublePendulumModel();
+    const Body& b0 = model.getBodySet().get("b0");
+    const Body& b1 = model.getBodySet().get("b1");
+    const Station& endeff = model.getComponent<Station>("endeff");
+    PointOnLineConstraint* constraint = new PointOnLineConstraint(
+        model.getGround(), Vec3(0, 1, 0), Vec3(0), b1, endeff.get_location());
+    model.addConstraint(constraint);
+    // The spring spans both joints and has a velocity-dependent tension.
+    auto* spring = new PathSpring("spring", 0.5, 10, 0.1);
+    spring->updGeometryPath().appendNewPathPoint("origin", model.getGround(),
+            Vec3(0.2, 0.2, 0));
+    spring->updGeometryPath().appendNewPathPoint("via", b0,
+            Vec3(-0.5, 0.1, 0));
+    spring->updGeometryPath().appendNewPathPoint("insertion", b1,
+            Vec3(-0.5, 0.1, 0));
+    model.addForce(spring);
+    model.finalizeConnections();
+    mp.setModel(model);
+
+    mp.setTimeBounds(0, 1);
+    mp.setStateInfo("/jointset/j0/q0/value", {-10, 10}, 0, SimTK::Pi / 2);
+    mp.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    mp.setStateInfo("/jointset/j1/q1/value", {-10, 10}, SimTK::Pi, 0);
+    mp.setStateInfo("/jointset/j1/q1/speed", {-50, 50}, 0, 0);
+    mp.setControlInfo("/tau0", {-100, 100});
+    mp.setControlInfo("/tau1", {-100, 100});
+
+    MucoControlCost effort;
+    mp.addCost(effort);
+
+    MucoTropterSolver& ms = muco.initSolver();
+    ms.set_num_mesh_points(15);
+    ms.set_optim_solver("ipopt");
+    ms.set_optim_convergence_tolerance(1e-3);
+    ms.set_optim_hessian_approximation("exact");
+    ms.setGuess("bounds");
+
+    MucoSolution solution = muco.solve();
+
+    ms.set_compute_forces_at_velocity_stage(true);
+    MucoSolution solutionVelocityStage = muco.solve();
+    SimTK_TEST(solutionVelocityStage.isNumericallyEqual(solution, 1e-3));
+
+    runForwardSimulation(model, solutionVelocityStage, 1e-1);
+}
+
 /// Solve an optimal control problem where a double pendulum must reach a 
 /// specified final configuration while subject to a constraint that couples
 /// its two coordinates together via a linear relationship and minimizing 
@@ -854,6 +914,7 @@ int main() {
         SimTK_SUBTEST(testPrescribedMotion);
         // Direct collocation subtests.
         SimTK_SUBTEST(testDoublePendulumPointOnLine);
+        SimTK_SUBTEST(testDoublePendulumPathSpringVelocityStage);
         MucoSolution couplerSolution;
         SimTK_SUBTEST1(testDoublePendulumCoordinateCoupler, couplerSolution);
         SimTK_SUBTEST1(testDoublePendulumPrescribedMotion, couplerSolution);
@@ -17,8 +17,12 @@
  * -------------------------------------------------------------------------- */
 
 #include <Muscollo/osimMuscollo.h>
+#include <OpenSim/Simulation/SimbodyEngine/PinJoint.h>
 #include <OpenSim/Simulation/SimbodyEngine/SliderJoint.h>
 #include <OpenSim/Actuators/CoordinateActuator.h>
+#include <OpenSim/Simulation/Model/Marker.h>
+
+#include <fstream>
 
 using namespace OpenSim;
 
@@ -190,8 +194,268 @@ void testMucoControlCost() {
     }
 }
 
+/// The marker tracking cost, which groups markers by body and can use
+/// reference locations precomputed at the mesh times, matches a direct
+/// computation of the weighted squared marker errors.
+void testMucoMarkerTrackingCost() {
+    Model model = createSlidingMassModel();
+    const auto& body = model.getBodySet().get("body");
+    // Interleave markers on different bodies.
+    model.addMarker(new Marker("m0", body, SimTK::Vec3(0, 0.5, 0)));
+    model.addMarker(new Marker("m1", model.getGround(), SimTK::Vec3(1, 0, 0)));
+    model.addMarker(new Marker("m2", body, SimTK::Vec3(0.2, 0, 0.1)));
+    model.finalizeConnections();
+    SimTK::State state = model.initSystem();
+
+    auto calcRefLocation = [](double time, int i) {
+        return SimTK::Vec3(time, 0.1 * i, -0.2 * time);
+    };
+    const std::vector<std::string> names{
+            "/markerset/m0", "/markerset/m1", "/markerset/m2"};
+    TimeSeriesTableVec3 markerTrajectories;
+    markerTrajectories.setColumnLabels(names);
+    for (int itime = 0; itime <= 100; ++itime) {
+        const double time = 0.01 * itime;
+        markerTrajectories.appendRow(time, {calcRefLocation(time, 0),
+                calcRefLocation(time, 1), calcRefLocation(time, 2)});
+    }
+    Set<MarkerWeight> markerWeights;
+    markerWeights.cloneAndAppend({"/markerset/m0", 2});
+    markerWeights.cloneAndAppend({"/markerset/m1", 1});
+    markerWeights.cloneAndAppend({"/markerset/m2", 3});
+
+    MucoMarkerTrackingCost cost;
+    cost.setMarkersReference(
+            MarkersReference(markerTrajectories, &markerWeights));
+    cost.initialize(model);
+    cost.initializeOnMesh(createVectorLinspace(3, 0, 1));
+
+    state.setTime(0.5);
+    model.getCoordinateSet().get("position").setValue(state, 0.3);
+    model.realizePosition(state);
+    const std::vector<double> weights{2, 1, 3};
+    double expected = 0;
+    for (int i = 0; i < 3; ++i) {
+        const auto& marker = model.getComponent<Marker>(names[i]);
+        expected += weights[i] * (marker.getLocationInGround(state) -
+                calcRefLocation(0.5, i)).normSqr();
+    }
+    // Using the precomputed reference locations.
+    SimTK_TEST_EQ_TOL(cost.calcIntegralCost(state, 1), expected, 1e-6);
+    // Evaluating the reference splines.
+    SimTK_TEST_EQ_TOL(cost.calcIntegralCost(state), expected, 1e-6);
+}
+
+/// The gradients of the integrand provided by the costs match finite
+/// differences of the integrand.
+void testMucoCostGradients() {
+    Model model = createSlidingMassModel();
+    SimTK::State state = model.initSystem();
+
+    MucoControlCost effort;
+    effort.set_weight(3);
+    effort.initialize(model);
+
+    TimeSeriesTable ref;
+    ref.setColumnLabels({"/slider/position/value", "/slider/position/speed"});
+    for (int itime = 0; itime <= 10; ++itime) {
+        const double time = 0.1 * itime;
+        ref.appendRow(time, {time * time, 2 * time});
+    }
+    MucoStateTrackingCost tracking;
+    tracking.setReference(ref);
+    tracking.setWeight("/slider/position/speed", 2);
+    tracking.initialize(model);
+
+    auto calcIntegrand = [&](const MucoCost& cost, const SimTK::Vector& y,
+            double control) {
+        state.updY() = y;
+        model.realizeVelocity(state);
+        model.setControls(state, SimTK::Vector(1, control));
+        return cost.calcIntegralCost(state);
+    };
+    state.setTime(0.45);
+    SimTK::Vector y(2);
+    y[0] = 0.3;
+    y[1] = -0.2;
+    const double control = 1.5;
+    const double eps = 1e-6;
+    for (const MucoCost* cost : std::vector<const MucoCost*>{
+            &effort, &tracking}) {
+        SimTK_TEST(cost->hasIntegralCostGradient());
+        SimTK::Vector stateGradient(2, 0.0);
+        SimTK::Vector controlGradient(1, 0.0);
+        calcIntegrand(*cost, y, control);
+        cost->calcIntegralCostGradient(state, -1, stateGradient,
+                controlGradient);
+
+        SimTK::Vector expectedStateGradient(2);
+        for (int i = 0; i < 2; ++i) {
+            SimTK::Vector yPerturbed = y;
+            yPerturbed[i] = y[i] + eps;
+            const double integrandPos = calcIntegrand(*cost, yPerturbed,
+                    control);
+            yPerturbed[i] = y[i] - eps;
+            const double integrandNeg = calcIntegrand(*cost, yPerturbed,
+                    control);
+            expectedStateGradient[i] =
+                    (integrandPos - integrandNeg) / (2 * eps);
+        }
+        const double expectedControlGradient =
+                (calcIntegrand(*cost, y, control + eps) -
+                 calcIntegrand(*cost, y, control - eps)) / (2 * eps);
+        SimTK_TEST_EQ_TOL(stateGradient, expectedStateGradient, 1e-5);
+        SimTK_TEST_EQ_TOL(controlGradient[0], expectedControlGradient, 1e-5);
+    }
+    SimTK_TEST(!MucoFinalTimeCost().hasIntegralCostGradient());
+
+    // The costs declare the variables on which they depend.
+    std::vector<int> stateIndices;
+    std::vector<int> controlIndices;
+    SimTK_TEST(effort.getDependencies(stateIndices, controlIndices));
+    SimTK_TEST(stateIndices.empty());
+    SimTK_TEST(controlIndices == std::vector<int>{0});
+    controlIndices.clear();
+    SimTK_TEST(tracking.getDependencies(stateIndices, controlIndices));
+    SimTK_TEST((stateIndices == std::vector<int>{0, 1}));
+    SimTK_TEST(controlIndices.empty());
+}
+
+/// The endpoint cost of a phase is the sum of its endpoint costs.
+void testMultipleEndpointCosts() {
+    MucoProblem problem;
+    Model model = createSlidingMassModel();
+    problem.setModel(model);
+    MucoFinalTimeCost cost1;
+    cost1.setName("final_time_1");
+    problem.addCost(cost1);
+    MucoFinalTimeCost cost2;
+    cost2.setName("final_time_2");
+    cost2.set_weight(3);
+    problem.addCost(cost2);
+    SimTK::State state = model.initSystem();
+    problem.initialize(model);
+    state.setTime(1.5);
+    SimTK_TEST_EQ(problem.getPhase().calcEndpointCost(state), 6.0);
+}
+
+/// The joint reaction cost computes the reactions for all joints at once,
+/// and matches the sum of the norms of the reactions computed by each joint.
+void testMucoJointReactionNormCost() {
+    Model model;
+    model.setName("double_pendulum");
+    auto* b0 = new Body("b0", 1, SimTK::Vec3(0), SimTK::Inertia(1));
+    model.addBody(b0);
+    auto* b1 = new Body("b1", 1, SimTK::Vec3(0), SimTK::Inertia(1));
+    model.addBody(b1);
+    auto* j0 = new PinJoint("j0", model.getGround(), SimTK::Vec3(0),
+            SimTK::Vec3(0), *b0, SimTK::Vec3(-1, 0, 0), SimTK::Vec3(0));
+    auto* j1 = new PinJoint("j1", *b0, SimTK::Vec3(0), SimTK::Vec3(0),
+            *b1, SimTK::Vec3(-1, 0, 0), SimTK::Vec3(0));
+    model.addJoint(j0);
+    model.addJoint(j1);
+    model.finalizeConnections();
+    SimTK::State state = model.initSystem();
+    state.updQ()[0] = 0.3;
+    state.updQ()[1] = -0.7;
+    state.updU()[0] = 1.5;
+    state.updU()[1] = 0.4;
+    model.realizeAcceleration(state);
+
+    const double reaction0 =
+            j0->calcReactionOnChildExpressedInGround(state).norm();
+    const double reaction1 =
+            j1->calcReactionOnChildExpressedInGround(state).norm();
+
+    MucoJointReactionNormCost cost;
+    cost.setJointPath("/jointset/j1");
+    cost.initialize(model);
+    SimTK_TEST_EQ_TOL(cost.calcIntegralCost(state), reaction1, 1e-10);
+
+    cost.addJointPath("/jointset/j0");
+    cost.initialize(model);
+    SimTK_TEST_EQ_TOL(cost.calcIntegralCost(state), reaction0 + reaction1,
+            1e-10);
+
+    // The reactions depend on all variables through the accelerations.
+    std::vector<int> stateIndices;
+    std::vector<int> controlIndices;
+    SimTK_TEST(!cost.getDependencies(stateIndices, controlIndices));
+
+    cost.addJointPath("nonexistent");
+    SimTK_TEST_MUST_THROW_EXC(cost.initialize(model), Exception);
+
+    // The cost realizes the state to Acceleration if necessary.
+    SimTK::State unrealized = state;
+    unrealized.updU()[0] = 1.5;
+    SimTK_TEST(unrealized.getSystemStage() < SimTK::Stage::Acceleration);
+    cost.setJointPath("/jointset/j1");
+    cost.initialize(model);
+    SimTK_TEST_EQ_TOL(cost.calcIntegralCost(unrealized), reaction1, 1e-10);
+
+    // At least one joint path is required.
+    SimTK_TEST_MUST_THROW_EXC(MucoJointReactionNormCost().initialize(model),
+            Exception);
+
+    // Files written before the joint_paths property existed provide a single
+    // joint_path.
+    const std::string oldFile =
+            "testMucoCosts_testMucoJointReactionNormCost_old.xml";
+    {
+        std::ofstream stream(oldFile);
+        stream << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+                "<OpenSimDocument Version=\"40000\">\n"
+                "    <MucoJointReactionNormCost name=\"reaction\">\n"
+                "        <joint_path>/jointset/j1</joint_path>\n"
+                "    </MucoJointReactionNormCost>\n"
+                "</OpenSimDocument>\n";
+    }
+    std::unique_ptr<MucoJointReactionNormCost> oldCost(
+            dynamic_cast<MucoJointReactionNormCost*>(
+                    Object::makeObjectFromFile(oldFile)));
+    SimTK_TEST(oldCost);
+    oldCost->initialize(model);
+    SimTK_TEST_EQ_TOL(oldCost->calcIntegralCost(state), reaction1, 1e-10);
+
+    // Round trip with both joints.
+    oldCost->addJointPath("/jointset/j0");
+    const std::string newFile =
+            "testMucoCosts_testMucoJointReactionNormCost_new.xml";
+    oldCost->print(newFile);
+    std::unique_ptr<MucoJointReactionNormCost> newCost(
+            dynamic_cast<MucoJointReactionNormCost*>(
+                    Object::makeObjectFromFile(newFile)));
+    SimTK_TEST(newCost);
+    newCost->initialize(model);
+    SimTK_TEST_EQ_TOL(newCost->calcIntegralCost(state), reaction0 + reaction1,
+            1e-10);
+
+    // The joint paths may be provided only through joint_paths.
+    const std::string listFile =
+            "testMucoCosts_testMucoJointReactionNormCost_list.xml";
+    {
+        std::ofstream stream(listFile);
+        stream << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+                "<OpenSimDocument Version=\"40000\">\n"
+                "    <MucoJointReactionNormCost name=\"reaction\">\n"
+                "        <joint_paths>/jointset/j0</joint_paths>\n"
+                "    </MucoJointReactionNormCost>\n"
+                "</OpenSimDocument>\n";
+    }
+    std::unique_ptr<MucoJointReactionNormCost> listCost(
+            dynamic_cast<MucoJointReactionNormCost*>(
+                    Object::makeObjectFromFile(listFile)));
+    SimTK_TEST(listCost);
+    listCost->initialize(model);
+    SimTK_TEST_EQ_TOL(listCost->calcIntegralCost(state), reaction0, 1e-10);
+}
+
 int main() {
     SimTK_START_TEST("testMucoCosts");
         SimTK_SUBTEST(testMucoControlCost);
+        SimTK_SUBTEST(testMucoMarkerTrackingCost);
+        SimTK_SUBTEST(testMucoCostGradients);
+        SimTK_SUBTEST(testMultipleEndpointCosts);
+        SimTK_SUBTEST(testMucoJointReactionNormCost);
     SimTK_END_TEST();
 }
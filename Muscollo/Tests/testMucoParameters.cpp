@@ -131,7 +131,9 @@ Model createOscillatorTwoSpringsModel() {
 /// equivalent stiffness of a single spring that would produce the same 
 /// oscillation trajectory. This tests the ability for MucoParameter to optimize
 /// the value of a model property for two different components.
-void testOneParameterTwoSprings() {
+/// The stiffness is read whenever the spring force is computed, so the
+/// solver should give the same result without rebuilding the system.
+void testOneParameterTwoSprings(bool requiresInitSystem) {
     int N = 25;
 
     MucoTool muco;
@@ -146,6 +148,7 @@ void testOneParameterTwoSprings() {
     std::vector<std::string> components = {"spring1", "spring2"};
     MucoParameter stiffness("spring_stiffness", components, "stiffness", 
         MucoBounds(0, 100));
+    stiffness.setRequiresInitSystem(requiresInitSystem);
     mp.addParameter(stiffness);
 
     FinalPositionCost cost;
@@ -248,10 +251,49 @@ void testSeeSawCOM() {
     SimTK_TEST_EQ_TOL(sol_xCOM, xCOM, 0.003);
 }
 
+/// A parameter whose property is read whenever forces are computed changes
+/// the dynamics without rebuilding the system, but a parameter whose property
+/// is copied into the Simbody system (e.g., mass) only takes effect after
+/// rebuilding the system.
+void testRequiresInitSystem() {
+    Model model = createOscillatorTwoSpringsModel();
+    SimTK::State state = model.initSystem();
+    const double position = 0.1;
+    auto calcAcceleration = [&]() {
+        state.updQ()[0] = position;
+        model.realizeAcceleration(state);
+        return state.getUDot()[0];
+    };
+    SimTK_TEST_EQ(calcAcceleration(), -0.5 * STIFFNESS * position / MASS);
+
+    std::vector<std::string> components = {"spring1", "spring2"};
+    MucoParameter stiffness("spring_stiffness", components, "stiffness",
+            MucoBounds(0, 100));
+    // Conservative by default.
+    SimTK_TEST(stiffness.requiresInitSystem());
+    stiffness.setRequiresInitSystem(false);
+    stiffness.initialize(model);
+    stiffness.applyParameterToModel(STIFFNESS);
+    state.invalidateAll(SimTK::Stage::Instance);
+    SimTK_TEST_EQ(calcAcceleration(), -2 * STIFFNESS * position / MASS);
+
+    MucoParameter mass("mass", "body", "mass", MucoBounds(0, 10));
+    SimTK_TEST(mass.requiresInitSystem());
+    mass.initialize(model);
+    mass.applyParameterToModel(2 * MASS);
+    state.invalidateAll(SimTK::Stage::Instance);
+    // The system still has the old mass.
+    SimTK_TEST_EQ(calcAcceleration(), -2 * STIFFNESS * position / MASS);
+    state = model.initSystem();
+    SimTK_TEST_EQ(calcAcceleration(), -STIFFNESS * position / MASS);
+}
+
 int main() {
     SimTK_START_TEST("testMucoParameters");
         SimTK_SUBTEST(testOscillatorMass);
-        SimTK_SUBTEST(testOneParameterTwoSprings);
+        SimTK_SUBTEST1(testOneParameterTwoSprings, true);
+        SimTK_SUBTEST1(testOneParameterTwoSprings, false);
         SimTK_SUBTEST(testSeeSawCOM);
+        SimTK_SUBTEST(testRequiresInitSystem);
     SimTK_END_TEST();
 }
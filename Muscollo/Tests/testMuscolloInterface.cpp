@@ -154,6 +154,170 @@ void testSlidingMass() {
         double expectedForce = t < half ? 10 : -10;
         SimTK_TEST_EQ_TOL(controls(itime, 0), expectedForce, 1e-2);
     }
+
+    // The solver reports how often it evaluated each function.
+    const auto& stats = solution.getSolverStatistics();
+    SimTK_TEST(stats.at("num_objective_evals") > 0);
+    SimTK_TEST(stats.at("num_jacobian_evals") > 0);
+    SimTK_TEST(stats.at("sparsity_detection_time") >= 0);
+    // The sliding mass has no constraints or integral cost, so the DAE
+    // realizes to Acceleration, the integral cost is skipped, and the final
+    // time cost only requires the Time stage.
+    SimTK_TEST(stats.at("realize_dae_acceleration") > 0);
+    SimTK_TEST(stats.at("realize_integral_cost_time") == 0);
+    SimTK_TEST(stats.at("realize_integral_cost_position") == 0);
+    SimTK_TEST(stats.at("realize_endpoint_cost_position") == 0);
+    // Each mesh point keeps its own state, so perturbing only a control
+    // does not require realizing the Position stage again.
+    SimTK_TEST(stats.at("realize_dae_position") <
+            stats.at("realize_dae_acceleration"));
+
+    // Using the solution as a guess warm starts the solver.
+    SimTK_TEST(solution.hasDuals());
+    MucoTropterSolver& solver = muco.updSolver();
+    solver.setGuess(solution);
+    MucoSolution warm = muco.solve();
+    SimTK_TEST(warm.getNumIterations() < solution.getNumIterations());
+    SimTK_TEST(warm.isNumericallyEqual(solution, 1e-3));
+}
+
+/// Only the stages that depend on the changed state variables are
+/// invalidated, and the results match those from a fresh state.
+void testUpdateStateVariablesIfChanged() {
+    Model model = createPendulumModel();
+    SimTK::State state = model.initSystem();
+    state.updQ()[0] = 0.3;
+    state.updU()[0] = -1.2;
+    model.realizeAcceleration(state);
+
+    SimTK::Vector y = state.getY();
+    updateStateVariablesIfChanged(state, &y[0]);
+    SimTK_TEST(state.getSystemStage() == SimTK::Stage::Acceleration);
+
+    // Changing a speed keeps the Position stage.
+    y[1] = 0.7;
+    updateStateVariablesIfChanged(state, &y[0]);
+    SimTK_TEST(state.getSystemStage() == SimTK::Stage::Position);
+
+    // Changing a coordinate invalidates the Position stage.
+    model.realizeAcceleration(state);
+    y[0] = -0.4;
+    updateStateVariablesIfChanged(state, &y[0]);
+    SimTK_TEST(state.getSystemStage() < SimTK::Stage::Position);
+    model.realizeAcceleration(state);
+
+    SimTK::State fresh = model.initSystem();
+    fresh.updY() = y;
+    model.realizeAcceleration(fresh);
+    SimTK_TEST_EQ(state.getY(), fresh.getY());
+    SimTK_TEST_EQ(state.getUDot(), fresh.getUDot());
+}
+
+/// With implicit dynamics, the generalized accelerations are additional
+/// controls, and the solution should match that with explicit dynamics.
+void testImplicitDynamics() {
+    MucoTool muco = createSlidingMassMucoTool();
+    MucoTropterSolver& solver = muco.updSolver();
+    solver.set_optim_convergence_tolerance(1e-8);
+    solver.set_optim_constraint_tolerance(1e-8);
+    MucoSolution explicitSolution = muco.solve();
+    solver.set_dynamics_mode("implicit");
+    MucoSolution implicitSolution = muco.solve();
+    SimTK_TEST((implicitSolution.getControlNames() ==
+            std::vector<std::string>{"/actuator", "/slider/position/accel"}));
+    SimTK_TEST_EQ_TOL(implicitSolution.getTime()[0],
+            explicitSolution.getTime()[0], 1e-6);
+    const int last = explicitSolution.getTime().size() - 1;
+    SimTK_TEST_EQ_TOL(implicitSolution.getTime()[last],
+            explicitSolution.getTime()[last], 1e-6);
+    SimTK_TEST(implicitSolution.compareContinuousVariablesRMS(
+            explicitSolution, {}, {"/actuator"}) < 1e-5);
+
+    // The residual path constraints hold: the mass (10 kg) times the
+    // acceleration equals the actuator force.
+    const auto accel = implicitSolution.getControl("/slider/position/accel");
+    const auto force = implicitSolution.getControl("/actuator");
+    for (int itime = 0; itime < accel.size(); ++itime) {
+        SimTK_TEST_EQ_TOL(10 * accel[itime], force[itime], 1e-6);
+    }
+
+    // A guess from explicit dynamics lacks the acceleration controls; the
+    // solver computes them from the speeds.
+    solver.setGuess(explicitSolution);
+    MucoSolution implicitFromExplicit = muco.solve();
+    SimTK_TEST(implicitFromExplicit.compareContinuousVariablesRMS(
+            implicitSolution) < 1e-5);
+
+    // Guesses created with implicit dynamics contain the acceleration
+    // controls.
+    solver.setGuess("bounds");
+    SimTK_TEST(solver.getGuess().getControlNames() ==
+            implicitSolution.getControlNames());
+    MucoSolution implicitFromBounds = muco.solve();
+    SimTK_TEST(implicitFromBounds.compareContinuousVariablesRMS(
+            implicitSolution) < 1e-5);
+
+    // Changing the bound on the acceleration controls after a guess was
+    // created (and the problem was cached) takes effect.
+    solver.createGuess("random");
+    solver.set_implicit_acceleration_bound(0.5);
+    const auto randomAccel =
+            solver.createGuess("random").getControl("/slider/position/accel");
+    for (int itime = 0; itime < randomAccel.size(); ++itime) {
+        SimTK_TEST(std::abs(randomAccel[itime]) <= 0.5);
+    }
+    solver.clearGuess();
+    MucoSolution boundedSolution = muco.solve();
+    const auto boundedAccel =
+            boundedSolution.getControl("/slider/position/accel");
+    for (int itime = 0; itime < boundedAccel.size(); ++itime) {
+        SimTK_TEST(std::abs(boundedAccel[itime]) <= 0.5 + 1e-6);
+    }
+    solver.set_implicit_acceleration_bound(1000);
+
+    // Costs that require the Acceleration stage would use the accelerations
+    // from forward dynamics.
+    MucoJointReactionNormCost reactionCost;
+    reactionCost.setJointPath("/slider");
+    muco.updProblem().addCost(reactionCost);
+    SimTK_TEST_MUST_THROW_EXC(muco.solve(), Exception);
+}
+
+/// A cost that does not declare its stage dependency and uses the controls.
+class UndeclaredStageControlCost : public MucoCost {
+OpenSim_DECLARE_CONCRETE_OBJECT(UndeclaredStageControlCost, MucoCost);
+protected:
+    bool hasEndpointCostImpl() const override { return false; }
+    void calcIntegralCostImpl(const SimTK::State& state,
+            double& integrand) const override {
+        integrand = getModel().getControls(state).normSqr();
+    }
+};
+
+/// By default, the solver sets the controls before evaluating costs, so
+/// user-defined costs that do not declare their stage dependency get the
+/// controls for the current mesh point.
+void testDefaultCostStageDependency() {
+    SimTK_TEST(UndeclaredStageControlCost().getStageDependency() ==
+            SimTK::Stage::Velocity);
+
+    auto solve = [](const MucoCost& cost) {
+        MucoTool muco;
+        muco.setName("sliding_mass");
+        muco.set_write_solution("false");
+        MucoProblem& mp = muco.updProblem();
+        mp.setModel(createSlidingMassModel());
+        mp.setTimeBounds(0, 2);
+        mp.setStateInfo("/slider/position/value", {0, 1}, 0, 1);
+        mp.setStateInfo("/slider/position/speed", {-100, 100}, 0, 0);
+        mp.addCost(cost);
+        MucoTropterSolver& ms = muco.initSolver();
+        ms.set_num_mesh_points(20);
+        return muco.solve();
+    };
+    MucoSolution expected = solve(MucoControlCost());
+    MucoSolution actual = solve(UndeclaredStageControlCost());
+    SimTK_TEST(actual.compareContinuousVariablesRMS(expected) < 1e-5);
 }
 
 void testSolverOptions() {
@@ -471,6 +635,51 @@ void testStateTracking() {
         SimTK_TEST_MUST_THROW_EXC(muco.solve(), Exception);
     }
 
+    // The reference values precomputed at the mesh times match the splines,
+    // and the splines are used if the state's time is not a mesh time.
+    {
+        Model model = createSlidingMassModel();
+        SimTK::State state = model.initSystem();
+        MucoStateTrackingCost tracking;
+        tracking.setReferenceFile(fname);
+        tracking.initialize(model);
+        tracking.initializeOnMesh(createVectorLinspace(5, 0, 1));
+        state.updY()[0] = 0.3;
+        state.setTime(0.25);
+        const double costOnMesh = tracking.calcIntegralCost(state, 1);
+        SimTK_TEST_EQ(costOnMesh, tracking.calcIntegralCost(state));
+        SimTK_TEST_EQ_TOL(costOnMesh, pow(0.3 - 0.25, 2), 1e-6);
+        state.setTime(0.3);
+        SimTK_TEST_EQ_TOL(tracking.calcIntegralCost(state, 1), 0, 1e-6);
+    }
+
+    // The reference file is not loaded again if neither the model nor the
+    // properties have changed.
+    {
+        const std::string tmpfname =
+                "testMuscolloInterface_testStateTracking_tmp.sto";
+        STOFileAdapter::write(STOFileAdapter::read(fname), tmpfname);
+        Model model = createSlidingMassModel();
+        model.initSystem();
+        MucoProblem problem;
+        problem.setModel(createSlidingMassModel());
+        MucoStateTrackingCost tracking;
+        tracking.setReferenceFile(tmpfname);
+        problem.addCost(tracking);
+        problem.initialize(model);
+        std::remove(tmpfname.c_str());
+        problem.initialize(model);
+        // Editing the problem causes the file to be loaded again.
+        problem.setTimeBounds(0, 1);
+        SimTK_TEST_MUST_THROW_EXC(problem.initialize(model), Exception);
+        // So does explicitly clearing the initialization.
+        STOFileAdapter::write(STOFileAdapter::read(fname), tmpfname);
+        problem.initialize(model);
+        std::remove(tmpfname.c_str());
+        problem.clearInitialization();
+        SimTK_TEST_MUST_THROW_EXC(problem.initialize(model), Exception);
+    }
+
     // TODO error if data does not cover time window.
 
 }
@@ -823,6 +1032,34 @@ void testMucoIterate() {
 
         MucoIterate deserialized(fname);
         SimTK_TEST(deserialized.isNumericallyEqual(orig));
+        SimTK_TEST(!deserialized.hasDuals());
+    }
+
+    // Reading and writing the multipliers of the optimization problem.
+    {
+        const std::string fname =
+                "testMuscolloInterface_testMucoIterate_duals.sto";
+        SimTK::Vector time(3); time[0] = 0; time[1] = 0.1; time[2] = 0.25;
+        MucoIterate orig(time, {"a"}, {"g"}, {}, {},
+                SimTK::Test::randMatrix(3, 1), SimTK::Test::randMatrix(3, 1),
+                SimTK::Matrix(), SimTK::RowVector());
+        const SimTK::Vector lower = SimTK::Test::randVector(7);
+        const SimTK::Vector upper = SimTK::Test::randVector(7);
+        const SimTK::Vector constraint = SimTK::Test::randVector(4);
+        orig.setDuals(lower, upper, constraint);
+        SimTK_TEST_MUST_THROW_EXC(
+                orig.setDuals(lower, SimTK::Vector(6), constraint), Exception);
+        orig.write(fname);
+
+        MucoIterate deserialized(fname);
+        SimTK_TEST(deserialized.hasDuals());
+        SimTK_TEST_EQ(deserialized.getVariableLowerBoundDuals(), lower);
+        SimTK_TEST_EQ(deserialized.getVariableUpperBoundDuals(), upper);
+        SimTK_TEST_EQ(deserialized.getConstraintDuals(), constraint);
+
+        // The duals are specific to the number of times.
+        deserialized.setNumTimes(5);
+        SimTK_TEST(!deserialized.hasDuals());
     }
 
     // Test sealing/unsealing.
@@ -987,6 +1224,9 @@ void testInterpolate() {
 int main() {
     SimTK_START_TEST("testMuscolloInterface");
         SimTK_SUBTEST(testSlidingMass);
+        SimTK_SUBTEST(testUpdateStateVariablesIfChanged);
+        SimTK_SUBTEST(testImplicitDynamics);
+        SimTK_SUBTEST(testDefaultCostStageDependency);
         SimTK_SUBTEST(testSolverOptions);
         SimTK_SUBTEST(testStateTracking);
         SimTK_SUBTEST(testGuess);
@@ -0,0 +1,107 @@
+// ----------------------------------------------------------------------------
+// tropter: sandbox_constraint_ordering.cpp
+// ----------------------------------------------------------------------------
+// Copyright (c) 2017 tropter authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may
+// not use this file except in compliance with the License. You may obtain a
+// copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+// Compare the default constraint ordering (all defects, then all path
+// constraints) with the time-major ordering
+// (Trapezoidal::set_interleave_constraints()). IPOPT's timing statistics
+// report the time spent in the linear solver (LinearSystemFactorization,
+// etc.); the effect of the ordering on MUMPS's fill-in shows up there.
+
+#include <tropter/tropter.h>
+
+#include <chrono>
+
+using namespace tropter;
+
+/// A chain of masses connected by springs, in which the force on each mass
+/// is enforced through a path constraint (F = ma), as in implicit
+/// formulations of multibody dynamics.
+template<typename T>
+class SpringMassChain : public Problem<T> {
+public:
+    const double mass = 1.0;
+    const double stiffness = 10.0;
+    SpringMassChain(int num_masses) : m_num_masses(num_masses) {
+        this->set_time(0, 2);
+        for (int i = 0; i < num_masses; ++i) {
+            const auto istr = std::to_string(i);
+            this->add_state("x" + istr, {-5, 5}, 0, i == num_masses - 1 ? 1 : 0);
+            this->add_state("v" + istr, {-20, 20}, 0, 0);
+        }
+        for (int i = 0; i < num_masses; ++i) {
+            const auto istr = std::to_string(i);
+            this->add_control("a" + istr, {-100, 100});
+            this->add_control("F" + istr, {-50, 50});
+            this->add_path_constraint("F=ma_" + istr, 0);
+        }
+    }
+    void calc_differential_algebraic_equations(
+            const Input<T>& in, Output<T> out) const override {
+        const auto& x = in.states;
+        const auto& u = in.controls;
+        for (int i = 0; i < m_num_masses; ++i) {
+            out.dynamics[2 * i] = x[2 * i + 1];
+            out.dynamics[2 * i + 1] = u[2 * i];
+            T spring = 0;
+            if (i > 0) spring -= stiffness * (x[2 * i] - x[2 * (i - 1)]);
+            if (i < m_num_masses - 1)
+                spring += stiffness * (x[2 * (i + 1)] - x[2 * i]);
+            out.path[i] = u[2 * i + 1] + spring - mass * u[2 * i];
+        }
+    }
+    void calc_integral_cost(const Input<T>& in, T& integrand) const override {
+        integrand = 0;
+        for (int i = 0; i < m_num_masses; ++i) {
+            integrand += in.controls[2 * i + 1] * in.controls[2 * i + 1];
+        }
+    }
+private:
+    int m_num_masses;
+};
+
+void run(int num_masses, int num_mesh_points, bool interleave) {
+    auto ocp = std::make_shared<SpringMassChain<double>>(num_masses);
+    DirectCollocationSolver<double> dircol(ocp, "trapezoidal", "ipopt",
+            num_mesh_points);
+    dircol.set_interleave_constraints(interleave);
+    auto& optsolver = dircol.get_opt_solver();
+    optsolver.set_hessian_approximation("exact");
+    optsolver.set_advanced_option_string("linear_solver", "mumps");
+    optsolver.set_advanced_option_string("print_timing_statistics", "yes");
+
+    const auto start = std::chrono::steady_clock::now();
+    Solution solution = dircol.solve();
+    const auto end = std::chrono::steady_clock::now();
+    const double elapsed =
+            std::chrono::duration<double>(end - start).count();
+
+    std::cout << "[sandbox] masses: " << num_masses
+            << " mesh points: " << num_mesh_points
+            << " interleave: " << (interleave ? "yes" : "no")
+            << " success: " << solution.success
+            << " iterations: " << solution.num_iterations
+            << " objective: " << solution.objective
+            << " wall time (s): " << elapsed << std::endl;
+}
+
+int main() {
+    for (int num_mesh_points : {50, 100, 200}) {
+        for (bool interleave : {false, true}) {
+            run(5, num_mesh_points, interleave);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+// ----------------------------------------------------------------------------
+// tropter: sandbox_dae_evaluation.cpp
+// ----------------------------------------------------------------------------
+// Copyright (c) 2017 tropter authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may
+// not use this file except in compliance with the License. You may obtain a
+// copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+// Time the evaluation of the trapezoidal constraints and objective when the
+// problem implements the per-mesh-point DAE and integral cost (one virtual
+// call per mesh point) versus the batch functions
+// (Problem::calc_differential_algebraic_equations_batch() and
+// Problem::calc_integral_cost_batch()) versus StaticProblem (one virtual
+// call per evaluation, fixed-size temporaries). Build in Release.
+
+#include <tropter/tropter.h>
+
+#include <chrono>
+
+using namespace tropter;
+
+/// A sliding mass with an (inactive) path constraint on the power.
+template<typename T>
+class SlidingMass : public Problem<T> {
+public:
+    const double mass = 10.0;
+    SlidingMass() {
+        this->set_time({0}, {2});
+        this->add_state("x", {0, 2}, {0}, {1});
+        this->add_state("u", {-10, 10}, {0}, {0});
+        this->add_control("F", {-50, 50});
+        this->add_path_constraint("power", {-1000, 1000});
+    }
+    void calc_differential_algebraic_equations(
+            const Input<T>& in, Output<T> out) const override {
+        out.dynamics[0] = in.states[1];
+        out.dynamics[1] = in.controls[0] / mass;
+        out.path[0] = in.controls[0] * in.states[1];
+    }
+    void calc_integral_cost(const Input<T>& in, T& integrand) const override {
+        integrand = in.controls[0] * in.controls[0];
+    }
+};
+
+/// The same problem, evaluated for all mesh points at once.
+template<typename T>
+class SlidingMassBatch : public SlidingMass<T> {
+public:
+    void calc_differential_algebraic_equations_batch(
+            const InputBatch<T>& in, OutputBatch<T> out) const override {
+        out.dynamics.row(0) = in.states.row(1);
+        out.dynamics.row(1) = in.controls.row(0) / T(this->mass);
+        out.path.row(0) = in.controls.row(0).cwiseProduct(in.states.row(1));
+    }
+    void calc_integral_cost_batch(const InputBatch<T>& in,
+            Eigen::Ref<VectorX<T>> integrand) const override {
+        integrand = in.controls.row(0).cwiseAbs2().transpose();
+    }
+};
+
+/// The same problem, with the number of variables fixed at compile time.
+template<typename T>
+class SlidingMassStatic
+        : public StaticProblem<SlidingMassStatic<T>, T, 2, 1, 1> {
+public:
+    const double mass = 10.0;
+    SlidingMassStatic() {
+        this->set_time({0}, {2});
+        this->add_state("x", {0, 2}, {0}, {1});
+        this->add_state("u", {-10, 10}, {0}, {0});
+        this->add_control("F", {-50, 50});
+        this->add_path_constraint("power", {-1000, 1000});
+    }
+    void calc_differential_algebraic_equations_static(
+            const StaticInput<T, 2, 1>& in, Vector2<T>& dynamics,
+            Eigen::Matrix<T, 1, 1>& path) const {
+        dynamics[0] = in.states[1];
+        dynamics[1] = in.controls[0] / mass;
+        path[0] = in.controls[0] * in.states[1];
+    }
+    void calc_integral_cost_static(const StaticInput<T, 2, 1>& in,
+            T& integrand) const {
+        integrand = in.controls[0] * in.controls[0];
+    }
+};
+
+/// Report the average wall time of evaluating the constraints and the
+/// objective of the transcription of `ocp`.
+void run(const std::string& label, std::shared_ptr<Problem<double>> ocp,
+        int num_mesh_points, int num_evaluations) {
+    transcription::Trapezoidal<double> trap(ocp, num_mesh_points);
+    const Eigen::VectorXd x = trap.make_random_iterate_within_bounds();
+    Eigen::VectorXd constraints(trap.get_num_constraints());
+    double objective = 0;
+    double checksum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_evaluations; ++i) {
+        trap.calc_constraints(x, constraints);
+        trap.calc_objective(x, objective);
+        checksum += constraints.sum() + objective;
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double elapsed =
+            std::chrono::duration<double>(end - start).count();
+
+    std::cout << "[sandbox] " << label
+            << " mesh points: " << num_mesh_points
+            << " time per evaluation (us): "
+            << 1e6 * elapsed / num_evaluations
+            << " checksum: " << checksum << std::endl;
+}
+
+int main() {
+    for (int num_mesh_points : {100, 1000, 10000}) {
+        const int num_evaluations = 10000000 / num_mesh_points;
+        run("per mesh point", std::make_shared<SlidingMass<double>>(),
+                num_mesh_points, num_evaluations);
+        run("batch         ", std::make_shared<SlidingMassBatch<double>>(),
+                num_mesh_points, num_evaluations);
+        run("static        ", std::make_shared<SlidingMassStatic<double>>(),
+                num_mesh_points, num_evaluations);
+    }
+    return EXIT_SUCCESS;
+}
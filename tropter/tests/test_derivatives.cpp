@@ -873,4 +873,145 @@ TEST_CASE("ProblemDecorator sparsity_detection") {
     SparsityDetectionProblem<adouble>::run_test();
 }
 
+template<typename T>
+class PartlyLinearConstraints : public Problem<T> {
+public:
+    PartlyLinearConstraints() : Problem<T>(4, 4) {
+        this->set_variable_bounds(Vector4d(-2, -2, -2, -2),
+                Vector4d(2, 2, 2, 2));
+        this->set_constraint_bounds(Vector4d(0, 0, 0, 0),
+                Vector4d(0, 0, 0, 0));
+    }
+    void calc_objective(const VectorX<T>& x, T& obj_value) const override {
+        obj_value = x.squaredNorm();
+    }
+    void calc_constraints(
+            const VectorX<T>& x, Eigen::Ref<VectorX<T>> constr) const override {
+        constr[0] = 2 * x[0] + 3 * x[1];
+        constr[1] = x[1] * x[2] + 5 * x[3];
+        constr[2] = x[0] - x[3];
+        constr[3] = x[2] * x[2] - 4 * x[0];
+    }
+    static MatrixXd analytical_jacobian(const VectorXd& x) {
+        MatrixXd jacobian = MatrixXd::Zero(4, 4);
+        jacobian(0, 0) = 2;
+        jacobian(0, 1) = 3;
+        jacobian(1, 1) = x[2];
+        jacobian(1, 2) = x[1];
+        jacobian(1, 3) = 5;
+        jacobian(2, 0) = 1;
+        jacobian(2, 3) = -1;
+        jacobian(3, 0) = -4;
+        jacobian(3, 2) = 2 * x[2];
+        return jacobian;
+    }
+};
+
+class PartlyLinearConstraintsDeclared
+        : public PartlyLinearConstraints<double> {
+public:
+    bool calc_sparsity_constant_jacobian(const VectorXd&,
+            SparsityPattern& constant_sparsity) const override {
+        constant_sparsity.set_nonzero(0, 0);
+        constant_sparsity.set_nonzero(0, 1);
+        constant_sparsity.set_nonzero(1, 3);
+        constant_sparsity.set_nonzero(2, 0);
+        constant_sparsity.set_nonzero(2, 3);
+        constant_sparsity.set_nonzero(3, 0);
+        return true;
+    }
+};
+
+class LinearConstraints : public PartlyLinearConstraints<double> {
+public:
+    void calc_constraints(const VectorXd& x,
+            Eigen::Ref<VectorXd> constr) const override {
+        constr[0] = 2 * x[0] + 3 * x[1];
+        constr[1] = x[1] - 7 * x[2] + 5 * x[3];
+        constr[2] = x[0] - x[3];
+        constr[3] = -4 * x[0];
+    }
+};
+
+TEST_CASE("Constant Jacobian entries with finite differences") {
+    SparsityCoordinates jac_sparsity;
+    SparsityCoordinates hes_sparsity;
+
+    // The Jacobian is evaluated at iterates other than the one used for
+    // sparsity detection.
+    auto check_jacobian = [&](ProblemDecorator& decorator) {
+        const auto num_nonzeros = (unsigned)jac_sparsity.row.size();
+        REQUIRE(num_nonzeros == 9);
+        for (const auto& x : {Vector4d(0.3, -1.2, 1.7, 0.9),
+                              Vector4d(-1.1, 0.4, -0.6, 1.5)}) {
+            const MatrixXd expected =
+                    PartlyLinearConstraints<double>::analytical_jacobian(x);
+            VectorXd values(num_nonzeros);
+            decorator.calc_jacobian(4, x.data(), true, num_nonzeros,
+                    values.data());
+            for (int inz = 0; inz < (int)num_nonzeros; ++inz) {
+                const auto& i = jac_sparsity.row[inz];
+                const auto& j = jac_sparsity.col[inz];
+                INFO("(" << i << ", " << j << ")");
+                REQUIRE(values[inz] ==
+                        Approx(expected(i, j)).epsilon(1e-6));
+            }
+        }
+    };
+
+    SECTION("Detected") {
+        PartlyLinearConstraints<double> problem;
+        auto decorator = problem.make_decorator();
+        decorator->set_findiff_jacobian_constant_detection(true);
+        decorator->calc_sparsity(Vector4d(1, 1, 1, 1),
+                jac_sparsity, false, hes_sparsity);
+        REQUIRE(!decorator->get_jacobian_is_constant());
+        check_jacobian(*decorator);
+    }
+    SECTION("Declared by the problem") {
+        PartlyLinearConstraintsDeclared problem;
+        auto decorator = problem.make_decorator();
+        decorator->calc_sparsity(Vector4d(1, 1, 1, 1),
+                jac_sparsity, false, hes_sparsity);
+        REQUIRE(!decorator->get_jacobian_is_constant());
+        check_jacobian(*decorator);
+    }
+    SECTION("Not detected") {
+        PartlyLinearConstraints<double> problem;
+        auto decorator = problem.make_decorator();
+        decorator->calc_sparsity(Vector4d(1, 1, 1, 1),
+                jac_sparsity, false, hes_sparsity);
+        REQUIRE(!decorator->get_jacobian_is_constant());
+        check_jacobian(*decorator);
+    }
+    SECTION("All entries constant") {
+        LinearConstraints problem;
+        auto decorator = problem.make_decorator();
+        decorator->set_findiff_jacobian_constant_detection(true);
+        decorator->calc_sparsity(Vector4d(1, 1, 1, 1),
+                jac_sparsity, false, hes_sparsity);
+        REQUIRE(decorator->get_jacobian_is_constant());
+        const auto num_nonzeros = (unsigned)jac_sparsity.row.size();
+        REQUIRE(num_nonzeros == 8);
+        const Vector4d x(0.3, -1.2, 1.7, 0.9);
+        VectorXd values(num_nonzeros);
+        decorator->calc_jacobian(4, x.data(), true, num_nonzeros,
+                values.data());
+        MatrixXd expected = MatrixXd::Zero(4, 4);
+        expected(0, 0) = 2;
+        expected(0, 1) = 3;
+        expected(1, 1) = 1;
+        expected(1, 2) = -7;
+        expected(1, 3) = 5;
+        expected(2, 0) = 1;
+        expected(2, 3) = -1;
+        expected(3, 0) = -4;
+        for (int inz = 0; inz < (int)num_nonzeros; ++inz) {
+            const auto& i = jac_sparsity.row[inz];
+            const auto& j = jac_sparsity.col[inz];
+            REQUIRE(values[inz] == Approx(expected(i, j)).epsilon(1e-6));
+        }
+    }
+}
+
 // TODO add test_derivatives_optimal_control
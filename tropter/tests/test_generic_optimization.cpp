@@ -22,6 +22,9 @@
 
 #include "testing.h"
 
+#include <cstdio>
+#include <fstream>
+
 using Eigen::Vector4d;
 using Eigen::Vector2d;
 using Eigen::VectorXd;
@@ -157,6 +160,177 @@ TEST_CASE("IPOPT C++ tutorial problem HS071; has constraints.") {
     }
 }
 
+TEST_CASE("Automatic scaling") {
+    SECTION("Scale factors") {
+        HS071<adouble> problem;
+        const auto decorator = problem.make_decorator();
+        VectorXd guess = Vector4d(1.5, 2.5, 3.5, 4.5);
+        tropter::SparsityCoordinates jacobian_sparsity;
+        tropter::SparsityCoordinates hessian_sparsity;
+        decorator->calc_sparsity(guess, jacobian_sparsity, false,
+                hessian_sparsity);
+        double objective_scaling;
+        VectorXd variable_scaling;
+        VectorXd constraint_scaling;
+        decorator->calc_automatic_scaling(guess, jacobian_sparsity,
+                objective_scaling, variable_scaling, constraint_scaling);
+        // The width of the bounds on each variable is 4.
+        TROPTER_REQUIRE_EIGEN(variable_scaling, Vector4d::Constant(0.25),
+                1e-15);
+        // The largest derivatives (with respect to the scaled variables)
+        // are with respect to x[0]: 40.5 / 0.25, 39.375 / 0.25, 3 / 0.25.
+        REQUIRE(Approx(objective_scaling) == 1.0 / 162.0);
+        REQUIRE(Approx(constraint_scaling[0]) == 1.0 / 157.5);
+        REQUIRE(Approx(constraint_scaling[1]) == 1.0 / 36.0);
+    }
+    SECTION("Same solution") {
+        HS071<double> problem;
+        IPOPTSolver solver(problem);
+        solver.set_automatic_scaling(true);
+        VectorXd guess = Vector4d(1.5, 2.5, 3.5, 4.5);
+        auto solution = solver.optimize(guess);
+
+        REQUIRE(Approx(solution.variables[0]) == 1.0);
+        REQUIRE(Approx(solution.variables[1]) == 4.743);
+        REQUIRE(Approx(solution.variables[2]) == 3.82115);
+        REQUIRE(Approx(solution.variables[3]) == 1.379408);
+
+        REQUIRE(Approx(solution.objective) == 17.014);
+    }
+}
+
+TEST_CASE("Warm start from a previous solution") {
+    HS071<adouble> problem;
+    IPOPTSolver solver(problem);
+    VectorXd guess = Vector4d(1.5, 2.5, 3.5, 4.5);
+    const Solution cold = solver.optimize(guess);
+    REQUIRE(cold.success);
+    REQUIRE(cold.variable_lower_multipliers.size() == 4);
+    REQUIRE(cold.variable_upper_multipliers.size() == 4);
+    REQUIRE(cold.constraint_multipliers.size() == 2);
+    // x[0] is at its lower bound, so its lower bound multiplier is active.
+    REQUIRE(cold.variable_lower_multipliers[0] > 1e-3);
+
+    SECTION("Fewer iterations, same solution") {
+        const Solution warm = solver.optimize(cold);
+        REQUIRE(warm.success);
+        REQUIRE(warm.num_iterations < cold.num_iterations);
+        TROPTER_REQUIRE_EIGEN(warm.variables, cold.variables, 1e-6);
+        REQUIRE(Approx(warm.objective) == cold.objective);
+    }
+    SECTION("Multipliers must have the correct size") {
+        Solution bad = cold;
+        bad.constraint_multipliers.resize(3);
+        REQUIRE_THROWS_WITH(solver.optimize(bad),
+                Catch::Contains("Expected the constraint multipliers"));
+    }
+}
+
+TEST_CASE("Iteration callback and log file") {
+    HS071<adouble> problem;
+    IPOPTSolver solver(problem);
+    VectorXd guess = Vector4d(1.5, 2.5, 3.5, 4.5);
+    SECTION("Record every iteration") {
+        std::vector<IterationInfo> infos;
+        solver.set_iteration_callback([&infos](const IterationInfo& info) {
+            infos.push_back(info);
+            return true;
+        });
+        const std::string fname = "test_generic_optimization_iterations.csv";
+        solver.set_iteration_log_file(fname);
+        const auto solution = solver.optimize(guess);
+        REQUIRE(solution.success);
+        // IPOPT reports iteration 0 (the initial point).
+        REQUIRE((int)infos.size() == solution.num_iterations + 1);
+        for (int i = 0; i < (int)infos.size(); ++i) {
+            REQUIRE(infos[i].iteration == i);
+            REQUIRE(infos[i].objective_time >= 0);
+            REQUIRE(infos[i].hessian_time >= 0);
+            if (i) REQUIRE(infos[i].elapsed_time >= infos[i-1].elapsed_time);
+        }
+        REQUIRE(Approx(infos.back().objective) == solution.objective);
+
+        // Header plus one line per iteration.
+        std::ifstream f(fname);
+        int num_lines = 0;
+        std::string line;
+        while (std::getline(f, line)) ++num_lines;
+        REQUIRE(num_lines == (int)infos.size() + 1);
+        f.close();
+        std::remove(fname.c_str());
+    }
+    SECTION("JSON log file") {
+        const std::string fname = "test_generic_optimization_iterations.json";
+        solver.set_iteration_log_file(fname);
+        const auto solution = solver.optimize(guess);
+        REQUIRE(solution.success);
+        // An array with one object per line, including iteration 0.
+        std::ifstream f(fname);
+        std::string line;
+        std::getline(f, line);
+        REQUIRE(line == "[");
+        int num_objects = 0;
+        while (std::getline(f, line) && line != "]") {
+            REQUIRE(line.find(" {\"iteration\": ") == 0);
+            REQUIRE(line.find("nan") == std::string::npos);
+            ++num_objects;
+        }
+        REQUIRE(line == "]");
+        REQUIRE(num_objects == solution.num_iterations + 1);
+        f.close();
+        std::remove(fname.c_str());
+    }
+    SECTION("Stop early") {
+        solver.set_iteration_callback([](const IterationInfo& info) {
+            return info.iteration < 3;
+        });
+        const auto solution = solver.optimize(guess);
+        REQUIRE(!solution.success);
+        REQUIRE(solution.num_iterations == 3);
+        REQUIRE(solution.status == "User requested stop");
+    }
+}
+
+TEST_CASE("Evaluation statistics") {
+    VectorXd guess = Vector4d(1.5, 2.5, 3.5, 4.5);
+    auto check = [](const EvaluationStatistics& stats) {
+        REQUIRE(stats.num_objective_evals > 0);
+        REQUIRE(stats.num_gradient_evals > 0);
+        REQUIRE(stats.num_constraints_evals > 0);
+        REQUIRE(stats.num_jacobian_evals > 0);
+        REQUIRE(stats.num_hessian_evals > 0);
+        REQUIRE(stats.objective_time >= 0);
+        REQUIRE(stats.hessian_time >= 0);
+        REQUIRE(stats.sparsity_detection_time >= 0);
+        REQUIRE(stats.recovery_time <= stats.jacobian_time + stats.hessian_time);
+    };
+    SECTION("Finite differences") {
+        HS071<double> problem;
+        IPOPTSolver solver(problem);
+        solver.set_hessian_approximation("exact");
+        const auto solution = solver.optimize(guess);
+        REQUIRE(solution.success);
+        check(solution.statistics);
+        REQUIRE(solution.statistics.coloring_time >= 0);
+        // Each solve starts counting from zero.
+        const auto solution2 = solver.optimize(guess);
+        REQUIRE(solution2.statistics.num_objective_evals ==
+                solution.statistics.num_objective_evals);
+        REQUIRE(solution2.statistics.num_hessian_evals ==
+                solution.statistics.num_hessian_evals);
+    }
+    SECTION("ADOL-C") {
+        HS071<adouble> problem;
+        IPOPTSolver solver(problem);
+        solver.set_hessian_approximation("exact");
+        const auto solution = solver.optimize(guess);
+        REQUIRE(solution.success);
+        check(solution.statistics);
+        REQUIRE(solution.statistics.coloring_time == 0);
+        REQUIRE(solution.statistics.recovery_time == 0);
+    }
+}
+
 /// This problem has all 4 possible pairs of parameter bounds, and is
 /// used to ensure that
 /// OptimizationProblemProxy::initial_guess_from_bounds() computes
@@ -99,3 +99,38 @@ TEST_CASE("Sliding mass minimum time using path constraints", "[path]")
     TROPTER_REQUIRE_EIGEN(solution.states, expected.states, 0.001);
     TROPTER_REQUIRE_EIGEN(solution.controls, expected.controls, 0.001);
 }
+
+TEST_CASE("Interleaving defects and path constraints", "[path]")
+{
+    auto ocp = std::make_shared<SlidingMassPathConstraint<adouble>>();
+    const int N = 20;
+
+    SECTION("Constraint names") {
+        transcription::Trapezoidal<adouble> trap(ocp, 3);
+        const std::vector<std::string> defaults = {"x_1", "u_1", "x_2", "u_2",
+                "F=ma_0", "F=ma_1", "F=ma_2"};
+        REQUIRE(trap.get_constraint_names() == defaults);
+
+        trap.set_interleave_constraints(true);
+        const std::vector<std::string> interleaved = {"F=ma_0",
+                "x_1", "u_1", "F=ma_1",
+                "x_2", "u_2", "F=ma_2"};
+        REQUIRE(trap.get_constraint_names() == interleaved);
+    }
+
+    SECTION("Same solution") {
+        DirectCollocationSolver<adouble> dircol(ocp, "trapezoidal", "ipopt", N);
+        Solution solution = dircol.solve();
+
+        DirectCollocationSolver<adouble> dircol_interleaved(ocp,
+                "trapezoidal", "ipopt", N);
+        dircol_interleaved.set_interleave_constraints(true);
+        Solution solution_interleaved = dircol_interleaved.solve();
+        REQUIRE(solution_interleaved.success);
+
+        TROPTER_REQUIRE_EIGEN(solution_interleaved.states, solution.states,
+                1e-6);
+        TROPTER_REQUIRE_EIGEN(solution_interleaved.controls,
+                solution.controls, 1e-6);
+    }
+}
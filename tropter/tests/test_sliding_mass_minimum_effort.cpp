@@ -53,6 +53,155 @@ public:
     }
 };
 
+/// The same problem, but the gradient of the integrand is provided.
+template<typename T>
+class SlidingMassWithGradient : public SlidingMass<T> {
+public:
+    bool calc_integral_cost_gradient(const Input<T>& in,
+            Eigen::Ref<VectorX<T>>,
+            Eigen::Ref<VectorX<T>> controls_gradient,
+            Eigen::Ref<VectorX<T>>) const override {
+        controls_gradient[0] = 2 * in.controls[0];
+        return true;
+    }
+};
+
+/// The same problem, but the problem declares that the integrand depends only
+/// on the control.
+template<typename T>
+class SlidingMassWithDependencies : public SlidingMass<T> {
+public:
+    bool calc_cost_dependencies(std::vector<int>&,
+            std::vector<int>& integral_cost_controls,
+            std::vector<int>&, std::vector<int>&) const override {
+        integral_cost_controls = {0};
+        return true;
+    }
+};
+
+/// The same problem, with an (inactive) path constraint on the power.
+template<typename T>
+class SlidingMassWithPower : public SlidingMass<T> {
+public:
+    SlidingMassWithPower() {
+        this->add_path_constraint("power", {-1000, 1000});
+    }
+    void calc_differential_algebraic_equations(
+            const Input<T>& in, Output<T> out) const override {
+        SlidingMass<T>::calc_differential_algebraic_equations(in, out);
+        out.path[0] = in.controls[0] * in.states[1];
+    }
+};
+
+/// The same problem, but the derivatives of the DAE are provided.
+template<typename T>
+class SlidingMassWithJacobian : public SlidingMassWithPower<T> {
+public:
+    bool calc_differential_algebraic_equations_jacobian(
+            const Input<T>& in, OutputJacobian<T> out) const override {
+        out.dynamics_states(0, 1) = 1;
+        out.dynamics_controls(1, 0) = 1 / this->mass;
+        out.path_states(0, 1) = in.controls[0];
+        out.path_controls(0, 0) = in.states[1];
+        return true;
+    }
+};
+
+/// The same problem, but the DAE is evaluated for all mesh points at once.
+template<typename T>
+class SlidingMassBatch : public SlidingMassWithPower<T> {
+public:
+    void calc_differential_algebraic_equations_batch(
+            const InputBatch<T>& in, OutputBatch<T> out) const override {
+        out.dynamics.row(0) = in.states.row(1);
+        out.dynamics.row(1) = in.controls.row(0) / T(this->mass);
+        out.path.row(0) = in.controls.row(0).cwiseProduct(in.states.row(1));
+    }
+};
+
+/// The same problem, with the number of variables fixed at compile time.
+template<typename T>
+class SlidingMassStatic
+        : public StaticProblem<SlidingMassStatic<T>, T, 2, 1, 1> {
+public:
+    SlidingMassStatic() {
+        this->set_time({0}, {2});
+        this->add_state("x", {0, 2}, {0}, {1});
+        this->add_state("u", {-10, 10}, {0}, {0});
+        this->add_control("F", {-50, 50});
+        this->add_path_constraint("power", {-1000, 1000});
+    }
+    const double mass = 10.0;
+    void calc_differential_algebraic_equations_static(
+            const StaticInput<T, 2, 1>& in, Vector2<T>& dynamics,
+            Eigen::Matrix<T, 1, 1>& path) const {
+        dynamics[0] = in.states[1];
+        dynamics[1] = in.controls[0] / mass;
+        path[0] = in.controls[0] * in.states[1];
+    }
+    void calc_integral_cost_static(const StaticInput<T, 2, 1>& in,
+            T& integrand) const {
+        integrand = in.controls[0] * in.controls[0];
+    }
+};
+
+/// Compare two formulations of the problem with a free final time, in the
+/// trapezoidal transcription with default settings, with interleaved
+/// constraints, with a control mesh, and after removing fixed variables.
+/// `compare` takes the optimization problems for `ocp` and `ocp_other`.
+template <typename Compare>
+void compare_transcriptions(std::shared_ptr<Problem<double>> ocp,
+        std::shared_ptr<Problem<double>> ocp_other, Compare compare) {
+    const int N = 9;
+    ocp->set_time({0}, {1, 3});
+    ocp_other->set_time({0}, {1, 3});
+    transcription::Trapezoidal<double> trap(ocp, N);
+    transcription::Trapezoidal<double> trap_other(ocp_other, N);
+    compare(trap, trap_other);
+    trap.set_interleave_constraints(true);
+    trap_other.set_interleave_constraints(true);
+    compare(trap, trap_other);
+    trap.set_num_control_mesh_points(4);
+    trap_other.set_num_control_mesh_points(4);
+    compare(trap, trap_other);
+    optimization::PresolvedProblem<double> presolved(trap);
+    optimization::PresolvedProblem<double> presolved_other(trap_other);
+    compare(presolved, presolved_other);
+}
+
+/// The constraints and objective of the two problems are the same.
+void require_same_constraints_and_objective(
+        const optimization::Problem<double>& problem,
+        const optimization::Problem<double>& problem_other) {
+    const VectorXd x = problem.make_random_iterate_within_bounds();
+    VectorXd expected(problem.get_num_constraints());
+    VectorXd actual(problem_other.get_num_constraints());
+    problem.calc_constraints(x, expected);
+    problem_other.calc_constraints(x, actual);
+    TROPTER_REQUIRE_EIGEN(actual, expected, 1e-12);
+    double expected_obj;
+    double actual_obj;
+    problem.calc_objective(x, expected_obj);
+    problem_other.calc_objective(x, actual_obj);
+    REQUIRE(Approx(actual_obj) == expected_obj);
+}
+
+/// Solving OCP with ADOL-C gives the same solution as solving
+/// SlidingMassWithPower.
+template <template <typename> class OCP>
+void require_same_solution_as_with_power() {
+    auto ocp = std::make_shared<SlidingMassWithPower<adouble>>();
+    DirectCollocationSolver<adouble> dircol(ocp, "trapezoidal", "ipopt");
+    const Solution expected = dircol.solve();
+    auto ocp_other = std::make_shared<OCP<adouble>>();
+    DirectCollocationSolver<adouble> dircol_other(ocp_other, "trapezoidal",
+            "ipopt");
+    const Solution solution = dircol_other.solve();
+    REQUIRE(solution.success);
+    TROPTER_REQUIRE_EIGEN(solution.states, expected.states, 1e-8);
+    TROPTER_REQUIRE_EIGEN(solution.controls, expected.controls, 1e-8);
+}
+
 TEST_CASE("IPOPT") {
 
     SECTION("ADOL-C") {
@@ -121,6 +270,299 @@ TEST_CASE("IPOPT") {
     }
 }
 
+TEST_CASE("Gradient of the integral cost provided by the problem") {
+    SECTION("Compare derivatives") {
+        OCPDerivativesComparison<SlidingMassWithGradient> comp;
+        comp.findiff_hessian_step_size = 1e-3;
+        comp.gradient_error_tolerance = 1e-5;
+        comp.hessian_error_tolerance = 1e-3;
+        comp.compare();
+    }
+    SECTION("Control mesh") {
+        const int N = 9;
+        const int M = 4;
+        auto ocp = std::make_shared<SlidingMass<double>>();
+        transcription::Trapezoidal<double> trap(ocp, N);
+        trap.set_num_control_mesh_points(M);
+        auto ocp_grad = std::make_shared<SlidingMassWithGradient<double>>();
+        transcription::Trapezoidal<double> trap_grad(ocp_grad, N);
+        trap_grad.set_num_control_mesh_points(M);
+
+        const VectorXd x = trap.make_decorator()
+                ->make_random_iterate_within_bounds();
+        VectorXd expected = VectorXd::Zero(x.size());
+        VectorXd actual = VectorXd::Zero(x.size());
+        REQUIRE(!trap.calc_gradient(x, expected));
+        REQUIRE(trap_grad.calc_gradient(x, actual));
+
+        // Finite differences of the objective.
+        const double eps = 1e-6;
+        VectorXd x_working = x;
+        for (int i = 0; i < x.size(); ++i) {
+            double obj_pos, obj_neg;
+            x_working[i] = x[i] + eps;
+            trap.calc_objective(x_working, obj_pos);
+            x_working[i] = x[i] - eps;
+            trap.calc_objective(x_working, obj_neg);
+            x_working[i] = x[i];
+            expected[i] = (obj_pos - obj_neg) / (2 * eps);
+        }
+        TROPTER_REQUIRE_EIGEN_ABS(actual, expected, 1e-4);
+    }
+}
+
+TEST_CASE("Cost dependencies provided by the problem") {
+    const int N = 9;
+    auto ocp = std::make_shared<SlidingMass<double>>();
+    auto ocp_dep = std::make_shared<SlidingMassWithDependencies<double>>();
+    // The sparsity matches that detected by perturbing the objective.
+    auto require_sparsity_matches_perturbation =
+            [](const optimization::Problem<double>& problem) {
+        const VectorXd x = problem.make_decorator()
+                ->make_random_iterate_within_bounds();
+        std::vector<unsigned int> actual;
+        REQUIRE(problem.calc_sparsity_gradient(x, actual));
+        std::function<double(const VectorXd&)> calc_objective =
+                [&problem](const VectorXd& vars) {
+                    double obj_value = 0;
+                    problem.calc_objective(vars, obj_value);
+                    return obj_value;
+                };
+        const auto expected = calc_gradient_sparsity_with_perturbation(x,
+                calc_objective).convert_to_CompressedRowSparsity()[0];
+        REQUIRE(actual == expected);
+    };
+    {
+        transcription::Trapezoidal<double> trap(ocp, N);
+        std::vector<unsigned int> indices;
+        REQUIRE(!trap.calc_sparsity_gradient(
+                trap.make_initial_guess_from_bounds(), indices));
+    }
+    {
+        transcription::Trapezoidal<double> trap(ocp_dep, N);
+        require_sparsity_matches_perturbation(trap);
+        trap.set_num_control_mesh_points(4);
+        require_sparsity_matches_perturbation(trap);
+        optimization::PresolvedProblem<double> presolved(trap);
+        require_sparsity_matches_perturbation(presolved);
+    }
+    {
+        DirectCollocationSolver<double> dircol(ocp, "trapezoidal", "ipopt",
+                N);
+        const Solution expected = dircol.solve();
+        DirectCollocationSolver<double> dircol_dep(ocp_dep, "trapezoidal",
+                "ipopt", N);
+        const Solution solution = dircol_dep.solve();
+        REQUIRE(solution.success);
+        TROPTER_REQUIRE_EIGEN(solution.states, expected.states, 1e-5);
+        TROPTER_REQUIRE_EIGEN(solution.controls, expected.controls, 1e-4);
+    }
+}
+
+TEST_CASE("Jacobian of the DAE provided by the problem") {
+    SECTION("Compare derivatives") {
+        OCPDerivativesComparison<SlidingMassWithJacobian> comp;
+        comp.findiff_hessian_step_size = 1e-3;
+        comp.gradient_error_tolerance = 1e-5;
+        comp.hessian_error_tolerance = 1e-3;
+        comp.compare();
+    }
+    SECTION("Free final time, control mesh, and presolve") {
+        // The Jacobian assembled from the DAE derivatives matches the
+        // Jacobian from finite differences of the constraints.
+        compare_transcriptions(
+                std::make_shared<SlidingMassWithPower<double>>(),
+                std::make_shared<SlidingMassWithJacobian<double>>(),
+                [](const optimization::Problem<double>& problem,
+                        const optimization::Problem<double>& problem_jac) {
+            std::vector<Eigen::Triplet<double>> triplets;
+            const VectorXd x = problem.make_random_iterate_within_bounds();
+            REQUIRE(!problem.calc_jacobian(x, triplets));
+            auto decorator = problem.make_decorator();
+            auto decorator_jac = problem_jac.make_decorator();
+            SparsityCoordinates sparsity;
+            SparsityCoordinates sparsity_jac;
+            SparsityCoordinates hes_sparsity;
+            decorator->calc_sparsity(x, sparsity, false, hes_sparsity);
+            decorator_jac->calc_sparsity(x, sparsity_jac, false, hes_sparsity);
+            REQUIRE(sparsity_jac.row == sparsity.row);
+            REQUIRE(sparsity_jac.col == sparsity.col);
+            const auto num_nonzeros = (unsigned)sparsity.row.size();
+            VectorXd expected(num_nonzeros);
+            VectorXd actual(num_nonzeros);
+            decorator->calc_jacobian((unsigned)x.size(), x.data(), true,
+                    num_nonzeros, expected.data());
+            decorator_jac->calc_jacobian((unsigned)x.size(), x.data(), true,
+                    num_nonzeros, actual.data());
+            TROPTER_REQUIRE_EIGEN_ABS(actual, expected, 1e-6);
+        });
+    }
+    SECTION("Solve, exact Hessian") {
+        const int N = 10;
+        auto ocp = std::make_shared<SlidingMassWithPower<double>>();
+        DirectCollocationSolver<double> dircol(ocp, "trapezoidal", "ipopt",
+                N);
+        dircol.get_opt_solver().set_findiff_hessian_step_size(1e-3);
+        dircol.get_opt_solver().set_hessian_approximation("exact");
+        const Solution expected = dircol.solve();
+        auto ocp_jac = std::make_shared<SlidingMassWithJacobian<double>>();
+        DirectCollocationSolver<double> dircol_jac(ocp_jac, "trapezoidal",
+                "ipopt", N);
+        dircol_jac.get_opt_solver().set_findiff_hessian_step_size(1e-3);
+        dircol_jac.get_opt_solver().set_hessian_approximation("exact");
+        const Solution solution = dircol_jac.solve();
+        REQUIRE(solution.success);
+        TROPTER_REQUIRE_EIGEN(solution.states, expected.states, 1e-5);
+        TROPTER_REQUIRE_EIGEN(solution.controls, expected.controls, 1e-4);
+    }
+}
+
+TEST_CASE("DAE evaluated for all mesh points at once") {
+    SECTION("Constraints and objective") {
+        compare_transcriptions(
+                std::make_shared<SlidingMassWithPower<double>>(),
+                std::make_shared<SlidingMassBatch<double>>(),
+                require_same_constraints_and_objective);
+    }
+    SECTION("Solve with ADOL-C") {
+        require_same_solution_as_with_power<SlidingMassBatch>();
+    }
+}
+
+TEST_CASE("Number of variables fixed at compile time") {
+    SECTION("Constraints and objective") {
+        compare_transcriptions(
+                std::make_shared<SlidingMassWithPower<double>>(),
+                std::make_shared<SlidingMassStatic<double>>(),
+                require_same_constraints_and_objective);
+    }
+    SECTION("Solve with ADOL-C") {
+        require_same_solution_as_with_power<SlidingMassStatic>();
+    }
+}
+
+TEST_CASE("Fixed initial and final time are not variables") {
+    auto ocp = std::make_shared<SlidingMass<double>>();
+    const int N = 5;
+    transcription::Trapezoidal<double> trap(ocp, N);
+    // 2 states and 1 control at each mesh point; no time variables.
+    REQUIRE(trap.get_num_variables() == 3 * N);
+    const auto names = trap.get_variable_names();
+    REQUIRE(names.front() == "x_0");
+    REQUIRE(std::find(names.begin(), names.end(), "initial_time") ==
+            names.end());
+    REQUIRE(std::find(names.begin(), names.end(), "final_time") ==
+            names.end());
+
+    // The fixed times are still used for the time vector of the iterate.
+    const VectorXd x = VectorXd::Random(trap.get_num_variables());
+    const Iterate iterate = trap.deconstruct_iterate(x);
+    REQUIRE(iterate.time[0] == 0);
+    REQUIRE(iterate.time[N - 1] == 2);
+    const VectorXd x_roundtrip = trap.construct_iterate(iterate);
+    TROPTER_REQUIRE_EIGEN_ABS(x_roundtrip, x, 1e-15);
+}
+
+TEST_CASE("Remove fixed variables") {
+    auto ocp = std::make_shared<SlidingMass<double>>();
+    const int N = 10;
+    {
+        transcription::Trapezoidal<double> trap(ocp, N);
+        optimization::PresolvedProblem<double> presolved(trap);
+        // The initial and final values of both states are fixed.
+        REQUIRE(presolved.get_num_fixed_variables() == 4);
+        REQUIRE(presolved.get_num_variables() ==
+                trap.get_num_variables() - 4);
+        REQUIRE(presolved.get_num_constraints() ==
+                trap.get_num_constraints());
+        const auto names = presolved.get_variable_names();
+        REQUIRE(std::find(names.begin(), names.end(), "x_0") == names.end());
+        REQUIRE(names.front() == "F_0");
+
+        // The fixed variables take the value of their bounds.
+        const VectorXd x = presolved.make_decorator()
+                ->make_random_iterate_within_bounds();
+        const VectorXd x_expanded = presolved.expand_variables(x);
+        REQUIRE(x_expanded.size() == trap.get_num_variables());
+        const auto& lower = trap.get_variable_lower_bounds();
+        const auto& upper = trap.get_variable_upper_bounds();
+        for (int i = 0; i < x_expanded.size(); ++i) {
+            if (lower[i] == upper[i]) REQUIRE(x_expanded[i] == lower[i]);
+        }
+        TROPTER_REQUIRE_EIGEN_ABS(presolved.reduce_variables(x_expanded), x,
+                1e-15);
+
+        // The objective and constraints are unchanged.
+        double obj_original, obj_presolved;
+        trap.calc_objective(x_expanded, obj_original);
+        presolved.calc_objective(x, obj_presolved);
+        REQUIRE(obj_original == obj_presolved);
+        VectorXd constr_original(trap.get_num_constraints());
+        VectorXd constr_presolved(trap.get_num_constraints());
+        trap.calc_constraints(x_expanded, constr_original);
+        presolved.calc_constraints(x, constr_presolved);
+        TROPTER_REQUIRE_EIGEN_ABS(constr_presolved, constr_original, 1e-15);
+    }
+    {
+        DirectCollocationSolver<double> dircol(ocp, "trapezoidal", "ipopt",
+                N);
+        const Solution expected = dircol.solve();
+        dircol.set_remove_fixed_variables(true);
+        const Solution solution = dircol.solve();
+        REQUIRE(solution.success);
+        REQUIRE(Approx(solution.states(0, 0)) == 0.0);
+        REQUIRE(Approx(solution.states.rightCols<1>()[0]) == 1.0);
+        TROPTER_REQUIRE_EIGEN(solution.states, expected.states, 1e-5);
+        TROPTER_REQUIRE_EIGEN(solution.controls, expected.controls, 1e-4);
+    }
+}
+
+TEST_CASE("Control mesh") {
+    auto ocp = std::make_shared<SlidingMass<double>>();
+    const int N = 21;
+    const int M = 6;
+    {
+        transcription::Trapezoidal<double> trap(ocp, N);
+        trap.set_num_control_mesh_points(M);
+        // 2 states at each mesh point; 1 control at each control mesh point.
+        REQUIRE(trap.get_num_variables() == 2 * N + M);
+        const auto names = trap.get_variable_names();
+        REQUIRE(names[2 * N] == "F_00");
+        REQUIRE(names.back() == "F_05");
+
+        // The controls are linearly interpolated between control mesh points.
+        VectorXd x = VectorXd::Random(trap.get_num_variables());
+        x.tail(M) = VectorXd::LinSpaced(M, 0, 5);
+        const Iterate iterate = trap.deconstruct_iterate(x);
+        REQUIRE(iterate.controls.cols() == N);
+        TROPTER_REQUIRE_EIGEN(iterate.controls,
+                RowVectorXd::LinSpaced(N, 0, 5), 1e-12);
+        // Control mesh points coincide with every 4th mesh point.
+        const VectorXd x_roundtrip = trap.construct_iterate(iterate);
+        TROPTER_REQUIRE_EIGEN_ABS(x_roundtrip, x, 1e-12);
+
+        // Setting M = N is the same as not using a control mesh.
+        trap.set_num_control_mesh_points(N);
+        REQUIRE(trap.get_num_variables() == 3 * N);
+    }
+    {
+        DirectCollocationSolver<double> dircol(ocp, "trapezoidal", "ipopt",
+                N);
+        dircol.set_num_control_mesh_points(M);
+        const Solution solution = dircol.solve();
+        REQUIRE(solution.success);
+        REQUIRE(Approx(solution.states(0, 0)) == 0.0);
+        REQUIRE(Approx(solution.states.rightCols<1>()[0]) == 1.0);
+        REQUIRE(Approx(solution.states(1, 0)) == 0.0);
+        REQUIRE(Approx(solution.states.rightCols<1>()[1]) == 0.0);
+        // The optimal control is linear, so the control mesh can represent
+        // it.
+        RowVectorXd expected = RowVectorXd::LinSpaced(N - 2, 14.6119, -14.6119);
+        TROPTER_REQUIRE_EIGEN(solution.controls.middleCols(1, N - 2), expected,
+                0.1);
+    }
+}
+
 #if defined(TROPTER_WITH_SNOPT)
 TEST_CASE("SNOPT") {
 
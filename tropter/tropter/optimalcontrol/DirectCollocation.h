@@ -26,6 +26,8 @@ namespace tropter {
 
 namespace optimization {
 class Solver;
+template<typename T>
+class PresolvedProblem;
 } // namespace optimization
 
 namespace transcription {
@@ -43,6 +45,7 @@ public:
                             const std::string& optimization_solver,
                             // TODO remove; put somewhere better.
                             const unsigned& num_mesh_points = 20);
+    ~DirectCollocationSolver();
     Iterate make_initial_guess_from_bounds() const {
         // We only need this decorator to form an initial guess from the bounds.
         auto decorator = m_transcription->make_decorator();
@@ -69,6 +72,28 @@ public:
     const transcription::Base<T>& get_transcription() const
     {   return *m_transcription.get(); }
 
+    /// Order the constraints by mesh point (time-major) rather than placing
+    /// all defects before all path constraints. This gives the constraint
+    /// Jacobian a block-banded structure. See
+    /// transcription::Trapezoidal::set_interleave_constraints().
+    void set_interleave_constraints(bool value);
+
+    /// Represent the controls on a coarser control mesh with `M` points.
+    /// See transcription::Trapezoidal::set_num_control_mesh_points().
+    void set_num_control_mesh_points(unsigned M);
+
+    /// Remove variables whose lower and upper bounds are equal (e.g., an
+    /// initial state bounded to a single value) from the problem given to
+    /// the optimization solver. This reduces the size of the derivatives
+    /// and the number of finite difference perturbations. The solution
+    /// contains the fixed variables. Default: false.
+    /// See optimization::PresolvedProblem.
+    void set_remove_fixed_variables(bool value)
+    {   m_remove_fixed_variables = value; }
+    /// @copydoc set_remove_fixed_variables()
+    bool get_remove_fixed_variables() const
+    {   return m_remove_fixed_variables; }
+
     /// 0 for silent, 1 for verbose. This setting is copied into the
     /// underlying solver.
     void set_verbosity(int verbosity);
@@ -97,6 +122,12 @@ public:
     /// The guess will be linearly interpolated to have the requested number of
     /// mesh points.
     ///
+    /// If the guess contains multipliers (e.g., it is a Solution from a
+    /// previous solve of a problem with the same structure), the multipliers
+    /// are used to warm start the optimization solver, as long as the guess
+    /// has the requested number of mesh points and the sizes of the
+    /// multipliers match. See Iterate::constraint_multipliers.
+    ///
     /// Providing an empty initial_guess (see OptimalControlIterate::empty())
     /// is the same as calling the no-argument solve() above.
     /// TODO right now, initial_guess.time MUST have equally-spaced intervals.
@@ -113,11 +144,16 @@ public:
                                  std::ostream& stream = std::cout) const;
 private:
     std::shared_ptr<const OCProblem> m_ocproblem;
+    unsigned m_num_mesh_points;
     // TODO perhaps ideally DirectCollocationSolver would not be templated?
     std::unique_ptr<transcription::Base<T>> m_transcription;
+    // The optimization solver operates on this presolved problem, which
+    // wraps m_transcription.
+    std::unique_ptr<optimization::PresolvedProblem<T>> m_presolved;
     std::unique_ptr<optimization::Solver> m_optsolver;
 
     int m_verbosity = 1;
+    bool m_remove_fixed_variables = false;
 };
 
 } // namespace tropter
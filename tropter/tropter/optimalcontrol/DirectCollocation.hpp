@@ -20,6 +20,7 @@
 #include "transcription/Trapezoidal.h"
 #include <tropter/optimization/SNOPTSolver.h>
 #include <tropter/optimization/IPOPTSolver.h>
+#include <tropter/optimization/PresolvedProblem.h>
 
 #include <tropter/Exception.hpp>
 
@@ -31,7 +32,7 @@ DirectCollocationSolver<T>::DirectCollocationSolver(
         const std::string& transcrip,
         const std::string& optsolver,
         const unsigned& num_mesh_points)
-        : m_ocproblem(ocproblem)
+        : m_ocproblem(ocproblem), m_num_mesh_points(num_mesh_points)
 {
     std::string transcrip_lower = transcrip;
     std::transform(transcrip_lower.begin(), transcrip_lower.end(),
@@ -47,17 +48,24 @@ DirectCollocationSolver<T>::DirectCollocationSolver(
     std::transform(optsolver_lower.begin(), optsolver_lower.end(),
             optsolver_lower.begin(), ::tolower);
     using namespace optimization;
+    // Variables are not removed until solve(), since the bounds may change
+    // until then.
+    m_presolved.reset(new PresolvedProblem<T>(*m_transcription.get(),
+            false));
     if (optsolver_lower == "ipopt") {
         // TODO this may not be good for IPOPTSolver; IPOPTSolver should
         // have a shared_ptr??
-        m_optsolver.reset(new IPOPTSolver(*m_transcription.get()));
+        m_optsolver.reset(new IPOPTSolver(*m_presolved.get()));
     } else if (optsolver_lower == "snopt") {
-        m_optsolver.reset(new SNOPTSolver(*m_transcription.get()));
+        m_optsolver.reset(new SNOPTSolver(*m_presolved.get()));
     } else {
         TROPTER_THROW("Unrecognized optimization solver %s.", optsolver);
     }
 }
 
+template<typename T>
+DirectCollocationSolver<T>::~DirectCollocationSolver() = default;
+
 template<typename T>
 void DirectCollocationSolver<T>::set_verbosity(int verbosity) {
     TROPTER_VALUECHECK(verbosity == 0 || verbosity == 1,
@@ -66,6 +74,24 @@ void DirectCollocationSolver<T>::set_verbosity(int verbosity) {
     m_verbosity = verbosity;
 }
 
+template<typename T>
+void DirectCollocationSolver<T>::set_interleave_constraints(bool value) {
+    auto* trapezoidal = dynamic_cast<transcription::Trapezoidal<T>*>(
+            m_transcription.get());
+    TROPTER_THROW_IF(!trapezoidal, "Interleaving constraints is only "
+            "supported with the trapezoidal transcription method.");
+    trapezoidal->set_interleave_constraints(value);
+}
+
+template<typename T>
+void DirectCollocationSolver<T>::set_num_control_mesh_points(unsigned M) {
+    auto* trapezoidal = dynamic_cast<transcription::Trapezoidal<T>*>(
+            m_transcription.get());
+    TROPTER_THROW_IF(!trapezoidal, "A control mesh is only supported with "
+            "the trapezoidal transcription method.");
+    trapezoidal->set_num_control_mesh_points(M);
+}
+
 template<typename T>
 Solution DirectCollocationSolver<T>::solve() const
 {
@@ -76,16 +102,47 @@ Solution DirectCollocationSolver<T>::solve() const
 template<typename T>
 Solution DirectCollocationSolver<T>::solve(
         const Iterate& initial_guess) const {
+    m_presolved->update(m_remove_fixed_variables);
+    if (m_verbosity && m_presolved->get_num_fixed_variables()) {
+        std::cout << "[tropter] Removed "
+                << m_presolved->get_num_fixed_variables()
+                << " fixed variables from the optimization problem."
+                << std::endl;
+    }
     optimization::Solution optsol;
     if (initial_guess.empty()) {
         optsol = m_optsolver->optimize();
     } else {
         Eigen::VectorXd variables =
                 m_transcription->construct_iterate(initial_guess, true);
-        optsol = m_optsolver->optimize(variables);
+        optimization::Solution guess;
+        guess.variables = m_presolved->reduce_variables(variables);
+        // The multipliers are only meaningful if the guess was not
+        // interpolated and came from a problem with the same structure.
+        const auto num_variables = m_transcription->get_num_variables();
+        const auto num_constraints = m_transcription->get_num_constraints();
+        if (initial_guess.time.size() == (int)m_num_mesh_points &&
+                initial_guess.variable_lower_multipliers.size() ==
+                        num_variables &&
+                initial_guess.variable_upper_multipliers.size() ==
+                        num_variables &&
+                initial_guess.constraint_multipliers.size() ==
+                        num_constraints) {
+            guess.variable_lower_multipliers = m_presolved->reduce_variables(
+                    initial_guess.variable_lower_multipliers);
+            guess.variable_upper_multipliers = m_presolved->reduce_variables(
+                    initial_guess.variable_upper_multipliers);
+            guess.constraint_multipliers =
+                    initial_guess.constraint_multipliers;
+            if (m_verbosity) {
+                std::cout << "[tropter] Using the multipliers in the guess "
+                        "to warm start the optimization." << std::endl;
+            }
+        }
+        optsol = m_optsolver->optimize(guess);
     }
-    Iterate traj =
-            m_transcription->deconstruct_iterate(optsol.variables);
+    Iterate traj = m_transcription->deconstruct_iterate(
+            m_presolved->expand_variables(optsol.variables));
     Solution solution;
     solution.time = traj.time;
     solution.states = traj.states;
@@ -100,6 +157,16 @@ Solution DirectCollocationSolver<T>::solve(
     solution.success = optsol.success;
     solution.status = optsol.status;
     solution.num_iterations = optsol.num_iterations;
+    solution.statistics = optsol.statistics;
+    if (optsol.has_multipliers()) {
+        solution.variable_lower_multipliers =
+                m_presolved->expand_bound_multipliers(
+                        optsol.variable_lower_multipliers);
+        solution.variable_upper_multipliers =
+                m_presolved->expand_bound_multipliers(
+                        optsol.variable_upper_multipliers);
+        solution.constraint_multipliers = optsol.constraint_multipliers;
+    }
     if (!solution && m_verbosity) {
         std::cerr << "[tropter] DirectCollocationSolver did not succeed:\n"
                 << solution.status << std::endl;
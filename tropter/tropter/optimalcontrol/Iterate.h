@@ -16,6 +16,8 @@
 // limitations under the License.
 // ----------------------------------------------------------------------------
 
+#include <tropter/optimization/ProblemDecorator.h>
+
 #include <Eigen/Dense>
 
 #include <string>
@@ -51,6 +53,19 @@ struct Iterate {
     std::vector<std::string> control_names;
     std::vector<std::string> adjunct_names;
     std::vector<std::string> parameter_names;
+    /// @name Multipliers of the optimization problem (optional)
+    /// Multipliers (dual variables) for the variable bounds and constraints
+    /// of the optimization problem that produced this iterate, in the order
+    /// used by the transcription. If these are not empty, solvers use them
+    /// to warm start the optimization, but only if the iterate need not be
+    /// interpolated and the sizes match the optimization problem (that is,
+    /// the same transcription settings were used). These are not written by
+    /// write() and are discarded by interpolate().
+    /// @{
+    Eigen::VectorXd variable_lower_multipliers;
+    Eigen::VectorXd variable_upper_multipliers;
+    Eigen::VectorXd constraint_multipliers;
+    /// @}
     /// This constructor leaves all members empty.
     Iterate() = default;
     /// True if the size of all members is 0; false otherwise.
@@ -87,6 +102,9 @@ struct Solution : public Iterate {
     std::string status;
     /// Number of solver iterations at which this solution was obtained.
     int num_iterations = -1;
+    /// Number of calls to, and time spent in, each function of the
+    /// optimization problem (see optimization::Solution::statistics).
+    optimization::EvaluationStatistics statistics;
 };
 
 } // namespace tropter
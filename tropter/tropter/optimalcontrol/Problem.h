@@ -105,6 +105,59 @@ struct Output {
     Eigen::Ref<VectorX<T>> path;
 };
 
+/// This struct holds inputs to
+/// OptimalControlProblem::calc_differential_algebraic_equations_batch():
+/// the variables at all mesh points. Column i of each trajectory holds the
+/// values at mesh point i (the same values as the corresponding members of
+/// Input for mesh_index i).
+/// @ingroup optimalcontrol
+template<typename T>
+struct InputBatch {
+    /// The time at each mesh point.
+    const Eigen::Ref<const RowVectorX<T>>& times;
+    /// The states trajectory (num_states x num_mesh_points).
+    const Eigen::Ref<const MatrixX<T>, 0, Eigen::OuterStride<>>& states;
+    /// The controls trajectory (num_controls x num_mesh_points).
+    const Eigen::Ref<const MatrixX<T>, 0, Eigen::OuterStride<>>& controls;
+    /// The adjuncts trajectory (num_adjuncts x num_mesh_points).
+    const Eigen::Ref<const MatrixX<T>, 0, Eigen::OuterStride<>>& adjuncts;
+    /// The vector of time-invariant parameter values.
+    const Eigen::Ref<const VectorX<T>>& parameters;
+};
+/// This struct holds the outputs of
+/// OptimalControlProblem::calc_differential_algebraic_equations_batch().
+/// Column i of each matrix holds the corresponding member of Output for
+/// mesh_index i. As with Output, do not copy these references.
+/// @ingroup optimalcontrol
+template<typename T>
+struct OutputBatch {
+    /// The dynamics trajectory (num_states x num_mesh_points).
+    Eigen::Ref<MatrixX<T>, 0, Eigen::OuterStride<>> dynamics;
+    /// The path constraints trajectory
+    /// (num_path_constraints x num_mesh_points).
+    Eigen::Ref<MatrixX<T>, 0, Eigen::OuterStride<>> path;
+};
+
+/// This struct holds the outputs of
+/// OptimalControlProblem::calc_differential_algebraic_equations_jacobian():
+/// the derivatives of the `dynamics` and `path` outputs of
+/// calc_differential_algebraic_equations() with respect to the states,
+/// controls, and adjuncts at a single time. Each matrix has a row for each
+/// element of the output and a column for each element of the input (e.g.,
+/// `dynamics_states` is num_states x num_states). All entries are zero
+/// before the function is called. As with Output, these are references to
+/// memory managed by the direct collocation solver; do not copy them.
+/// @ingroup optimalcontrol
+template<typename T>
+struct OutputJacobian {
+    Eigen::Ref<MatrixX<T>> dynamics_states;
+    Eigen::Ref<MatrixX<T>> dynamics_controls;
+    Eigen::Ref<MatrixX<T>> dynamics_adjuncts;
+    Eigen::Ref<MatrixX<T>> path_states;
+    Eigen::Ref<MatrixX<T>> path_controls;
+    Eigen::Ref<MatrixX<T>> path_adjuncts;
+};
+
 /// We use the following terms to describe an optimal control problem:
 /// - *state*: a single state variable.
 /// - *states*:  a vector of all state variables at a given time.
@@ -155,6 +208,12 @@ public:
     {   return (int)m_parameter_infos.size(); }
     int get_num_path_constraints() const
     {   return (int)m_path_constraint_infos.size(); }
+    /// Get the bounds on the initial time, as provided to set_time().
+    const InitialBounds& get_initial_time_bounds() const
+    {   return m_initial_time_bounds; }
+    /// Get the bounds on the final time, as provided to set_time().
+    const FinalBounds& get_final_time_bounds() const
+    {   return m_final_time_bounds; }
     /// Get the names of all the states in the order they appear in the
     /// `states` input to calc_differential_algebraic_equations(), etc.
     /// Note: this function is not free to call.
@@ -298,22 +357,68 @@ public:
     /// you want that.
     virtual void calc_differential_algebraic_equations(
             const Input<T>& in, Output<T> out) const;
-    // TODO alternate form that takes a matrix; state at every time.
-    //virtual void continuous(const MatrixX<T>& x, MatrixX<T>& xdot) const = 0;
-    // TODO Maybe this one signature could be used for both the "continuous,
-    // entire trajectory" mode or the "one time" mode.
-    //    var.states[0];
-    //    var.states_traj
-    //    var.controls[0];
-    //    out.derivatives[0] =
-    //    out.constraints[0] = ...
-    //}
+    /// Optionally, compute the derivatives of the outputs of
+    /// calc_differential_algebraic_equations() with respect to the states,
+    /// controls, and adjuncts at a single time (e.g., if your dynamics have
+    /// a closed form). Return false (the default) to have the Jacobian of
+    /// the constraints computed with finite differences; if you return true,
+    /// the transcription assembles the Jacobian of the constraints from
+    /// these derivatives (only derivatives with respect to the time and
+    /// parameter variables are still computed with finite differences), and
+    /// the Hessian of the constraints is computed by finite differences of
+    /// that Jacobian. This is only used when the scalar type is double.
+    virtual bool calc_differential_algebraic_equations_jacobian(
+            const Input<T>& in, OutputJacobian<T> out) const;
+    /// Compute the same quantities as
+    /// calc_differential_algebraic_equations(), but for all mesh points at
+    /// once. The transcription calls this function, not the per-mesh-point
+    /// one, to evaluate the constraints. The default implementation calls
+    /// calc_differential_algebraic_equations() for each mesh point.
+    /// Override this if your computations can be vectorized across time
+    /// (e.g., using Eigen's array operations on rows of the trajectories).
+    /// The per-mesh-point function is still used elsewhere (e.g., to detect
+    /// the sparsity of the Hessian), so the two must compute the same values.
+    virtual void calc_differential_algebraic_equations_batch(
+            const InputBatch<T>& in, OutputBatch<T> out) const;
     // TODO endpoint or terminal cost?
     virtual void calc_endpoint_cost(const T& final_time,
             const VectorX<T>& final_states,
             const VectorX<T>& parameters,
             T& cost) const;
     virtual void calc_integral_cost(const Input<T>& in, T& integrand) const;
+    /// Compute the integrand from calc_integral_cost() for all mesh points
+    /// at once; element i of `integrand` is the integrand at mesh point i.
+    /// The transcription calls this function, not the per-mesh-point one, to
+    /// evaluate the objective. The default implementation calls
+    /// calc_integral_cost() for each mesh point.
+    virtual void calc_integral_cost_batch(const InputBatch<T>& in,
+            Eigen::Ref<VectorX<T>> integrand) const;
+    /// Optionally, compute the gradient of the integrand from
+    /// calc_integral_cost() with respect to the states, controls, and
+    /// adjuncts at a single time. The gradients are zero before this
+    /// function is called. Return false (the default) to have the gradient of
+    /// the objective computed with finite differences; if you return true,
+    /// the transcription assembles the gradient of the objective from these
+    /// gradients (only derivatives with respect to the time and parameter
+    /// variables, and the endpoint cost, are still computed with finite
+    /// differences). This is only used when the scalar type is double.
+    virtual bool calc_integral_cost_gradient(const Input<T>& in,
+            Eigen::Ref<VectorX<T>> states_gradient,
+            Eigen::Ref<VectorX<T>> controls_gradient,
+            Eigen::Ref<VectorX<T>> adjuncts_gradient) const;
+    /// Optionally, declare the indices of the states, controls, and adjuncts
+    /// on which the integrand from calc_integral_cost() depends, and the
+    /// indices of the final states on which calc_endpoint_cost() depends.
+    /// The transcription then provides the sparsity of the gradient of the
+    /// objective directly instead of detecting it by perturbing each
+    /// variable. The costs are assumed to depend on the time and parameter
+    /// variables. The vectors are empty before this function is called.
+    /// Return false (the default) if you do not know the dependencies.
+    virtual bool calc_cost_dependencies(
+            std::vector<int>& integral_cost_states,
+            std::vector<int>& integral_cost_controls,
+            std::vector<int>& integral_cost_adjuncts,
+            std::vector<int>& endpoint_cost_states) const;
     /// @}
 
     /// @name Helpers for setting an initial guess
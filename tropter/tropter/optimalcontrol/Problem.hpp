@@ -136,6 +136,28 @@ void Problem<T>::
 calc_differential_algebraic_equations(const Input<T>&, Output<T>) const
 {}
 
+template<typename T>
+bool Problem<T>::
+calc_differential_algebraic_equations_jacobian(const Input<T>&,
+        OutputJacobian<T>) const
+{
+    return false;
+}
+
+template<typename T>
+void Problem<T>::
+calc_differential_algebraic_equations_batch(const InputBatch<T>& in,
+        OutputBatch<T> out) const
+{
+    for (int i_mesh = 0; i_mesh < (int)in.times.size(); ++i_mesh) {
+        calc_differential_algebraic_equations(
+                {i_mesh, in.times[i_mesh], in.states.col(i_mesh),
+                 in.controls.col(i_mesh), in.adjuncts.col(i_mesh),
+                 in.parameters},
+                {out.dynamics.col(i_mesh), out.path.col(i_mesh)});
+    }
+}
+
 template<typename T>
 void Problem<T>::
 calc_endpoint_cost(const T&, const VectorX<T>&, const VectorX<T>&, T&) const
@@ -146,6 +168,34 @@ void Problem<T>::
 calc_integral_cost(const Input<T>&, T&) const
 {}
 
+template<typename T>
+void Problem<T>::
+calc_integral_cost_batch(const InputBatch<T>& in,
+        Eigen::Ref<VectorX<T>> integrand) const
+{
+    for (int i_mesh = 0; i_mesh < (int)in.times.size(); ++i_mesh) {
+        calc_integral_cost({i_mesh, in.times[i_mesh], in.states.col(i_mesh),
+                in.controls.col(i_mesh), in.adjuncts.col(i_mesh),
+                in.parameters}, integrand[i_mesh]);
+    }
+}
+
+template<typename T>
+bool Problem<T>::
+calc_integral_cost_gradient(const Input<T>&, Eigen::Ref<VectorX<T>>,
+        Eigen::Ref<VectorX<T>>, Eigen::Ref<VectorX<T>>) const
+{
+    return false;
+}
+
+template<typename T>
+bool Problem<T>::
+calc_cost_dependencies(std::vector<int>&, std::vector<int>&,
+        std::vector<int>&, std::vector<int>&) const
+{
+    return false;
+}
+
 template<typename T>
 void Problem<T>::
 set_state_guess(Iterate& guess,
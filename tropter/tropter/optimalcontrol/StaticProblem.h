@@ -0,0 +1,181 @@
+#ifndef TROPTER_OPTIMALCONTROL_STATICPROBLEM_H
+#define TROPTER_OPTIMALCONTROL_STATICPROBLEM_H
+// ----------------------------------------------------------------------------
+// tropter: StaticProblem.h
+// ----------------------------------------------------------------------------
+// Copyright (c) 2017 tropter authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may
+// not use this file except in compliance with the License. You may obtain a
+// copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "Problem.h"
+
+#include <cassert>
+
+namespace tropter {
+
+/// This struct holds inputs to the functions that a StaticProblem
+/// implements. It is the same as Input, except that the states and controls
+/// are fixed-size vectors.
+/// @ingroup optimalcontrol
+template<typename T, int NumStates, int NumControls>
+struct StaticInput {
+    const int mesh_index;
+    const T& time;
+    const Eigen::Matrix<T, NumStates, 1>& states;
+    const Eigen::Matrix<T, NumControls, 1>& controls;
+    const Eigen::Ref<const VectorX<T>>& parameters;
+};
+
+/// Derive from this class instead of Problem if your problem is small and
+/// you know the number of states, controls, and path constraints at compile
+/// time (e.g., a sliding mass or a pendulum). The derived class passes
+/// itself as the first template argument (the "curiously recurring template
+/// pattern"):
+/// @code{.cpp}
+/// template <typename T>
+/// class SlidingMass : public tropter::StaticProblem<SlidingMass<T>, T, 2, 1> {
+/// public:
+///     SlidingMass() {
+///         this->set_time({0}, {2});
+///         this->add_state("x", {0, 2}, {0}, {1});
+///         this->add_state("u", {-10, 10}, {0}, {0});
+///         this->add_control("F", {-50, 50});
+///     }
+///     void calc_differential_algebraic_equations_static(
+///             const tropter::StaticInput<T, 2, 1>& in,
+///             tropter::Vector2<T>& dynamics,
+///             Eigen::Matrix<T, 0, 1>&) const {
+///         dynamics[0] = in.states[1];
+///         dynamics[1] = in.controls[0] / 10.0;
+///     }
+///     void calc_integral_cost_static(const tropter::StaticInput<T, 2, 1>& in,
+///             T& integrand) const {
+///         integrand = in.controls.squaredNorm();
+///     }
+/// };
+/// @endcode
+/// The derived class implements the following (non-virtual) functions in
+/// place of calc_differential_algebraic_equations() and
+/// calc_integral_cost():
+/// @code{.cpp}
+/// void calc_differential_algebraic_equations_static(
+///         const StaticInput<T, NumStates, NumControls>& in,
+///         Eigen::Matrix<T, NumStates, 1>& dynamics,
+///         Eigen::Matrix<T, NumPathConstraints, 1>& path) const;
+/// void calc_integral_cost_static(
+///         const StaticInput<T, NumStates, NumControls>& in,
+///         T& integrand) const;
+/// @endcode
+/// The latter is optional; the default integrand is 0.
+/// This class implements the batch functions of Problem by looping over the
+/// mesh points and calling the derived class's functions directly, so the
+/// transcription makes one virtual call per evaluation of the constraints or
+/// objective (rather than one per mesh point), the compiler can inline the
+/// derived class's functions, and all temporaries have a fixed size.
+/// The number of states, controls, and path constraints added in the
+/// constructor must match the template arguments, and the problem may not
+/// have adjuncts (this is checked only in debug builds).
+/// @ingroup optimalcontrol
+template<typename Derived, typename T, int NumStates, int NumControls,
+        int NumPathConstraints = 0>
+class StaticProblem : public Problem<T> {
+public:
+    using States = Eigen::Matrix<T, NumStates, 1>;
+    using Controls = Eigen::Matrix<T, NumControls, 1>;
+    using PathConstraints = Eigen::Matrix<T, NumPathConstraints, 1>;
+
+    using Problem<T>::Problem;
+
+    /// The default integrand is 0; hide this function in the derived class
+    /// to provide an integral cost.
+    void calc_integral_cost_static(
+            const StaticInput<T, NumStates, NumControls>&,
+            T& integrand) const {
+        integrand = 0;
+    }
+
+    void calc_differential_algebraic_equations(
+            const Input<T>& in, Output<T> out) const override final {
+        check_sizes(in.adjuncts.size());
+        const States states = in.states;
+        const Controls controls = in.controls;
+        States dynamics;
+        PathConstraints path;
+        derived().calc_differential_algebraic_equations_static(
+                {in.mesh_index, in.time, states, controls, in.parameters},
+                dynamics, path);
+        out.dynamics = dynamics;
+        out.path = path;
+    }
+    void calc_differential_algebraic_equations_batch(
+            const InputBatch<T>& in, OutputBatch<T> out) const override final {
+        check_sizes(in.adjuncts.rows());
+        States states;
+        Controls controls;
+        States dynamics;
+        PathConstraints path;
+        for (int i_mesh = 0; i_mesh < (int)in.times.size(); ++i_mesh) {
+            states = in.states.col(i_mesh);
+            controls = in.controls.col(i_mesh);
+            derived().calc_differential_algebraic_equations_static(
+                    {i_mesh, in.times[i_mesh], states, controls,
+                     in.parameters},
+                    dynamics, path);
+            out.dynamics.col(i_mesh) = dynamics;
+            out.path.col(i_mesh) = path;
+        }
+    }
+    void calc_integral_cost(const Input<T>& in,
+            T& integrand) const override final {
+        check_sizes(in.adjuncts.size());
+        const States states = in.states;
+        const Controls controls = in.controls;
+        derived().calc_integral_cost_static(
+                {in.mesh_index, in.time, states, controls, in.parameters},
+                integrand);
+    }
+    void calc_integral_cost_batch(const InputBatch<T>& in,
+            Eigen::Ref<VectorX<T>> integrand) const override final {
+        check_sizes(in.adjuncts.rows());
+        States states;
+        Controls controls;
+        for (int i_mesh = 0; i_mesh < (int)in.times.size(); ++i_mesh) {
+            states = in.states.col(i_mesh);
+            controls = in.controls.col(i_mesh);
+            derived().calc_integral_cost_static(
+                    {i_mesh, in.times[i_mesh], states, controls,
+                     in.parameters},
+                    integrand[i_mesh]);
+        }
+    }
+
+private:
+    const Derived& derived() const {
+        return static_cast<const Derived&>(*this);
+    }
+    /// This is only checked in debug builds, since it is invoked for every
+    /// evaluation of the problem.
+    void check_sizes(Eigen::Index num_adjuncts) const {
+        assert(this->get_num_states() == NumStates
+                && this->get_num_controls() == NumControls
+                && this->get_num_path_constraints() == NumPathConstraints
+                && num_adjuncts == 0
+                && "The numbers of states, controls, and path constraints "
+                   "must match the template arguments, and the problem may "
+                   "not have adjuncts.");
+        (void)num_adjuncts;
+    }
+};
+
+} // namespace tropter
+
+#endif // TROPTER_OPTIMALCONTROL_STATICPROBLEM_H
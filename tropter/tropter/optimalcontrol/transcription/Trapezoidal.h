@@ -24,8 +24,8 @@ namespace transcription {
 
 /// The variables are ordered as follows:
 /// @verbatim
-/// ti
-/// tf
+/// ti (omitted if the initial time is fixed)
+/// tf (omitted if the final time is fixed)
 /// parameters
 /// states(t=0)
 /// controls(t=0)
@@ -39,7 +39,21 @@ namespace transcription {
 /// adjuncts(t=N)
 /// @endverbatim
 ///
-/// The constraints are ordered as follows:
+/// If the controls are represented on a coarser control mesh (see
+/// set_num_control_mesh_points()), the controls are omitted from the
+/// variables at each mesh point, and the control values at the control mesh
+/// points are placed at the end:
+/// @verbatim
+/// ...
+/// states(t=N)
+/// adjuncts(t=N)
+/// controls(control mesh point 0)
+/// controls(control mesh point 1)
+/// ...
+/// controls(control mesh point M)
+/// @endverbatim
+///
+/// By default, the constraints are ordered as follows:
 /// @verbatim
 /// defects(interval 1)
 /// defects(interval 2)
@@ -50,9 +64,25 @@ namespace transcription {
 /// ...
 /// path(t=N)
 /// @endverbatim
+///
+/// If set_interleave_constraints() is true, the constraints are instead
+/// ordered by mesh point (time-major), so that the defects for interval i
+/// are followed by the path constraints at mesh point i:
+/// @verbatim
+/// path(t=0)
+/// defects(interval 1)
+/// path(t=1)
+/// defects(interval 2)
+/// path(t=2)
+/// ...
+/// defects(interval N)
+/// path(t=N)
+/// @endverbatim
+/// With this ordering, the rows of the constraint Jacobian that depend on a
+/// given mesh point are adjacent, and the Jacobian (and KKT matrix) has a
+/// block-banded structure; this can reduce fill-in in the sparse linear
+/// solver.
 /// @ingroup optimalcontrol
-// TODO reorder constraints by pairing up defects and paths at a given time
-// point; does this help the sparsity structure?
 template<typename T>
 class Trapezoidal : public Base<T> {
 public:
@@ -72,10 +102,49 @@ public:
     // TODO right now, must call this BEFORE set_problem.
     void set_num_mesh_points(unsigned N);
     void set_ocproblem(std::shared_ptr<const OCProblem> ocproblem);
+    /// Order the constraints by mesh point (time-major) instead of listing
+    /// all defects before all path constraints (default: false). This
+    /// affects the constraint bounds and names, and can be changed after
+    /// the problem is set.
+    void set_interleave_constraints(bool value);
+    /// @copydoc set_interleave_constraints()
+    bool get_interleave_constraints() const
+    {   return m_interleave_constraints; }
+
+    /// Represent the controls with their values at `M` equally-spaced
+    /// control mesh points, and linearly interpolate these values to obtain
+    /// the controls at each mesh point. The interpolation weights are fixed,
+    /// so this reduces the number of control variables (and finite
+    /// difference seeds) from num_mesh_points * num_controls to M *
+    /// num_controls. `M` must be at least 2 and no more than the number of
+    /// mesh points. Use 0 (default) to have control variables at every mesh
+    /// point. The first and last control mesh points coincide with the first
+    /// and last mesh points, and take the initial and final control bounds.
+    /// This can be changed after the problem is set.
+    void set_num_control_mesh_points(unsigned M);
+    /// @copydoc set_num_control_mesh_points()
+    int get_num_control_mesh_points() const
+    {   return m_num_control_mesh_points; }
 
     void calc_objective(const VectorX<T>& x, T& obj_value) const override;
     void calc_constraints(const VectorX<T>& x,
             Eigen::Ref<VectorX<T>> constr) const override;
+    /// If the optimal control problem provides the gradient of the
+    /// integrand (Problem::calc_integral_cost_gradient()), assemble the
+    /// gradient of the objective from the integrand gradient at each mesh
+    /// point. The derivatives with respect to the time variables and
+    /// parameters, and of the endpoint cost, are computed with central
+    /// differences.
+    bool calc_gradient(const VectorX<T>& x,
+            VectorX<T>& gradient) const override;
+    /// If the optimal control problem provides the derivatives of its
+    /// differential algebraic equations
+    /// (Problem::calc_differential_algebraic_equations_jacobian()), assemble
+    /// the Jacobian of the defects and path constraints from these
+    /// derivatives at each mesh point. The derivatives with respect to the
+    /// time variables and parameters are computed with central differences.
+    bool calc_jacobian(const VectorX<T>& x,
+            std::vector<Eigen::Triplet<T>>& jacobian) const override;
     /// Use knowledge of the repeated structure of the optimization problem
     /// to efficiently determine the sparsity pattern of the entire Hessian.
     /// We only need to perturb the optimal control functions at one mesh point,
@@ -83,10 +152,18 @@ public:
     void calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
             SymmetricSparsityPattern&,
             SymmetricSparsityPattern&) const override;
+    /// If the optimal control problem declares the variables on which its
+    /// costs depend (Problem::calc_cost_dependencies()), the gradient of the
+    /// objective is nonzero for the time variables, the parameters, the
+    /// integrand's variables at every mesh point, and the endpoint cost's
+    /// states at the last mesh point.
+    bool calc_sparsity_gradient(const Eigen::VectorXd& x,
+            std::vector<unsigned int>& nonzero_indices) const override;
 
     /// For continuous variables, the format is
     /// `<continuous-variable-name>_<mesh-point-index>`. The mesh point index is
-    /// 0-based.
+    /// 0-based. For controls on a control mesh, the index is that of the
+    /// control mesh point.
     /// Note: this function is not free to call.
     std::vector<std::string> get_variable_names() const override;
     /// For defect constraints, the format is
@@ -148,6 +225,17 @@ protected:
     template<typename S>
     TrajectoryViewConst<S>
     make_adjuncts_trajectory_view(const VectorX<S>& variables) const;
+    /// The controls at each mesh point. If the controls are on a control
+    /// mesh, this interpolates the controls into working memory; otherwise,
+    /// this is a view into the variables.
+    using ControlsTrajectory = Eigen::Ref<const MatrixX<T>, 0,
+            Eigen::OuterStride<Eigen::Dynamic>>;
+    ControlsTrajectory make_controls_trajectory(const VectorX<T>& x) const;
+    /// Linearly interpolate the controls at the control mesh points to the
+    /// mesh points.
+    template<typename S>
+    void interpolate_controls(const TrajectoryViewConst<S>& control_mesh_values,
+            MatrixX<S>& controls) const;
     // TODO find a way to avoid these duplicated functions, using SFINAE.
     /// This provides a view to which you can write.
     template<typename S>
@@ -166,8 +254,14 @@ protected:
     make_adjuncts_trajectory_view(VectorX<S>& variables) const;
 
     // TODO templatize.
-    using DefectsTrajectoryView = Eigen::Map<MatrixX<T>>;
-    using PathConstraintsTrajectoryView = Eigen::Map<MatrixX<T>>;
+    /// The outer stride depends on the ordering of the constraints (see
+    /// set_interleave_constraints()).
+    using DefectsTrajectoryView = Eigen::Map<MatrixX<T>,
+            Eigen::Unaligned,
+            Eigen::OuterStride<Eigen::Dynamic>>;
+    using PathConstraintsTrajectoryView = Eigen::Map<MatrixX<T>,
+            Eigen::Unaligned,
+            Eigen::OuterStride<Eigen::Dynamic>>;
 
     struct ConstraintsView {
         ConstraintsView(DefectsTrajectoryView d,
@@ -175,17 +269,39 @@ protected:
                 : defects(d),
                   path_constraints(pc) {}
         // TODO what is the proper name for this? dynamic defects?
-        DefectsTrajectoryView defects = {nullptr, 0, 0};
-        PathConstraintsTrajectoryView path_constraints = {nullptr, 0, 0};
+        DefectsTrajectoryView defects = {nullptr, 0, 0,
+                Eigen::OuterStride<Eigen::Dynamic>(0)};
+        PathConstraintsTrajectoryView path_constraints = {nullptr, 0, 0,
+                Eigen::OuterStride<Eigen::Dynamic>(0)};
     };
 
     ConstraintsView
     make_constraints_view(Eigen::Ref<VectorX<T>> constraints) const;
 
+    /// Get the initial time from the vector of variables; if the initial time
+    /// is fixed (its lower and upper bounds are equal), it is not a variable
+    /// and the fixed value is returned.
+    template<typename S>
+    S get_initial_time(const VectorX<S>& variables) const;
+    /// @copydoc get_initial_time()
+    template<typename S>
+    S get_final_time(const VectorX<S>& variables) const;
+
 private:
 
+    /// Compute the layout of the constraint vector, and set the constraint
+    /// names and bounds accordingly.
+    void set_constraint_names_and_bounds();
+
     std::shared_ptr<const OCProblem> m_ocproblem;
     int m_num_mesh_points;
+    // The initial (final) time is an optimization variable only if its
+    // bounds are not equal; otherwise, we store its fixed value.
+    bool m_initial_time_is_variable = true;
+    bool m_final_time_is_variable = true;
+    double m_initial_time = std::numeric_limits<double>::quiet_NaN();
+    double m_final_time = std::numeric_limits<double>::quiet_NaN();
+    // 0, 1, or 2, depending on which of the times are fixed.
     int m_num_time_variables = -1;
     int m_num_parameters = -1;
     // The sum total of time_variables and parameters. Here, "dense" means that
@@ -196,17 +312,58 @@ private:
     int m_num_states = -1;
     int m_num_controls = -1;
     int m_num_adjuncts = -1;
+    // The number of variables at each mesh point; this excludes the
+    // controls if they are on a control mesh.
     int m_num_continuous_variables = -1;
+    // 0 if there are control variables at every mesh point.
+    int m_num_control_mesh_points = 0;
+    bool m_use_control_mesh = false;
+    // Layout of the controls in the vector of variables: the index of the
+    // first control, the distance between the controls of consecutive
+    // (control) mesh points, and the number of (control) mesh points.
+    int m_controls_offset = -1;
+    int m_controls_stride = -1;
+    int m_num_control_columns = -1;
+    // For each mesh point, the index of the control mesh interval containing
+    // the mesh point, and the weight on the control mesh point at the end of
+    // the interval.
+    std::vector<int> m_control_interval_indices;
+    Eigen::VectorXd m_control_interpolation_weights;
     int m_num_dynamics_constraints = -1;
     int m_num_path_constraints = -1;
+    // Used to pad the mesh index in variable and constraint names.
+    int m_num_digits_max_mesh_index = -1;
+    Eigen::VectorXd m_path_constraints_lower;
+    Eigen::VectorXd m_path_constraints_upper;
     Eigen::VectorXd m_trapezoidal_quadrature_coefficients;
 
+    // Layout of the constraint vector: the index of the first defect (or path
+    // constraint), and the distance between the defects (or path constraints)
+    // of consecutive mesh intervals (or mesh points).
+    bool m_interleave_constraints = false;
+    int m_defects_offset = -1;
+    int m_defects_stride = -1;
+    int m_path_constraints_offset = -1;
+    int m_path_constraints_stride = -1;
+
     std::vector<std::string> m_variable_names;
     std::vector<std::string> m_constraint_names;
 
-    // Working memory.
+    // Working memory. This is shared by all evaluations, so a transcription
+    // must not be evaluated from multiple threads at once.
     mutable VectorX<T> m_integrand;
+    mutable RowVectorX<T> m_times;
     mutable MatrixX<T> m_derivs;
+    mutable MatrixX<T> m_controls;
+    mutable VectorX<T> m_states_gradient;
+    mutable VectorX<T> m_controls_gradient;
+    mutable VectorX<T> m_adjuncts_gradient;
+    mutable VectorX<T> m_final_states;
+    mutable VectorX<T> m_x_working;
+    mutable MatrixX<T> m_dynamics_jacobian;
+    mutable MatrixX<T> m_path_jacobian;
+    mutable VectorX<T> m_constraints_pos;
+    mutable VectorX<T> m_constraints_neg;
 };
 
 } // namespace transcription
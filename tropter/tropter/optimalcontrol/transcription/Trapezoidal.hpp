@@ -40,12 +40,48 @@ void Trapezoidal<T>::set_ocproblem(
     m_num_states = m_ocproblem->get_num_states();
     m_num_controls = m_ocproblem->get_num_controls();
     m_num_adjuncts = m_ocproblem->get_num_adjuncts();
-    m_num_continuous_variables = m_num_states + m_num_controls + m_num_adjuncts;
-    m_num_time_variables = 2;
+    TROPTER_THROW_IF(m_num_control_mesh_points > m_num_mesh_points,
+            "Expected the number of control mesh points to be no more than "
+            "the number of mesh points (%i), but got %i.",
+            m_num_mesh_points, m_num_control_mesh_points);
+    m_use_control_mesh = m_num_controls && m_num_control_mesh_points &&
+            m_num_control_mesh_points != m_num_mesh_points;
+    const int num_controls_per_mesh_point =
+            m_use_control_mesh ? 0 : m_num_controls;
+    m_num_continuous_variables = m_num_states + num_controls_per_mesh_point
+            + m_num_adjuncts;
+    // If the bounds on a time are equal (e.g., a fixed-time tracking problem),
+    // the time is not an optimization variable. This removes dense columns
+    // from the Jacobian and dense rows from the Hessian.
+    const auto& initial_time_bounds = m_ocproblem->get_initial_time_bounds();
+    const auto& final_time_bounds = m_ocproblem->get_final_time_bounds();
+    m_initial_time_is_variable =
+            !(initial_time_bounds.lower == initial_time_bounds.upper);
+    m_final_time_is_variable =
+            !(final_time_bounds.lower == final_time_bounds.upper);
+    m_initial_time = m_initial_time_is_variable
+            ? std::numeric_limits<double>::quiet_NaN()
+            : initial_time_bounds.lower;
+    m_final_time = m_final_time_is_variable
+            ? std::numeric_limits<double>::quiet_NaN()
+            : final_time_bounds.lower;
+    m_num_time_variables =
+            int(m_initial_time_is_variable) + int(m_final_time_is_variable);
     m_num_parameters = m_ocproblem->get_num_parameters();
     m_num_dense_variables = m_num_time_variables + m_num_parameters;
+    if (m_use_control_mesh) {
+        m_controls_offset = m_num_dense_variables
+                + m_num_mesh_points * m_num_continuous_variables;
+        m_controls_stride = m_num_controls;
+        m_num_control_columns = m_num_control_mesh_points;
+    } else {
+        m_controls_offset = m_num_dense_variables + m_num_states;
+        m_controls_stride = m_num_continuous_variables;
+        m_num_control_columns = m_num_mesh_points;
+    }
     int num_variables = m_num_time_variables + m_num_parameters
-            + m_num_mesh_points * m_num_continuous_variables;
+            + m_num_mesh_points * m_num_continuous_variables
+            + (m_use_control_mesh ? m_num_control_columns * m_num_controls : 0);
     this->set_num_variables(num_variables);
     m_num_defects = m_num_states ? m_num_mesh_points - 1 : 0;
     m_num_dynamics_constraints = m_num_defects * m_num_states;
@@ -56,26 +92,30 @@ void Trapezoidal<T>::set_ocproblem(
             num_path_traj_constraints;
     this->set_num_constraints(num_constraints);
 
-    // Variable and constraint names.
-    // ------------------------------
+    // Variable names.
+    // ---------------
+    // Constraint names are set in set_constraint_names_and_bounds().
     m_variable_names.clear();
-    m_variable_names.emplace_back("initial_time");
-    m_variable_names.emplace_back("final_time");
+    if (m_initial_time_is_variable)
+        m_variable_names.emplace_back("initial_time");
+    if (m_final_time_is_variable)
+        m_variable_names.emplace_back("final_time");
 
     const auto param_names = m_ocproblem->get_parameter_names();
     for (const auto& param_name : param_names)
         m_variable_names.push_back(param_name);
 
     // For padding, count the number of digits in num_mesh_points.
-    int num_digits_max_mesh_index = 0;
+    m_num_digits_max_mesh_index = 0;
     {
         // The printed index goes up to m_num_mesh_points - 1.
         int max_index = m_num_mesh_points - 1;
         while (max_index != 0) {
             max_index /= 10;
-            num_digits_max_mesh_index++;
+            m_num_digits_max_mesh_index++;
         }
     }
+    const auto& num_digits_max_mesh_index = m_num_digits_max_mesh_index;
     const auto state_names = m_ocproblem->get_state_names();
     const auto control_names = m_ocproblem->get_control_names();
     const auto adjunct_names = m_ocproblem->get_adjunct_names();
@@ -87,12 +127,14 @@ void Trapezoidal<T>::set_ocproblem(
                     << i_mesh;
             m_variable_names.push_back(ss.str());
         }
-        for (const auto& control_name : control_names) {
-            std::stringstream ss;
-            ss << control_name << "_"
-                    << std::setfill('0') << std::setw(num_digits_max_mesh_index)
-                    << i_mesh;
-            m_variable_names.push_back(ss.str());
+        if (!m_use_control_mesh) {
+            for (const auto& control_name : control_names) {
+                std::stringstream ss;
+                ss << control_name << "_"
+                        << std::setfill('0')
+                        << std::setw(num_digits_max_mesh_index) << i_mesh;
+                m_variable_names.push_back(ss.str());
+            }
         }
         for (const auto& adjunct_name : adjunct_names) {
             std::stringstream ss;
@@ -102,26 +144,15 @@ void Trapezoidal<T>::set_ocproblem(
             m_variable_names.push_back(ss.str());
         }
     }
-
-    m_constraint_names.clear();
-    // Start at index 1 (counting mesh intervals; not mesh points).
-    for (int i_mesh = 1; i_mesh < m_num_mesh_points; ++i_mesh) {
-        for (const auto& state_name : state_names) {
-            std::stringstream ss;
-            ss << state_name << "_"
-                    << std::setfill('0') << std::setw(num_digits_max_mesh_index)
-                    << i_mesh;
-            m_constraint_names.push_back(ss.str());
-        }
-    }
-    const auto path_constraint_names = m_ocproblem->get_path_constraint_names();
-    for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
-        for (const auto& path_constraint_name : path_constraint_names) {
-            std::stringstream ss;
-            ss << path_constraint_name << "_"
-                    << std::setfill('0') << std::setw(num_digits_max_mesh_index)
-                    << i_mesh;
-            m_constraint_names.push_back(ss.str());
+    if (m_use_control_mesh) {
+        for (int i_cmesh = 0; i_cmesh < m_num_control_columns; ++i_cmesh) {
+            for (const auto& control_name : control_names) {
+                std::stringstream ss;
+                ss << control_name << "_"
+                        << std::setfill('0')
+                        << std::setw(num_digits_max_mesh_index) << i_cmesh;
+                m_variable_names.push_back(ss.str());
+            }
         }
     }
 
@@ -169,39 +200,72 @@ void Trapezoidal<T>::set_ocproblem(
             path_constraints_lower, path_constraints_upper);
     // TODO validate sizes.
     // Bounds on variables.
+    VectorXd time_lower(m_num_time_variables);
+    VectorXd time_upper(m_num_time_variables);
+    {
+        int itime = 0;
+        if (m_initial_time_is_variable) {
+            time_lower[itime] = initial_time_lower;
+            time_upper[itime] = initial_time_upper;
+            ++itime;
+        }
+        if (m_final_time_is_variable) {
+            time_lower[itime] = final_time_lower;
+            time_upper[itime] = final_time_upper;
+        }
+    }
     VectorXd variable_lower(num_variables);
-    variable_lower <<
-            initial_time_lower, final_time_lower, parameters_lower,
-            initial_states_lower, initial_controls_lower, 
-            initial_adjuncts_lower,
-            (VectorXd(m_num_continuous_variables)
-                    << states_lower, controls_lower, adjuncts_lower)
-                    .finished()
-                    .replicate(m_num_mesh_points - 2, 1),
-            final_states_lower, final_controls_lower, final_adjuncts_lower;
     VectorXd variable_upper(num_variables);
-    variable_upper <<
-            initial_time_upper, final_time_upper, parameters_upper,
-            initial_states_upper, initial_controls_upper, 
-            initial_adjuncts_upper,
-            (VectorXd(m_num_continuous_variables)
-                    << states_upper, controls_upper, adjuncts_upper)
-                    .finished()
-                    .replicate(m_num_mesh_points - 2, 1),
-            final_states_upper, final_controls_upper, final_adjuncts_upper;
+    if (m_use_control_mesh) {
+        // The controls at the interior mesh points are interpolated between
+        // control mesh points, so they also satisfy the control bounds.
+        variable_lower <<
+                time_lower, parameters_lower,
+                initial_states_lower, initial_adjuncts_lower,
+                (VectorXd(m_num_continuous_variables)
+                        << states_lower, adjuncts_lower)
+                        .finished()
+                        .replicate(m_num_mesh_points - 2, 1),
+                final_states_lower, final_adjuncts_lower,
+                initial_controls_lower,
+                controls_lower.replicate(m_num_control_columns - 2, 1),
+                final_controls_lower;
+        variable_upper <<
+                time_upper, parameters_upper,
+                initial_states_upper, initial_adjuncts_upper,
+                (VectorXd(m_num_continuous_variables)
+                        << states_upper, adjuncts_upper)
+                        .finished()
+                        .replicate(m_num_mesh_points - 2, 1),
+                final_states_upper, final_adjuncts_upper,
+                initial_controls_upper,
+                controls_upper.replicate(m_num_control_columns - 2, 1),
+                final_controls_upper;
+    } else {
+        variable_lower <<
+                time_lower, parameters_lower,
+                initial_states_lower, initial_controls_lower,
+                initial_adjuncts_lower,
+                (VectorXd(m_num_continuous_variables)
+                        << states_lower, controls_lower, adjuncts_lower)
+                        .finished()
+                        .replicate(m_num_mesh_points - 2, 1),
+                final_states_lower, final_controls_lower, final_adjuncts_lower;
+        variable_upper <<
+                time_upper, parameters_upper,
+                initial_states_upper, initial_controls_upper,
+                initial_adjuncts_upper,
+                (VectorXd(m_num_continuous_variables)
+                        << states_upper, controls_upper, adjuncts_upper)
+                        .finished()
+                        .replicate(m_num_mesh_points - 2, 1),
+                final_states_upper, final_controls_upper, final_adjuncts_upper;
+    }
     this->set_variable_bounds(variable_lower, variable_upper);
     // Bounds for constraints.
-    VectorXd constraint_lower(num_constraints);
-    VectorXd constraint_upper(num_constraints);
-    // Defects must be 0.
-    VectorXd dynamics_bounds = VectorXd::Zero(m_num_dynamics_constraints);
-    VectorXd path_constraints_traj_lower =
-            path_constraints_lower.replicate(m_num_mesh_points, 1);
-    VectorXd path_constraints_traj_upper =
-            path_constraints_upper.replicate(m_num_mesh_points, 1);
-    constraint_lower << dynamics_bounds, path_constraints_traj_lower;
-    constraint_upper << dynamics_bounds, path_constraints_traj_upper;
-    this->set_constraint_bounds(constraint_lower, constraint_upper);
+    m_path_constraints_lower = path_constraints_lower;
+    m_path_constraints_upper = path_constraints_upper;
+    set_constraint_names_and_bounds();
     // TODO won't work if the bounds don't include zero!
     // TODO set_initial_guess(std::vector<double>(num_variables)); // TODO user
     // input
@@ -222,26 +286,133 @@ void Trapezoidal<T>::set_ocproblem(
     m_trapezoidal_quadrature_coefficients.tail(num_mesh_intervals) +=
             0.5 * mesh_intervals;
 
+    // Interpolation from the control mesh to the mesh.
+    m_control_interval_indices.clear();
+    m_control_interpolation_weights.resize(0);
+    if (m_use_control_mesh) {
+        const int num_control_intervals = m_num_control_columns - 1;
+        m_control_interval_indices.resize(m_num_mesh_points);
+        m_control_interpolation_weights.resize(m_num_mesh_points);
+        for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
+            // Position of the mesh point in units of control mesh intervals.
+            const double position = mesh[i_mesh] * num_control_intervals;
+            const int interval = std::min((int)std::floor(position),
+                    num_control_intervals - 1);
+            m_control_interval_indices[i_mesh] = interval;
+            m_control_interpolation_weights[i_mesh] = position - interval;
+        }
+    }
+
     // Allocate working memory.
     m_integrand.resize(m_num_mesh_points);
+    m_times.resize(m_num_mesh_points);
     m_derivs.resize(m_num_states, m_num_mesh_points);
+    m_controls.resize(m_num_controls,
+            m_use_control_mesh ? m_num_mesh_points : 0);
 
     m_ocproblem->initialize_on_mesh(mesh);
 }
 
+template<typename T>
+void Trapezoidal<T>::set_num_control_mesh_points(unsigned M) {
+    TROPTER_THROW_IF(M == 1, "Expected number of control mesh points to be "
+            "0 or at least 2, but got %i", M);
+    m_num_control_mesh_points = M;
+    // The number of variables changes.
+    if (m_ocproblem) set_ocproblem(m_ocproblem);
+}
+
+template<typename T>
+void Trapezoidal<T>::set_interleave_constraints(bool value) {
+    m_interleave_constraints = value;
+    // The number of constraints does not change, so we need not redo all of
+    // set_ocproblem().
+    if (m_ocproblem) set_constraint_names_and_bounds();
+}
+
+template<typename T>
+void Trapezoidal<T>::set_constraint_names_and_bounds() {
+    const int num_defects_per_interval = m_num_defects ? m_num_states : 0;
+    if (m_interleave_constraints) {
+        // path(t=0), defects(interval 1), path(t=1), defects(interval 2), ...
+        const int num_constraints_per_mesh_point =
+                num_defects_per_interval + m_num_path_constraints;
+        m_path_constraints_offset = 0;
+        m_path_constraints_stride = num_constraints_per_mesh_point;
+        m_defects_offset = m_num_path_constraints;
+        m_defects_stride = num_constraints_per_mesh_point;
+    } else {
+        m_defects_offset = 0;
+        m_defects_stride = num_defects_per_interval;
+        m_path_constraints_offset = m_num_dynamics_constraints;
+        m_path_constraints_stride = m_num_path_constraints;
+    }
+
+    // Constraint names.
+    // -----------------
+    const int num_constraints = this->get_num_constraints();
+    const auto& num_digits_max_mesh_index = m_num_digits_max_mesh_index;
+    m_constraint_names.assign(num_constraints, "");
+    const auto state_names = m_ocproblem->get_state_names();
+    // Start at index 1 (counting mesh intervals; not mesh points).
+    for (int i_mesh = 1; i_mesh <= m_num_defects; ++i_mesh) {
+        const int istart = m_defects_offset + (i_mesh - 1) * m_defects_stride;
+        for (int i_state = 0; i_state < m_num_states; ++i_state) {
+            std::stringstream ss;
+            ss << state_names[i_state] << "_"
+                    << std::setfill('0') << std::setw(num_digits_max_mesh_index)
+                    << i_mesh;
+            m_constraint_names[istart + i_state] = ss.str();
+        }
+    }
+    const auto path_constraint_names = m_ocproblem->get_path_constraint_names();
+    for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
+        const int istart = m_path_constraints_offset +
+                i_mesh * m_path_constraints_stride;
+        for (int i_pc = 0; i_pc < m_num_path_constraints; ++i_pc) {
+            std::stringstream ss;
+            ss << path_constraint_names[i_pc] << "_"
+                    << std::setfill('0') << std::setw(num_digits_max_mesh_index)
+                    << i_mesh;
+            m_constraint_names[istart + i_pc] = ss.str();
+        }
+    }
+
+    // Constraint bounds.
+    // ------------------
+    using Eigen::VectorXd;
+    VectorXd constraint_lower(num_constraints);
+    VectorXd constraint_upper(num_constraints);
+    // Defects must be 0.
+    for (int i_mesh = 0; i_mesh < m_num_defects; ++i_mesh) {
+        const int istart = m_defects_offset + i_mesh * m_defects_stride;
+        constraint_lower.segment(istart, m_num_states).setZero();
+        constraint_upper.segment(istart, m_num_states).setZero();
+    }
+    for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
+        const int istart = m_path_constraints_offset +
+                i_mesh * m_path_constraints_stride;
+        constraint_lower.segment(istart, m_num_path_constraints) =
+                m_path_constraints_lower;
+        constraint_upper.segment(istart, m_num_path_constraints) =
+                m_path_constraints_upper;
+    }
+    this->set_constraint_bounds(constraint_lower, constraint_upper);
+}
+
 template<typename T>
 void Trapezoidal<T>::calc_objective(const VectorX<T>& x, T& obj_value) const
 {
     // TODO move this to a "make_variables_view()"
-    const T& initial_time = x[0];
-    const T& final_time = x[1];
+    const T initial_time = get_initial_time(x);
+    const T final_time = get_final_time(x);
     const T duration = final_time - initial_time;
     const T step_size = duration / (m_num_mesh_points - 1);
 
     // TODO I don't actually need to make a new view each time; just change the
     // data pointer. TODO probably don't even need to update the data pointer!
     auto states = make_states_trajectory_view(x);
-    auto controls = make_controls_trajectory_view(x);
+    const auto controls = make_controls_trajectory(x);
     auto adjuncts = make_adjuncts_trajectory_view(x);
     auto parameters = make_parameters_view(x);
 
@@ -259,12 +430,10 @@ void Trapezoidal<T>::calc_objective(const VectorX<T>& x, T& obj_value) const
     // --------------
     m_integrand.setZero();
     for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
-        const T time = step_size * i_mesh + initial_time;
-        m_ocproblem->calc_integral_cost({i_mesh, time,
-                states.col(i_mesh), controls.col(i_mesh), adjuncts.col(i_mesh),
-                parameters}, 
-                m_integrand[i_mesh]);
+        m_times[i_mesh] = step_size * i_mesh + initial_time;
     }
+    m_ocproblem->calc_integral_cost_batch(
+            {m_times, states, controls, adjuncts, parameters}, m_integrand);
     // TODO use more intelligent quadrature? trapezoidal rule?
     T integral_cost = 0;
     for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
@@ -277,18 +446,258 @@ void Trapezoidal<T>::calc_objective(const VectorX<T>& x, T& obj_value) const
     obj_value += integral_cost;
 }
 
+template<typename T>
+bool Trapezoidal<T>::calc_gradient(const VectorX<T>& x,
+        VectorX<T>& gradient) const
+{
+    const T initial_time = get_initial_time(x);
+    const T final_time = get_final_time(x);
+    const T duration = final_time - initial_time;
+    const T step_size = duration / (m_num_mesh_points - 1);
+
+    auto states = make_states_trajectory_view(x);
+    const auto controls = make_controls_trajectory(x);
+    auto adjuncts = make_adjuncts_trajectory_view(x);
+    const VectorX<T> parameters = make_parameters_view(x);
+
+    auto states_gradient = make_states_trajectory_view(gradient);
+    auto controls_gradient = make_controls_trajectory_view(gradient);
+    auto adjuncts_gradient = make_adjuncts_trajectory_view(gradient);
+
+    // Initialize on iterate.
+    // ----------------------
+    m_ocproblem->initialize_on_iterate(parameters);
+
+    // Integral cost.
+    // --------------
+    // The integrand at a mesh point depends only on the variables at that
+    // mesh point (and the time variables and parameters).
+    m_states_gradient.resize(m_num_states);
+    m_controls_gradient.resize(m_num_controls);
+    m_adjuncts_gradient.resize(m_num_adjuncts);
+    for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
+        const T time = step_size * i_mesh + initial_time;
+        m_states_gradient.setZero();
+        m_controls_gradient.setZero();
+        m_adjuncts_gradient.setZero();
+        if (!m_ocproblem->calc_integral_cost_gradient({i_mesh, time,
+                states.col(i_mesh), controls.col(i_mesh), adjuncts.col(i_mesh),
+                parameters},
+                m_states_gradient, m_controls_gradient, m_adjuncts_gradient)) {
+            return false;
+        }
+        // The quadrature coefficients are fractions of the duration.
+        const T coefficient =
+                duration * m_trapezoidal_quadrature_coefficients[i_mesh];
+        states_gradient.col(i_mesh) = coefficient * m_states_gradient;
+        adjuncts_gradient.col(i_mesh) = coefficient * m_adjuncts_gradient;
+        if (m_use_control_mesh) {
+            // Distribute to the control mesh points by the interpolation
+            // weights (see interpolate_controls()).
+            const int& interval = m_control_interval_indices[i_mesh];
+            const double& weight = m_control_interpolation_weights[i_mesh];
+            controls_gradient.col(interval) +=
+                    T(1.0 - weight) * coefficient * m_controls_gradient;
+            controls_gradient.col(interval + 1) +=
+                    T(weight) * coefficient * m_controls_gradient;
+        } else {
+            controls_gradient.col(i_mesh) = coefficient * m_controls_gradient;
+        }
+    }
+
+    // TODO use a better estimate for this step size.
+    const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
+    const double two_eps = 2 * eps;
+
+    // Endpoint cost.
+    // --------------
+    m_final_states = states.rightCols(1);
+    for (int i_state = 0; i_state < m_num_states; ++i_state) {
+        T cost_pos = 0;
+        T cost_neg = 0;
+        // Perform a central difference.
+        m_final_states[i_state] += eps;
+        m_ocproblem->calc_endpoint_cost(final_time, m_final_states,
+                parameters, cost_pos);
+        m_final_states[i_state] = states(i_state, m_num_mesh_points - 1) - eps;
+        m_ocproblem->calc_endpoint_cost(final_time, m_final_states,
+                parameters, cost_neg);
+        // Restore the original value.
+        m_final_states[i_state] = states(i_state, m_num_mesh_points - 1);
+        states_gradient(i_state, m_num_mesh_points - 1) +=
+                (cost_pos - cost_neg) / two_eps;
+    }
+
+    // Time variables and parameters.
+    // ------------------------------
+    // These variables affect the objective at every mesh point.
+    m_x_working = x;
+    for (int i_var = 0; i_var < m_num_dense_variables; ++i_var) {
+        T obj_pos = 0;
+        T obj_neg = 0;
+        m_x_working[i_var] += eps;
+        calc_objective(m_x_working, obj_pos);
+        m_x_working[i_var] = x[i_var] - eps;
+        calc_objective(m_x_working, obj_neg);
+        m_x_working[i_var] = x[i_var];
+        gradient[i_var] = (obj_pos - obj_neg) / two_eps;
+    }
+    return true;
+}
+
+template<typename T>
+bool Trapezoidal<T>::calc_jacobian(const VectorX<T>& x,
+        std::vector<Eigen::Triplet<T>>& jacobian) const
+{
+    const T initial_time = get_initial_time(x);
+    const T final_time = get_final_time(x);
+    const T duration = final_time - initial_time;
+    const T step_size = duration / (m_num_mesh_points - 1);
+
+    auto states = make_states_trajectory_view(x);
+    const auto controls = make_controls_trajectory(x);
+    auto adjuncts = make_adjuncts_trajectory_view(x);
+    const VectorX<T> parameters = make_parameters_view(x);
+
+    // Initialize on iterate.
+    // ----------------------
+    m_ocproblem->initialize_on_iterate(parameters);
+
+    // Add the nonzero entries of a block of derivatives, scaled by factor,
+    // with the top left entry at (row_start, col_start).
+    auto add_block = [&jacobian](int row_start, int col_start,
+            const Eigen::Ref<const MatrixX<T>>& block, const T& factor) {
+        for (int j = 0; j < (int)block.cols(); ++j) {
+            for (int i = 0; i < (int)block.rows(); ++i) {
+                if (block(i, j) != 0) {
+                    jacobian.emplace_back(row_start + i, col_start + j,
+                            factor * block(i, j));
+                }
+            }
+        }
+    };
+    // The index of the first state (adjunct) at a mesh point, and of the
+    // first control at a (control) mesh point.
+    auto states_index = [this](int i_mesh) {
+        return m_num_dense_variables + i_mesh * m_num_continuous_variables;
+    };
+    auto adjuncts_index = [this](int i_mesh) {
+        return m_num_dense_variables + (i_mesh + 1) * m_num_continuous_variables
+                - m_num_adjuncts;
+    };
+    auto add_controls_block = [&](int row_start, int i_mesh,
+            const Eigen::Ref<const MatrixX<T>>& block, const T& factor) {
+        if (m_use_control_mesh) {
+            // Distribute to the control mesh points by the interpolation
+            // weights (see interpolate_controls()).
+            const int& interval = m_control_interval_indices[i_mesh];
+            const double& weight = m_control_interpolation_weights[i_mesh];
+            add_block(row_start, m_controls_offset
+                    + interval * m_controls_stride,
+                    block, T(1.0 - weight) * factor);
+            add_block(row_start, m_controls_offset
+                    + (interval + 1) * m_controls_stride,
+                    block, T(weight) * factor);
+        } else {
+            add_block(row_start, m_controls_offset + i_mesh * m_controls_stride,
+                    block, factor);
+        }
+    };
+
+    // Defects and path constraints.
+    // -----------------------------
+    // The DAE at a mesh point depends only on the variables at that mesh
+    // point (and the time variables and parameters).
+    const int num_inputs = m_num_states + m_num_controls + m_num_adjuncts;
+    m_dynamics_jacobian.resize(m_num_states, num_inputs);
+    m_path_jacobian.resize(m_num_path_constraints, num_inputs);
+    auto& dyn = m_dynamics_jacobian;
+    auto& path = m_path_jacobian;
+    const T defect_factor = -0.5 * step_size;
+    for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
+        const T time = step_size * i_mesh + initial_time;
+        dyn.setZero();
+        path.setZero();
+        if (!m_ocproblem->calc_differential_algebraic_equations_jacobian(
+                {i_mesh, time, states.col(i_mesh), controls.col(i_mesh),
+                 adjuncts.col(i_mesh), parameters},
+                {dyn.leftCols(m_num_states),
+                 dyn.middleCols(m_num_states, m_num_controls),
+                 dyn.rightCols(m_num_adjuncts),
+                 path.leftCols(m_num_states),
+                 path.middleCols(m_num_states, m_num_controls),
+                 path.rightCols(m_num_adjuncts)})) {
+            return false;
+        }
+
+        if (m_num_path_constraints) {
+            const int row = m_path_constraints_offset +
+                    i_mesh * m_path_constraints_stride;
+            add_block(row, states_index(i_mesh),
+                    path.leftCols(m_num_states), T(1));
+            add_controls_block(row, i_mesh,
+                    path.middleCols(m_num_states, m_num_controls), T(1));
+            add_block(row, adjuncts_index(i_mesh),
+                    path.rightCols(m_num_adjuncts), T(1));
+        }
+
+        // This mesh point appears in the defects of the interval that ends
+        // here and of the interval that starts here:
+        // defect_i = x_i - (x_{i-1} + 0.5 * h * (xdot_i + xdot_{i-1})).
+        for (const int i_defect : {i_mesh - 1, i_mesh}) {
+            if (i_defect < 0 || i_defect >= m_num_defects) continue;
+            const double sign = (i_defect == i_mesh - 1) ? 1 : -1;
+            const int row = m_defects_offset + i_defect * m_defects_stride;
+            const int col = states_index(i_mesh);
+            for (int i_state = 0; i_state < m_num_states; ++i_state) {
+                jacobian.emplace_back(row + i_state, col + i_state, T(sign));
+            }
+            add_block(row, col, dyn.leftCols(m_num_states), defect_factor);
+            add_controls_block(row, i_mesh,
+                    dyn.middleCols(m_num_states, m_num_controls),
+                    defect_factor);
+            add_block(row, adjuncts_index(i_mesh),
+                    dyn.rightCols(m_num_adjuncts), defect_factor);
+        }
+    }
+
+    // Time variables and parameters.
+    // ------------------------------
+    // These variables affect the constraints at every mesh point.
+    // TODO use a better estimate for this step size.
+    const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
+    const double two_eps = 2 * eps;
+    const int num_constraints = this->get_num_constraints();
+    m_constraints_pos.resize(num_constraints);
+    m_constraints_neg.resize(num_constraints);
+    m_x_working = x;
+    for (int i_var = 0; i_var < m_num_dense_variables; ++i_var) {
+        m_x_working[i_var] += eps;
+        calc_constraints(m_x_working, m_constraints_pos);
+        m_x_working[i_var] = x[i_var] - eps;
+        calc_constraints(m_x_working, m_constraints_neg);
+        m_x_working[i_var] = x[i_var];
+        for (int i_constr = 0; i_constr < num_constraints; ++i_constr) {
+            const T value = (m_constraints_pos[i_constr]
+                    - m_constraints_neg[i_constr]) / two_eps;
+            if (value != 0) jacobian.emplace_back(i_constr, i_var, value);
+        }
+    }
+    return true;
+}
+
 template<typename T>
 void Trapezoidal<T>::calc_constraints(const VectorX<T>& x,
         Eigen::Ref<VectorX<T>> constraints) const
 {
     // TODO parallelize.
-    const T& initial_time = x[0];
-    const T& final_time = x[1];
+    const T initial_time = get_initial_time(x);
+    const T final_time = get_final_time(x);
     const T duration = final_time - initial_time;
     const T step_size = duration / (m_num_mesh_points - 1);
 
     auto states = make_states_trajectory_view(x);
-    auto controls = make_controls_trajectory_view(x);
+    const auto controls = make_controls_trajectory(x);
     auto adjuncts = make_adjuncts_trajectory_view(x);
     auto parameters = make_parameters_view(x);
 
@@ -309,14 +718,12 @@ void Trapezoidal<T>::calc_constraints(const VectorX<T>& x,
     // xdot (at t0). (TODO I don't think this is true anymore).
     // TODO tradeoff between memory and parallelism.
     for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
-        // TODO should pass the time.
-        const T time = step_size * i_mesh + initial_time;
-        m_ocproblem->calc_differential_algebraic_equations(
-                {i_mesh, time, states.col(i_mesh), controls.col(i_mesh),
-                 adjuncts.col(i_mesh), parameters},
-                {m_derivs.col(i_mesh),
-                 constr_view.path_constraints.col(i_mesh)});
+        m_times[i_mesh] = step_size * i_mesh + initial_time;
     }
+    // The problem may evaluate all mesh points at once.
+    m_ocproblem->calc_differential_algebraic_equations_batch(
+            {m_times, states, controls, adjuncts, parameters},
+            {m_derivs, constr_view.path_constraints});
 
     // Compute constraint defects.
     // ---------------------------
@@ -358,9 +765,9 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(
 
     // Hessian of constraints.
     // -----------------------
-    // The first two rows of the Hessian contain partial derivatives with
-    // initial_time and final_time. We assume time is coupled to all other
-    // variables.
+    // The first rows of the Hessian contain partial derivatives with
+    // initial_time and final_time (if they are variables) and the parameters.
+    // We assume time is coupled to all other variables.
     // TODO can be smarter about interaction of variables with time; implicit
     // formulations (see test_double_pendulum) give additional sparsity here.
     for (int irow = 0; irow < m_num_dense_variables; ++irow) {
@@ -380,11 +787,57 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(
     // + 1. However, since the sparsity pattern repeats for each mesh point,
     // we can "ignore" the dependence on mesh point i + 1.
 
+    // The variables at mesh point 0, in the order states, controls,
+    // adjuncts. If the controls are on a control mesh, the controls at mesh
+    // point 0 are those at control mesh point 0.
+    Eigen::VectorXd mesh_point_variables(m_num_states + m_num_controls +
+            m_num_adjuncts);
+    mesh_point_variables <<
+            make_states_trajectory_view(x).col(0),
+            make_controls_trajectory_view(x).col(0),
+            make_adjuncts_trajectory_view(x).col(0);
+
+    // Add a block of nonzeros with respect to the variables (states, controls,
+    // adjuncts) at mesh point imesh. If the controls are on a control mesh,
+    // the controls at a mesh point depend on the variables at both ends of a
+    // control mesh interval.
+    auto set_nonzero_mesh_point_block = [this, &num_con_vars](
+            SymmetricSparsityPattern& sparsity, int imesh,
+            SymmetricSparsityPattern& block) {
+        const auto istart = m_num_dense_variables + imesh * num_con_vars;
+        if (!m_use_control_mesh) {
+            sparsity.set_nonzero_block(istart, istart, block);
+            return;
+        }
+        const int interval = m_control_interval_indices[imesh];
+        auto get_indices = [&](int index) -> std::vector<int> {
+            if (index < m_num_states) return {istart + index};
+            index -= m_num_states;
+            if (index < m_num_controls) {
+                const int icontrol = m_controls_offset +
+                        interval * m_controls_stride + index;
+                return {icontrol, icontrol + m_controls_stride};
+            }
+            index -= m_num_controls;
+            return {istart + m_num_states + index};
+        };
+        const auto block_rows = block.convert_to_CompressedRowSparsity();
+        for (int irow = 0; irow < (int)block_rows.size(); ++irow) {
+            for (const auto& icol : block_rows[irow]) {
+                for (const auto& i : get_indices(irow)) {
+                    for (const auto& j : get_indices(icol)) {
+                        sparsity.set_nonzero(std::min(i, j), std::max(i, j));
+                    }
+                }
+            }
+        }
+    };
+
     // This function evaluates the DAE at the mesh point 0, and returns a
     // single DAE derivative or path constraint.
     std::function<T(const VectorX<T>&, int)> calc_dae =
             [this, &x](const VectorX<T>& vars, int idx) {
-                T t = x[0]; // initial time.
+                T t = get_initial_time(x);
                 VectorX<T> s = vars.head(m_num_states);
                 VectorX<T> c = vars.segment(m_num_states, m_num_controls);
                 VectorX<T> a = vars.tail(m_num_adjuncts);
@@ -397,24 +850,21 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(
                 return idx < m_num_states ? deriv[idx]
                                           : path[idx - m_num_states];
             };
-    SymmetricSparsityPattern dae_sparsity(m_num_continuous_variables);
+    SymmetricSparsityPattern dae_sparsity(mesh_point_variables.size());
     for (int i = 0; i < (m_num_states + m_num_path_constraints); ++i) {
         // Create a function for a specific derivative or path constraint.
         std::function<T(const VectorX<T>&)> calc_dae_i =
                 std::bind(calc_dae, std::placeholders::_1, i);
         // Determine the sparsity for this specific derivative/path constraint.
         auto block_sparsity = calc_hessian_sparsity_with_perturbation(
-                x.segment(m_num_dense_variables,
-                    m_num_continuous_variables),
-                calc_dae_i);
+                mesh_point_variables, calc_dae_i);
         // Add in this sparsity to the block that we'll repeat.
         dae_sparsity.add_in_nonzeros(block_sparsity);
     }
 
     // Repeat the block down the diagonal of the Hessian of constraints.
     for (int imesh = 0; imesh < m_num_mesh_points; ++imesh) {
-        const auto istart = m_num_dense_variables + imesh * num_con_vars;
-        hescon_sparsity.set_nonzero_block(istart, istart, dae_sparsity);
+        set_nonzero_mesh_point_block(hescon_sparsity, imesh, dae_sparsity);
     }
 
 
@@ -434,7 +884,7 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(
     // point 0, then repeat this block down the diagonal.
     std::function<T(const VectorX<T>&)> calc_integral_cost =
             [this, &x](const VectorX<T>& vars) {
-        T t = x[0]; // initial time.
+        T t = get_initial_time(x);
         VectorX<T> s = vars.head(m_num_states);
         VectorX<T> c = vars.segment(m_num_states, m_num_controls);
         VectorX<T> a = vars.tail(m_num_adjuncts);
@@ -447,19 +897,18 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(
     SymmetricSparsityPattern integral_cost_sparsity =
             calc_hessian_sparsity_with_perturbation(
                     // Grab the first state and first controls.
-                    x.segment(m_num_dense_variables, num_con_vars),
+                    mesh_point_variables,
                     calc_integral_cost);
     for (int imesh = 0; imesh < m_num_mesh_points; ++imesh) {
-        const auto istart = m_num_dense_variables + imesh * num_con_vars;
-        hesobj_sparsity.set_nonzero_block(istart, istart,
+        set_nonzero_mesh_point_block(hesobj_sparsity, imesh,
                 integral_cost_sparsity);
     }
 
     // Endpoint cost depends on final time and final state only.
     std::function<T(const VectorX<T>&)> calc_endpoint_cost =
             [this, &x](const VectorX<T>& vars) {
-                T t = x[1]; // final time. TODO see if endpoint cost actually
-                // depends on final time; put it in vars.
+                T t = get_final_time(x); // TODO see if endpoint cost
+                // actually depends on final time; put it in vars.
                 VectorX<T> s = vars;
                 VectorX<T> p = x.segment(m_num_time_variables,
                     m_num_parameters).template cast<T>();
@@ -481,6 +930,59 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(
     // affect hesobj for most problems?
 }
 
+template<typename T>
+bool Trapezoidal<T>::calc_sparsity_gradient(const Eigen::VectorXd&,
+        std::vector<unsigned int>& nonzero_indices) const {
+    std::vector<int> integral_states;
+    std::vector<int> integral_controls;
+    std::vector<int> integral_adjuncts;
+    std::vector<int> endpoint_states;
+    if (!m_ocproblem->calc_cost_dependencies(integral_states,
+            integral_controls, integral_adjuncts, endpoint_states)) {
+        return false;
+    }
+    auto check = [](const std::vector<int>& indices, int size,
+            const std::string& description) {
+        for (const auto& index : indices) {
+            TROPTER_THROW_IF(index < 0 || index >= size,
+                    "Expected the indices of the %s on which the costs "
+                    "depend to be in [0, %i), but got %i.",
+                    description, size, index);
+        }
+    };
+    check(integral_states, m_num_states, "states");
+    check(integral_controls, m_num_controls, "controls");
+    check(integral_adjuncts, m_num_adjuncts, "adjuncts");
+    check(endpoint_states, m_num_states, "states");
+
+    // Mark the nonzero entries using views into a vector with the layout of
+    // the variables.
+    Eigen::VectorXd nonzero = Eigen::VectorXd::Zero(this->get_num_variables());
+    // The time variables affect the integral through the mesh spacing, and
+    // the parameters may affect any cost.
+    nonzero.head(m_num_dense_variables).setOnes();
+    auto states = make_states_trajectory_view(nonzero);
+    auto controls = make_controls_trajectory_view(nonzero);
+    auto adjuncts = make_adjuncts_trajectory_view(nonzero);
+    for (int imesh = 0; imesh < m_num_mesh_points; ++imesh) {
+        for (const auto& i : integral_states) states(i, imesh) = 1;
+        for (const auto& i : integral_adjuncts) adjuncts(i, imesh) = 1;
+    }
+    // On a control mesh, the controls at a mesh point depend on the
+    // control variables at both ends of the control mesh interval, and
+    // every control mesh point lies within some mesh interval.
+    for (int icol = 0; icol < m_num_control_columns; ++icol) {
+        for (const auto& i : integral_controls) controls(i, icol) = 1;
+    }
+    for (const auto& i : endpoint_states) {
+        states(i, m_num_mesh_points - 1) = 1;
+    }
+    for (int i = 0; i < nonzero.size(); ++i) {
+        if (nonzero[i]) nonzero_indices.push_back(i);
+    }
+    return true;
+}
+
 template<typename T>
 std::vector<std::string> Trapezoidal<T>::get_variable_names() const {
     return m_variable_names;
@@ -567,13 +1069,33 @@ construct_iterate(const Iterate& traj, bool interpolate) const
     // TODO reorder columns !!!!!
 
     Eigen::VectorXd iterate(this->get_num_variables());
-    // Initial and final time.
-    iterate[0] = traj_to_use->time[0];
-    iterate[1] = traj_to_use->time.tail<1>()[0];
+    // Initial and final time, if they are variables.
+    if (m_initial_time_is_variable)
+        iterate[0] = traj_to_use->time[0];
+    if (m_final_time_is_variable)
+        iterate[m_num_time_variables - 1] = traj_to_use->time.tail<1>()[0];
     // Create mutable views. This will probably fail miserably if the
     // dimensions do not match.
     this->make_states_trajectory_view(iterate) = traj_to_use->states;
-    this->make_controls_trajectory_view(iterate) = traj_to_use->controls;
+    if (m_use_control_mesh) {
+        // Sample the controls at the control mesh points.
+        auto control_mesh_values = this->make_controls_trajectory_view(iterate);
+        const auto& controls = traj_to_use->controls;
+        const int num_control_intervals = m_num_control_columns - 1;
+        for (int i_cmesh = 0; i_cmesh < m_num_control_columns; ++i_cmesh) {
+            // Position of the control mesh point in units of mesh intervals.
+            const double position = (m_num_mesh_points - 1) *
+                    double(i_cmesh) / num_control_intervals;
+            const int interval = std::min((int)std::floor(position),
+                    m_num_mesh_points - 2);
+            const double weight = position - interval;
+            control_mesh_values.col(i_cmesh) =
+                    (1.0 - weight) * controls.col(interval)
+                    + weight * controls.col(interval + 1);
+        }
+    } else {
+        this->make_controls_trajectory_view(iterate) = traj_to_use->controls;
+    }
     if (traj_to_use->adjuncts.cols())
         this->make_adjuncts_trajectory_view(iterate) = traj_to_use->adjuncts;
     if (traj_to_use->parameters.size())
@@ -587,14 +1109,19 @@ Iterate Trapezoidal<T>::
 deconstruct_iterate(const Eigen::VectorXd& x) const
 {
     // TODO move time variables to the end.
-    const double& initial_time = x[0];
-    const double& final_time = x[1];
+    const double initial_time = get_initial_time(x);
+    const double final_time = get_final_time(x);
     Iterate traj;
     traj.time = Eigen::RowVectorXd::LinSpaced(m_num_mesh_points,
             initial_time, final_time);
 
     traj.states = this->make_states_trajectory_view(x);
-    traj.controls = this->make_controls_trajectory_view(x);
+    if (m_use_control_mesh) {
+        interpolate_controls(this->make_controls_trajectory_view(x),
+                traj.controls);
+    } else {
+        traj.controls = this->make_controls_trajectory_view(x);
+    }
     traj.adjuncts = this->make_adjuncts_trajectory_view(x);
     traj.parameters = this->make_parameters_view(x);
 
@@ -1004,12 +1531,12 @@ typename Trapezoidal<T>::template TrajectoryViewConst<S>
 Trapezoidal<T>::make_controls_trajectory_view(const VectorX<S>& x) const
 {
     return {
-            // Start of controls for first mesh interval.
-            x.data() + m_num_dense_variables + m_num_states,
+            // Start of controls for first (control) mesh point.
+            x.data() + m_controls_offset,
             m_num_controls,          // Number of rows.
-            m_num_mesh_points,       // Number of columns.
-            // Distance between the start of each column; same as above.
-            Eigen::OuterStride<Eigen::Dynamic>(m_num_continuous_variables)};
+            m_num_control_columns,   // Number of columns.
+            // Distance between the start of each column.
+            Eigen::OuterStride<Eigen::Dynamic>(m_controls_stride)};
 }
 
 template<typename T>
@@ -1019,7 +1546,8 @@ Trapezoidal<T>::make_adjuncts_trajectory_view(const VectorX<S>& x) const
 {
     return {
             // Start of adjuncts for first mesh interval.
-            x.data() + m_num_dense_variables + m_num_states + m_num_controls,
+            x.data() + m_num_dense_variables + m_num_continuous_variables
+                    - m_num_adjuncts,
             m_num_adjuncts,         // Number of rows.
             m_num_mesh_points,      // Number of columns.
             // Distance between the start of each column; same as above.
@@ -1059,12 +1587,12 @@ typename Trapezoidal<T>::template TrajectoryView<S>
 Trapezoidal<T>::make_controls_trajectory_view(VectorX<S>& x) const
 {
     return {
-            // Start of controls for first mesh interval.
-            x.data() + m_num_dense_variables + m_num_states,
+            // Start of controls for first (control) mesh point.
+            x.data() + m_controls_offset,
             m_num_controls,          // Number of rows.
-            m_num_mesh_points,       // Number of columns.
-            // Distance between the start of each column; same as above.
-            Eigen::OuterStride<Eigen::Dynamic>(m_num_continuous_variables)};
+            m_num_control_columns,   // Number of columns.
+            // Distance between the start of each column.
+            Eigen::OuterStride<Eigen::Dynamic>(m_controls_stride)};
 }
 
 template<typename T>
@@ -1074,25 +1602,73 @@ Trapezoidal<T>::make_adjuncts_trajectory_view(VectorX<S>& x) const
 {
     return{
            // Start of adjuncts for first mesh interval.
-           x.data() + m_num_dense_variables + m_num_states + m_num_controls,
+           x.data() + m_num_dense_variables + m_num_continuous_variables
+                   - m_num_adjuncts,
            m_num_adjuncts,         // Number of rows.
            m_num_mesh_points,      // Number of columns.
            // Distance between the start of each column; same as above.
            Eigen::OuterStride<Eigen::Dynamic>(m_num_continuous_variables)};
 }
 
+template<typename T>
+typename Trapezoidal<T>::ControlsTrajectory
+Trapezoidal<T>::make_controls_trajectory(const VectorX<T>& x) const
+{
+    if (m_use_control_mesh) {
+        interpolate_controls(make_controls_trajectory_view(x), m_controls);
+        return m_controls;
+    }
+    return make_controls_trajectory_view(x);
+}
+
+template<typename T>
+template<typename S>
+void Trapezoidal<T>::interpolate_controls(
+        const TrajectoryViewConst<S>& control_mesh_values,
+        MatrixX<S>& controls) const
+{
+    controls.resize(m_num_controls, m_num_mesh_points);
+    for (int i_mesh = 0; i_mesh < m_num_mesh_points; ++i_mesh) {
+        const int& interval = m_control_interval_indices[i_mesh];
+        const double& weight = m_control_interpolation_weights[i_mesh];
+        controls.col(i_mesh) =
+                S(1.0 - weight) * control_mesh_values.col(interval)
+                + S(weight) * control_mesh_values.col(interval + 1);
+    }
+}
+
 template<typename T>
 typename Trapezoidal<T>::ConstraintsView
 Trapezoidal<T>::make_constraints_view(Eigen::Ref<VectorX<T>> constr) const
 {
     // Starting indices of different parts of the constraints vector.
     T* d_ptr = m_num_defects ?                           // defects.
-               &constr[0] : nullptr;
+               &constr[m_defects_offset] : nullptr;
     T* pc_ptr= m_num_path_constraints ?                  // path constraints.
-               &constr[m_num_dynamics_constraints] : nullptr;
-    return {DefectsTrajectoryView(d_ptr, m_num_states, m_num_defects),
+               &constr[m_path_constraints_offset] : nullptr;
+    return {DefectsTrajectoryView(d_ptr, m_num_states, m_num_defects,
+                    Eigen::OuterStride<Eigen::Dynamic>(m_defects_stride)),
             PathConstraintsTrajectoryView(pc_ptr, m_num_path_constraints,
-                    m_num_mesh_points)};
+                    m_num_mesh_points,
+                    Eigen::OuterStride<Eigen::Dynamic>(
+                            m_path_constraints_stride))};
+}
+
+template<typename T>
+template<typename S>
+S Trapezoidal<T>::get_initial_time(const VectorX<S>& x) const
+{
+    if (m_initial_time_is_variable) return x[0];
+    return S(m_initial_time);
+}
+
+template<typename T>
+template<typename S>
+S Trapezoidal<T>::get_final_time(const VectorX<S>& x) const
+{
+    // The final time comes after the initial time, if both are variables.
+    if (m_final_time_is_variable) return x[m_num_time_variables - 1];
+    return S(m_final_time);
 }
 
 } // namespace transcription
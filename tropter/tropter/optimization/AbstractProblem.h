@@ -19,9 +19,11 @@
 #include <tropter/common.h>
 #include <tropter/Exception.h>
 #include <memory>
+#include <vector>
 
 namespace tropter {
 
+class SparsityPattern;
 class SymmetricSparsityPattern;
 
 namespace optimization {
@@ -108,6 +110,33 @@ public:
 
     class CalcSparsityHessianLagrangianNotImplemented : public Exception {};
 
+    /// If using finite differences (double), we require the indices of the
+    /// variables on which the objective depends (the nonzero entries of its
+    /// gradient). By default, we detect these by perturbing each variable,
+    /// which requires an evaluation of the objective per variable, and
+    /// misses variables on which the objective is locally flat at the
+    /// perturbed iterate. If you know which variables the objective depends
+    /// on, implement this function to provide their indices and return
+    /// true. Return false (the default) to detect the indices by
+    /// perturbation. The same iterate is provided as for
+    /// calc_sparsity_hessian_lagrangian().
+    virtual bool calc_sparsity_gradient(const Eigen::VectorXd& x,
+            std::vector<unsigned int>& nonzero_indices) const;
+
+    /// If using finite differences (double), the entries of the Jacobian of
+    /// the constraints that do not depend on the variables (e.g., from
+    /// constraints that are linear in the variables) are computed only once,
+    /// in calc_sparsity(), rather than in every evaluation of the Jacobian.
+    /// If you know which entries are constant, implement this function to
+    /// call set_nonzero() on the provided pattern (with dimensions
+    /// num_constraints x num_variables) for each constant entry, and return
+    /// true. Return false (the default) to treat all entries as variable,
+    /// unless constant entries are detected numerically (see
+    /// ProblemDecorator::set_findiff_jacobian_constant_detection()). The same
+    /// iterate is provided as for calc_sparsity_hessian_lagrangian().
+    virtual bool calc_sparsity_constant_jacobian(const Eigen::VectorXd& x,
+            SparsityPattern& constant_sparsity) const;
+
     virtual std::unique_ptr<ProblemDecorator>
     make_decorator() const = 0;
 
@@ -158,6 +187,14 @@ inline void AbstractProblem::calc_sparsity_hessian_lagrangian(
         SymmetricSparsityPattern&) const {
     throw CalcSparsityHessianLagrangianNotImplemented();
 }
+inline bool AbstractProblem::calc_sparsity_gradient(
+        const Eigen::VectorXd&, std::vector<unsigned int>&) const {
+    return false;
+}
+inline bool AbstractProblem::calc_sparsity_constant_jacobian(
+        const Eigen::VectorXd&, SparsityPattern&) const {
+    return false;
+}
 inline Eigen::VectorXd
 AbstractProblem::make_initial_guess_from_bounds() const
 {
@@ -17,6 +17,7 @@
 #include "Problem.h"
 #include <tropter/SparsityPattern.h>
 #include <tropter/Exception.hpp>
+#include <tropter/utilities.h>
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
 #include <IpIpoptData.hpp>
@@ -27,20 +28,36 @@ using Ipopt::Index;
 using Ipopt::Number;
 
 using tropter::SparsityCoordinates;
+using tropter::ScopedTimer;
 using namespace tropter::optimization;
 
 class IPOPTSolver::TNLP : public Ipopt::TNLP {
 public:
     using Index = Ipopt::Index;
     using Number = Ipopt::Number;
-    TNLP(const ProblemDecorator& problem);
+    TNLP(const IPOPTSolver& solver, const ProblemDecorator& problem);
     void initialize(const VectorXd& guess,
             SparsityCoordinates jacobian_sparsity,
             SparsityCoordinates hessian_sparsity);
+    /// Provide initial values for the multipliers, used if IPOPT's
+    /// warm_start_init_point option is "yes".
+    void set_initial_multipliers(VectorXd variable_lower_multipliers,
+            VectorXd variable_upper_multipliers,
+            VectorXd constraint_multipliers);
     const Eigen::VectorXd& get_solution() const { return m_solution; }
+    const Eigen::VectorXd& get_variable_lower_multipliers() const
+    {   return m_variable_lower_multipliers; }
+    const Eigen::VectorXd& get_variable_upper_multipliers() const
+    {   return m_variable_upper_multipliers; }
+    const Eigen::VectorXd& get_constraint_multipliers() const
+    {   return m_constraint_multipliers; }
     const double& get_optimal_objective_value() const
     {   return m_optimal_obj_value; }
     const int& get_num_iterations() const { return m_num_iterations; }
+    /// Provide scale factors to IPOPT via get_scaling_parameters().
+    void set_scaling(double objective_scaling,
+            Eigen::VectorXd variable_scaling,
+            Eigen::VectorXd constraint_scaling);
 private:
     // TODO move to Problem if more than one solver would need this.
     // TODO should use fancy arguments to avoid temporaries and to exploit
@@ -61,12 +78,17 @@ private:
                          Number* g_lower, Number* g_upper) override;
 
     // z: multipliers for bound constraints on x.
-    // warmstart will require giving initial values for the multipliers.
     bool get_starting_point(Index num_variables, bool init_x, Number* x,
                             bool init_z, Number* z_L, Number* z_U,
                             Index num_constraints, bool init_lambda,
                             Number* lambda) override;
 
+    bool get_scaling_parameters(Number& obj_scaling,
+                                bool& use_x_scaling, Index num_variables,
+                                Number* x_scaling,
+                                bool& use_g_scaling, Index num_constraints,
+                                Number* g_scaling) override;
+
     bool eval_f(Index num_variables, const Number* x, bool new_x,
                 Number& obj_value) override;
 
@@ -86,6 +108,17 @@ private:
                 bool new_lambda, Index num_nonzeros_hessian,
                 Index* iRow, Index *jCol, Number* values) override;
 
+    bool intermediate_callback(Ipopt::AlgorithmMode mode,
+                               Index iter, Number obj_value,
+                               Number inf_pr, Number inf_du,
+                               Number mu, Number d_norm,
+                               Number regularization_size,
+                               Number alpha_du, Number alpha_pr,
+                               Index ls_trials,
+                               const Ipopt::IpoptData* ip_data,
+                               Ipopt::IpoptCalculatedQuantities* ip_cq)
+                               override;
+
     void finalize_solution(Ipopt::SolverReturn status,
                            Index num_variables,
                            const Number* x,
@@ -99,15 +132,30 @@ private:
 //    const ProblemDecorator& m_problem;
     // TODO reconsider the type of this variable:
     const ProblemDecorator& m_problem;
+    // Used to report on each iteration.
+    const IPOPTSolver& m_solver;
 
     unsigned m_num_variables = std::numeric_limits<unsigned>::max();
     unsigned m_num_constraints = std::numeric_limits<unsigned>::max();
 
     Eigen::VectorXd m_initial_guess;
+    Eigen::VectorXd m_initial_variable_lower_multipliers;
+    Eigen::VectorXd m_initial_variable_upper_multipliers;
+    Eigen::VectorXd m_initial_constraint_multipliers;
+    double m_objective_scaling = 1;
+    Eigen::VectorXd m_variable_scaling;
+    Eigen::VectorXd m_constraint_scaling;
     Eigen::VectorXd m_solution;
+    Eigen::VectorXd m_variable_lower_multipliers;
+    Eigen::VectorXd m_variable_upper_multipliers;
+    Eigen::VectorXd m_constraint_multipliers;
     double m_optimal_obj_value = std::numeric_limits<double>::quiet_NaN();
     int m_num_iterations = -1;
 
+    // Holds the cumulative time spent in each eval function.
+    IterationInfo m_iteration_info;
+    ScopedTimer::Clock::time_point m_start_time;
+
     unsigned m_hessian_num_nonzeros = std::numeric_limits<unsigned>::max();
     SparsityCoordinates m_hessian_sparsity;
     unsigned m_jacobian_num_nonzeros = std::numeric_limits<unsigned>::max();
@@ -152,6 +200,15 @@ std::string convert_IPOPT_ApplicationReturnStatus_to_string(
 }
 
 Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
+    Solution guess_without_multipliers;
+    guess_without_multipliers.variables = guess;
+    return optimize_warm_start_impl(guess_without_multipliers);
+}
+
+Solution IPOPTSolver::optimize_warm_start_impl(
+        const Solution& guess_solution) const {
+    const VectorXd& guess = guess_solution.variables;
+    const bool warm_start = guess_solution.has_multipliers();
 
     Ipopt::SmartPtr<Ipopt::IpoptApplication> app = IpoptApplicationFactory();
     // Set options.
@@ -187,6 +244,20 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
         ipoptions->SetStringValue("hessian_approximation", value);
     }
 
+    if (get_automatic_scaling()) {
+        ipoptions->SetStringValue("nlp_scaling_method", "user-scaling");
+    }
+
+    if (warm_start) {
+        // Without lowering the barrier parameter and the push away from the
+        // bounds, IPOPT would move the warm start away from the previous
+        // solution.
+        ipoptions->SetStringValue("warm_start_init_point", "yes");
+        ipoptions->SetNumericValue("warm_start_bound_push", 1e-6);
+        ipoptions->SetNumericValue("warm_start_mult_bound_push", 1e-6);
+        ipoptions->SetNumericValue("mu_init", 1e-6);
+    }
+
     // Set advanced options.
     for (const auto& option : get_advanced_options_string()) {
         if (option.second) {
@@ -230,19 +301,49 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
 
     // Create NLP.
     // -----------
-    Ipopt::SmartPtr<TNLP> nlp = new TNLP(*m_problem.get());
+    Ipopt::SmartPtr<TNLP> nlp = new TNLP(*this, *m_problem.get());
     // TODO avoid copying x (initial guess).
     // Determine sparsity pattern of Jacobian, Hessian, etc.
     SparsityCoordinates jacobian_sparsity;
     SparsityCoordinates hessian_sparsity;
     calc_sparsity(guess, jacobian_sparsity,
             need_exact_hessian, hessian_sparsity);
+    if (m_problem->get_jacobian_is_constant()) {
+        // IPOPT then evaluates the Jacobian only once. Respect any value
+        // the user set through the advanced options.
+        std::string jac_constant;
+        if (!ipoptions->GetStringValue("jac_c_constant", jac_constant, "")) {
+            ipoptions->SetStringValue("jac_c_constant", "yes");
+        }
+        if (!ipoptions->GetStringValue("jac_d_constant", jac_constant, "")) {
+            ipoptions->SetStringValue("jac_d_constant", "yes");
+        }
+    }
+    std::string scaling_method;
+    if (ipoptions->GetStringValue("nlp_scaling_method", scaling_method, "")
+            && scaling_method == "user-scaling") {
+        double objective_scaling;
+        VectorXd variable_scaling;
+        VectorXd constraint_scaling;
+        m_problem->calc_automatic_scaling(guess, jacobian_sparsity,
+                objective_scaling, variable_scaling, constraint_scaling);
+        nlp->set_scaling(objective_scaling, std::move(variable_scaling),
+                std::move(constraint_scaling));
+    }
     nlp->initialize(guess, std::move(jacobian_sparsity),
             std::move(hessian_sparsity));
+    if (warm_start) {
+        nlp->set_initial_multipliers(
+                guess_solution.variable_lower_multipliers,
+                guess_solution.variable_upper_multipliers,
+                guess_solution.constraint_multipliers);
+    }
 
     // Optimize!!!
     // -----------
+    begin_iteration_monitoring();
     status = app->OptimizeTNLP(nlp);
+    end_iteration_monitoring();
     Solution solution;
     solution.variables = nlp->get_solution();
     solution.objective = nlp->get_optimal_objective_value();
@@ -258,11 +359,17 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
     }
     solution.status = convert_IPOPT_ApplicationReturnStatus_to_string(status);
     solution.num_iterations = nlp->get_num_iterations();
+    solution.variable_lower_multipliers =
+            nlp->get_variable_lower_multipliers();
+    solution.variable_upper_multipliers =
+            nlp->get_variable_upper_multipliers();
+    solution.constraint_multipliers = nlp->get_constraint_multipliers();
     return solution;
 }
 
-IPOPTSolver::TNLP::TNLP(const ProblemDecorator& problem)
-        : m_problem(problem)
+IPOPTSolver::TNLP::TNLP(const IPOPTSolver& solver,
+        const ProblemDecorator& problem)
+        : m_problem(problem), m_solver(solver)
 {
     m_num_variables = m_problem.get_num_variables();
     m_num_constraints = m_problem.get_num_constraints();
@@ -301,6 +408,55 @@ void IPOPTSolver::TNLP::initialize(const VectorXd& guess,
 
     m_jacobian_num_nonzeros = (unsigned)m_jacobian_sparsity.row.size();
     m_hessian_num_nonzeros = (unsigned)m_hessian_sparsity.row.size();
+
+    m_iteration_info = IterationInfo();
+    m_start_time = ScopedTimer::Clock::now();
+}
+
+void IPOPTSolver::TNLP::set_initial_multipliers(
+        VectorXd variable_lower_multipliers,
+        VectorXd variable_upper_multipliers,
+        VectorXd constraint_multipliers) {
+    assert(variable_lower_multipliers.size() == m_num_variables);
+    assert(variable_upper_multipliers.size() == m_num_variables);
+    assert(constraint_multipliers.size() == m_num_constraints);
+    m_initial_variable_lower_multipliers =
+            std::move(variable_lower_multipliers);
+    m_initial_variable_upper_multipliers =
+            std::move(variable_upper_multipliers);
+    m_initial_constraint_multipliers = std::move(constraint_multipliers);
+}
+
+void IPOPTSolver::TNLP::set_scaling(double objective_scaling,
+        VectorXd variable_scaling, VectorXd constraint_scaling) {
+    assert(variable_scaling.size() == m_num_variables);
+    assert(constraint_scaling.size() == m_num_constraints);
+    m_objective_scaling = objective_scaling;
+    m_variable_scaling = std::move(variable_scaling);
+    m_constraint_scaling = std::move(constraint_scaling);
+}
+
+bool IPOPTSolver::TNLP::get_scaling_parameters(Number& obj_scaling,
+        bool& use_x_scaling, Index num_variables, Number* x_scaling,
+        bool& use_g_scaling, Index num_constraints, Number* g_scaling) {
+    // IPOPT only calls this function if nlp_scaling_method is
+    // "user-scaling".
+    obj_scaling = m_objective_scaling;
+    use_x_scaling = m_variable_scaling.size() != 0;
+    if (use_x_scaling) {
+        assert((unsigned)num_variables == m_num_variables);
+        for (Index ivar = 0; ivar < num_variables; ++ivar) {
+            x_scaling[ivar] = m_variable_scaling[ivar];
+        }
+    }
+    use_g_scaling = m_constraint_scaling.size() != 0;
+    if (use_g_scaling) {
+        assert((unsigned)num_constraints == m_num_constraints);
+        for (Index icon = 0; icon < num_constraints; ++icon) {
+            g_scaling[icon] = m_constraint_scaling[icon];
+        }
+    }
+    return true;
 }
 
 bool IPOPTSolver::TNLP::get_bounds_info(
@@ -350,20 +506,35 @@ bool IPOPTSolver::TNLP::get_bounds_info(
 }
 
 // z: multipliers for bound constraints on x.
-// warmstart will require giving initial values for the multipliers.
+// IPOPT only asks for z and lambda if warm_start_init_point is "yes".
 bool IPOPTSolver::TNLP::get_starting_point(
         Index num_variables, bool init_x, Number* x,
-        bool init_z, Number* /*z_L*/, Number* /*z_U*/,
+        bool init_z, Number* z_L, Number* z_U,
         Index num_constraints, bool init_lambda,
-        Number* /*lambda*/) {
+        Number* lambda) {
     // Must this method provide initial values for x, z, lambda?
     assert(init_x == true);
-    assert(init_z == false);
-    assert(init_lambda == false);
     assert((unsigned)num_constraints == m_num_constraints);
     for (Index ivar = 0; ivar < num_variables; ++ivar) {
         x[ivar] = m_initial_guess[ivar];
     }
+    // If warm_start_init_point was set (e.g., through the advanced options)
+    // without providing multipliers, we start the multipliers at 0.
+    if (init_z) {
+        const bool provided = m_initial_variable_lower_multipliers.size() != 0;
+        for (Index ivar = 0; ivar < num_variables; ++ivar) {
+            z_L[ivar] = provided ?
+                    m_initial_variable_lower_multipliers[ivar] : 0;
+            z_U[ivar] = provided ?
+                    m_initial_variable_upper_multipliers[ivar] : 0;
+        }
+    }
+    if (init_lambda) {
+        const bool provided = m_initial_constraint_multipliers.size() != 0;
+        for (Index icon = 0; icon < num_constraints; ++icon) {
+            lambda[icon] = provided ? m_initial_constraint_multipliers[icon] : 0;
+        }
+    }
     return true;
 }
 
@@ -371,6 +542,7 @@ bool IPOPTSolver::TNLP::eval_f(
         Index num_variables, const Number* x, bool new_x,
         Number& obj_value) {
     assert((unsigned)num_variables == m_num_variables);
+    ScopedTimer timer(m_iteration_info.objective_time);
     m_problem.calc_objective(num_variables, x, new_x, obj_value);
     return true;
 }
@@ -379,6 +551,7 @@ bool IPOPTSolver::TNLP::eval_grad_f(
         Index num_variables, const Number* x, bool new_x,
         Number* grad_f) {
     assert((unsigned)num_variables == m_num_variables);
+    ScopedTimer timer(m_iteration_info.gradient_time);
     m_problem.calc_gradient(num_variables, x, new_x, grad_f);
     return true;
 }
@@ -389,6 +562,7 @@ bool IPOPTSolver::TNLP::eval_g(
     assert((unsigned)num_variables   == m_num_variables);
     assert((unsigned)num_constraints == m_num_constraints);
     //// TODO if (!num_constraints) return true;
+    ScopedTimer timer(m_iteration_info.constraints_time);
     m_problem.calc_constraints(num_variables, x, new_x, num_constraints, g);
     return true;
 }
@@ -410,6 +584,7 @@ bool IPOPTSolver::TNLP::eval_jac_g(
         return true;
     }
 
+    ScopedTimer timer(m_iteration_info.jacobian_time);
     m_problem.calc_jacobian(num_variables, x, new_x, num_nonzeros_jacobian,
             values);
     return true;
@@ -431,18 +606,43 @@ bool IPOPTSolver::TNLP::eval_h(
 
     // TODO use obj_factor here to determine what computation to do exactly.
 
+    ScopedTimer timer(m_iteration_info.hessian_time);
     m_problem.calc_hessian_lagrangian(num_variables, x, new_x, obj_factor,
             num_constraints, lambda, new_lambda,
             num_nonzeros_hessian, values);
     return true;
 }
 
+bool IPOPTSolver::TNLP::intermediate_callback(Ipopt::AlgorithmMode mode,
+        Index iter, Number obj_value, Number inf_pr, Number inf_du,
+        Number mu, Number d_norm, Number regularization_size,
+        Number alpha_du, Number alpha_pr, Index ls_trials,
+        const Ipopt::IpoptData* /*ip_data*/,
+        Ipopt::IpoptCalculatedQuantities* /*ip_cq*/) {
+    auto& info = m_iteration_info;
+    info.iteration = iter;
+    info.restoration_phase = mode == Ipopt::RestorationPhaseMode;
+    info.objective = obj_value;
+    info.primal_infeasibility = inf_pr;
+    info.dual_infeasibility = inf_du;
+    info.barrier_parameter = mu;
+    info.step_norm = d_norm;
+    info.regularization = regularization_size;
+    info.primal_step_size = alpha_pr;
+    info.dual_step_size = alpha_du;
+    info.num_line_search_trials = ls_trials;
+    info.elapsed_time = std::chrono::duration<double>(
+            ScopedTimer::Clock::now() - m_start_time).count();
+    // Returning false causes IPOPT to stop with User_Requested_Stop.
+    return m_solver.monitor_iteration(info);
+}
+
 void IPOPTSolver::TNLP::finalize_solution(Ipopt::SolverReturn /*status*/,
                                           Index num_variables,
                                           const Number* x,
-                                          const Number* /*z_L*/, const Number* /*z_U*/,
-                                          Index /*num_constraints*/,
-                                          const Number* /*g*/, const Number* /*lambda*/,
+                                          const Number* z_L, const Number* z_U,
+                                          Index num_constraints,
+                                          const Number* /*g*/, const Number* lambda,
                                           Number obj_value,
                                           const Ipopt::IpoptData* ip_data,
                                           Ipopt::IpoptCalculatedQuantities* /*ip_cq*/)
@@ -455,16 +655,16 @@ void IPOPTSolver::TNLP::finalize_solution(Ipopt::SolverReturn /*status*/,
     }
     m_optimal_obj_value = obj_value;
     m_num_iterations = ip_data->iter_count();
-    //printf("\nSolution of the bound multipliers, z_L and z_U\n");
-    //for (Index i = 0; i < num_variables; ++i) {
-    //    printf("z_L[%d] = %e\n", i, z_L[i]);
-    //}
-    //for (Index i = 0; i < num_variables; ++i) {
-    //    printf("z_U[%d] = %e\n", i, z_U[i]);
-    //}
+    // Keep the multipliers so that the solution can be used to warm start
+    // another optimization.
+    m_variable_lower_multipliers =
+            Eigen::Map<const VectorXd>(z_L, num_variables);
+    m_variable_upper_multipliers =
+            Eigen::Map<const VectorXd>(z_U, num_variables);
+    m_constraint_multipliers =
+            Eigen::Map<const VectorXd>(lambda, num_constraints);
     //printf("\nObjective value\n");
     //printf("f(x*) = %e\n", obj_value);
-    // TODO also implement Ipopt's intermediate_() function.
 }
 
 
@@ -37,6 +37,17 @@ namespace optimization {
 /// If you need more fine-grained control, you can use
 /// OptimizationSolver::set_advanced_option_real().
 ///
+/// Warm starts
+/// ===========
+/// If the guess passed to Solver::optimize(const Solution&) contains
+/// multipliers, they are used to initialize IPOPT's bound multipliers (z_L,
+/// z_U) and constraint multipliers (lambda). This sets the following IPOPT
+/// options, which you can override with the advanced options:
+///   - warm_start_init_point: yes
+///   - warm_start_bound_push: 1e-6
+///   - warm_start_mult_bound_push: 1e-6
+///   - mu_init: 1e-6
+///
 /// @ingroup optimization
 class IPOPTSolver : public Solver {
 public:
@@ -48,6 +59,7 @@ public:
     static void print_available_options();
 protected:
     Solution optimize_impl(const Eigen::VectorXd& guess) const override;
+    Solution optimize_warm_start_impl(const Solution& guess) const override;
     void get_available_options(
             std::vector<std::string>&, std::vector<std::string>&,
             std::vector<std::string>&) const override;
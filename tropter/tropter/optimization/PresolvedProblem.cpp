@@ -0,0 +1,262 @@
+// ----------------------------------------------------------------------------
+// tropter: PresolvedProblem.cpp
+// ----------------------------------------------------------------------------
+// Copyright (c) 2017 tropter authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may
+// not use this file except in compliance with the License. You may obtain a
+// copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#include "PresolvedProblem.h"
+#include "ProblemDecorator_double.h"
+#include "ProblemDecorator_adouble.h"
+#include <tropter/SparsityPattern.h>
+#include <tropter/Exception.hpp>
+
+using Eigen::VectorXd;
+
+namespace tropter {
+namespace optimization {
+
+template<typename T>
+PresolvedProblem<T>::PresolvedProblem(const Problem<T>& problem,
+        bool remove_fixed_variables) : m_problem(problem) {
+    update(remove_fixed_variables);
+}
+
+template<typename T>
+void PresolvedProblem<T>::update(bool remove_fixed_variables) {
+    m_problem.validate();
+    m_remove_fixed_variables = remove_fixed_variables;
+    const auto& lower = m_problem.get_variable_lower_bounds();
+    const auto& upper = m_problem.get_variable_upper_bounds();
+    const int num_original = (int)m_problem.get_num_variables();
+
+    m_free_indices.clear();
+    m_reduced_indices.assign(num_original, -1);
+    for (int i = 0; i < num_original; ++i) {
+        if (!remove_fixed_variables || lower[i] != upper[i]) {
+            m_reduced_indices[i] = (int)m_free_indices.size();
+            m_free_indices.push_back(i);
+        }
+    }
+    const int num_free = (int)m_free_indices.size();
+
+    this->set_num_variables(num_free);
+    VectorXd reduced_lower(num_free);
+    VectorXd reduced_upper(num_free);
+    for (int i = 0; i < num_free; ++i) {
+        reduced_lower[i] = lower[m_free_indices[i]];
+        reduced_upper[i] = upper[m_free_indices[i]];
+    }
+    this->set_variable_bounds(reduced_lower, reduced_upper);
+
+    this->set_num_constraints(m_problem.get_num_constraints());
+    this->set_constraint_bounds(m_problem.get_constraint_lower_bounds(),
+            m_problem.get_constraint_upper_bounds());
+    this->set_use_supplied_sparsity_hessian_lagrangian(
+            m_problem.get_use_supplied_sparsity_hessian_lagrangian());
+
+    // The fixed variables never change, so we set them once here.
+    m_original_variables = lower.template cast<T>();
+}
+
+template<typename T>
+VectorXd PresolvedProblem<T>::reduce_variables(
+        const VectorXd& original) const {
+    TROPTER_THROW_IF(original.size() != m_problem.get_num_variables(),
+            "Expected %i variables, but got %i.",
+            m_problem.get_num_variables(), original.size());
+    VectorXd reduced(m_free_indices.size());
+    for (int i = 0; i < (int)m_free_indices.size(); ++i) {
+        reduced[i] = original[m_free_indices[i]];
+    }
+    return reduced;
+}
+
+template<typename T>
+VectorXd PresolvedProblem<T>::expand_variables(const VectorXd& reduced) const {
+    TROPTER_THROW_IF(reduced.size() != this->get_num_variables(),
+            "Expected %i variables, but got %i.",
+            this->get_num_variables(), reduced.size());
+    // Fixed variables take the value of their (equal) bounds.
+    VectorXd original = m_problem.get_variable_lower_bounds();
+    for (int i = 0; i < (int)m_free_indices.size(); ++i) {
+        original[m_free_indices[i]] = reduced[i];
+    }
+    return original;
+}
+
+template<typename T>
+VectorXd PresolvedProblem<T>::expand_bound_multipliers(
+        const VectorXd& reduced) const {
+    TROPTER_THROW_IF(reduced.size() != this->get_num_variables(),
+            "Expected %i multipliers, but got %i.",
+            this->get_num_variables(), reduced.size());
+    VectorXd original = VectorXd::Zero(m_problem.get_num_variables());
+    for (int i = 0; i < (int)m_free_indices.size(); ++i) {
+        original[m_free_indices[i]] = reduced[i];
+    }
+    return original;
+}
+
+template<typename T>
+void PresolvedProblem<T>::expand_variables_into_workspace(
+        const VectorX<T>& variables) const {
+    for (int i = 0; i < (int)m_free_indices.size(); ++i) {
+        m_original_variables[m_free_indices[i]] = variables[i];
+    }
+}
+
+template<typename T>
+void PresolvedProblem<T>::calc_objective(const VectorX<T>& variables,
+        T& obj_value) const {
+    if (!m_remove_fixed_variables) {
+        m_problem.calc_objective(variables, obj_value);
+        return;
+    }
+    expand_variables_into_workspace(variables);
+    m_problem.calc_objective(m_original_variables, obj_value);
+}
+
+template<typename T>
+void PresolvedProblem<T>::calc_constraints(const VectorX<T>& variables,
+        Eigen::Ref<VectorX<T>> constr) const {
+    if (!m_remove_fixed_variables) {
+        m_problem.calc_constraints(variables, constr);
+        return;
+    }
+    expand_variables_into_workspace(variables);
+    m_problem.calc_constraints(m_original_variables, constr);
+}
+
+template<typename T>
+bool PresolvedProblem<T>::calc_gradient(const VectorX<T>& variables,
+        VectorX<T>& gradient) const {
+    if (!m_remove_fixed_variables) {
+        return m_problem.calc_gradient(variables, gradient);
+    }
+    expand_variables_into_workspace(variables);
+    m_original_gradient.setZero(m_problem.get_num_variables());
+    if (!m_problem.calc_gradient(m_original_variables, m_original_gradient)) {
+        return false;
+    }
+    for (int i = 0; i < (int)m_free_indices.size(); ++i) {
+        gradient[i] = m_original_gradient[m_free_indices[i]];
+    }
+    return true;
+}
+
+template<typename T>
+bool PresolvedProblem<T>::calc_jacobian(const VectorX<T>& variables,
+        std::vector<Eigen::Triplet<T>>& jacobian) const {
+    if (!m_remove_fixed_variables) {
+        return m_problem.calc_jacobian(variables, jacobian);
+    }
+    expand_variables_into_workspace(variables);
+    m_original_jacobian.clear();
+    if (!m_problem.calc_jacobian(m_original_variables, m_original_jacobian)) {
+        return false;
+    }
+    for (const auto& entry : m_original_jacobian) {
+        const int reduced_col = m_reduced_indices[entry.col()];
+        if (reduced_col != -1) {
+            jacobian.emplace_back(entry.row(), reduced_col, entry.value());
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void PresolvedProblem<T>::calc_sparsity_hessian_lagrangian(
+        const VectorXd& x,
+        SymmetricSparsityPattern& hescon_sparsity,
+        SymmetricSparsityPattern& hesobj_sparsity) const {
+    const int num_original = (int)m_problem.get_num_variables();
+    SymmetricSparsityPattern original_hescon(num_original);
+    SymmetricSparsityPattern original_hesobj(num_original);
+    m_problem.calc_sparsity_hessian_lagrangian(expand_variables(x),
+            original_hescon, original_hesobj);
+
+    // Keep only the rows and columns for free variables. Since we preserve
+    // the order of the free variables, the upper triangle maps onto the
+    // upper triangle.
+    auto reduce = [this](const SymmetricSparsityPattern& original,
+            SymmetricSparsityPattern& reduced) {
+        const auto rows = original.convert_to_CompressedRowSparsity();
+        for (int irow = 0; irow < (int)rows.size(); ++irow) {
+            const int ired_row = m_reduced_indices[irow];
+            if (ired_row == -1) continue;
+            for (const auto& icol : rows[irow]) {
+                const int ired_col = m_reduced_indices[icol];
+                if (ired_col == -1) continue;
+                reduced.set_nonzero(ired_row, ired_col);
+            }
+        }
+    };
+    reduce(original_hescon, hescon_sparsity);
+    reduce(original_hesobj, hesobj_sparsity);
+}
+
+template<typename T>
+bool PresolvedProblem<T>::calc_sparsity_gradient(const VectorXd& x,
+        std::vector<unsigned int>& nonzero_indices) const {
+    std::vector<unsigned int> original_indices;
+    if (!m_problem.calc_sparsity_gradient(expand_variables(x),
+            original_indices)) {
+        return false;
+    }
+    for (const auto& index : original_indices) {
+        TROPTER_THROW_IF(index >= m_reduced_indices.size(),
+                "Expected gradient nonzero index to be in [0, %i), but "
+                "it's %i.", (int)m_reduced_indices.size(), index);
+        const int reduced_index = m_reduced_indices[index];
+        if (reduced_index != -1) nonzero_indices.push_back(reduced_index);
+    }
+    return true;
+}
+
+template<typename T>
+bool PresolvedProblem<T>::calc_sparsity_constant_jacobian(const VectorXd& x,
+        SparsityPattern& constant_sparsity) const {
+    SparsityPattern original_sparsity(
+            (int)m_problem.get_num_constraints(),
+            (int)m_problem.get_num_variables());
+    if (!m_problem.calc_sparsity_constant_jacobian(expand_variables(x),
+            original_sparsity)) {
+        return false;
+    }
+    const auto rows = original_sparsity.convert_to_CompressedRowSparsity();
+    for (int irow = 0; irow < (int)rows.size(); ++irow) {
+        for (const auto& icol : rows[irow]) {
+            const int ired_col = m_reduced_indices[icol];
+            if (ired_col != -1) constant_sparsity.set_nonzero(irow, ired_col);
+        }
+    }
+    return true;
+}
+
+template<typename T>
+std::vector<std::string> PresolvedProblem<T>::get_variable_names() const {
+    const auto original_names = m_problem.get_variable_names();
+    if (original_names.empty()) return original_names;
+    std::vector<std::string> names;
+    names.reserve(m_free_indices.size());
+    for (const auto& index : m_free_indices) {
+        names.push_back(original_names[index]);
+    }
+    return names;
+}
+
+// Explicit instantiation.
+template class PresolvedProblem<double>;
+template class PresolvedProblem<adouble>;
+
+} // namespace optimization
+} // namespace tropter
@@ -0,0 +1,126 @@
+#ifndef TROPTER_OPTIMIZATION_PRESOLVEDPROBLEM_H
+#define TROPTER_OPTIMIZATION_PRESOLVEDPROBLEM_H
+// ----------------------------------------------------------------------------
+// tropter: PresolvedProblem.h
+// ----------------------------------------------------------------------------
+// Copyright (c) 2017 tropter authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may
+// not use this file except in compliance with the License. You may obtain a
+// copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "Problem.h"
+
+namespace tropter {
+namespace optimization {
+
+/// This class wraps another Problem and removes the variables whose lower
+/// and upper bounds are equal ("fixed" variables; e.g., initial states that
+/// are pinned to a single value). The fixed variables are substituted as
+/// constants when evaluating the objective and constraints of the original
+/// problem, so the gradient, Jacobian, and Hessian (and their sparsity
+/// patterns) only have columns for the free variables; with finite
+/// differences, this also reduces the number of perturbations.
+///
+/// The constraints are not modified, so the constraint multipliers of the
+/// presolved problem are the same as those of the original problem.
+/// Use expand_variables() to obtain the variables of the original problem
+/// from those of this problem.
+///
+/// The original problem must outlive this object. Call update() if the
+/// bounds of the original problem change. This class keeps working memory
+/// for the variables of the original problem, so it is not reentrant: do not
+/// evaluate the same object from multiple threads at once.
+/// @ingroup optimization
+template<typename T>
+class PresolvedProblem : public Problem<T> {
+public:
+    /// This calls update() with the given `remove_fixed_variables`.
+    explicit PresolvedProblem(const Problem<T>& problem,
+            bool remove_fixed_variables = true);
+
+    /// Detect fixed variables in the original problem, and update the number
+    /// of variables, the bounds, etc. of this problem. If
+    /// `remove_fixed_variables` is false, then no variables are removed and
+    /// this problem simply forwards to the original problem.
+    void update(bool remove_fixed_variables = true);
+
+    /// The number of variables of the original problem removed from this
+    /// problem.
+    int get_num_fixed_variables() const
+    {   return (int)(m_problem.get_num_variables() -
+                this->get_num_variables()); }
+
+    /// Create a vector of variables for this problem by removing the fixed
+    /// variables from a vector of variables for the original problem.
+    Eigen::VectorXd reduce_variables(const Eigen::VectorXd& original) const;
+    /// Create a vector of variables for the original problem from a vector
+    /// of variables for this problem. The fixed variables take the value of
+    /// their bounds.
+    Eigen::VectorXd expand_variables(const Eigen::VectorXd& reduced) const;
+    /// Create a vector of bound multipliers for the original problem from
+    /// bound multipliers for this problem. The multipliers for the fixed
+    /// variables are 0. Use reduce_variables() for the opposite conversion.
+    Eigen::VectorXd expand_bound_multipliers(
+            const Eigen::VectorXd& reduced) const;
+
+    void calc_objective(const VectorX<T>& variables,
+            T& obj_value) const override;
+    void calc_constraints(const VectorX<T>& variables,
+            Eigen::Ref<VectorX<T>> constr) const override;
+    /// The gradient of the original problem (if it provides one), without
+    /// the entries for the fixed variables.
+    bool calc_gradient(const VectorX<T>& variables,
+            VectorX<T>& gradient) const override;
+    /// The Jacobian of the original problem (if it provides one), without
+    /// the columns for the fixed variables.
+    bool calc_jacobian(const VectorX<T>& variables,
+            std::vector<Eigen::Triplet<T>>& jacobian) const override;
+    /// The sparsity pattern of the original problem, without the rows and
+    /// columns for the fixed variables.
+    void calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
+            SymmetricSparsityPattern& hescon_sparsity,
+            SymmetricSparsityPattern& hesobj_sparsity) const override;
+    /// The gradient sparsity of the original problem (if it provides one),
+    /// without the fixed variables.
+    bool calc_sparsity_gradient(const Eigen::VectorXd& x,
+            std::vector<unsigned int>& nonzero_indices) const override;
+    /// The constant Jacobian entries of the original problem (if it
+    /// provides them), without the columns for the fixed variables.
+    bool calc_sparsity_constant_jacobian(const Eigen::VectorXd& x,
+            SparsityPattern& constant_sparsity) const override;
+
+    std::vector<std::string> get_variable_names() const override;
+    std::vector<std::string> get_constraint_names() const override
+    {   return m_problem.get_constraint_names(); }
+
+private:
+    /// Copy the variables of this problem into m_original_variables.
+    void expand_variables_into_workspace(const VectorX<T>& variables) const;
+
+    const Problem<T>& m_problem;
+    bool m_remove_fixed_variables = true;
+    // The index in the original problem of each variable in this problem.
+    std::vector<int> m_free_indices;
+    // The index in this problem of each variable in the original problem,
+    // or -1 if the variable is fixed.
+    std::vector<int> m_reduced_indices;
+
+    // Working memory (which makes this class non-reentrant). The fixed
+    // variables hold their fixed value.
+    mutable VectorX<T> m_original_variables;
+    mutable VectorX<T> m_original_gradient;
+    mutable std::vector<Eigen::Triplet<T>> m_original_jacobian;
+};
+
+} // namespace optimization
+} // namespace tropter
+
+#endif // TROPTER_OPTIMIZATION_PRESOLVEDPROBLEM_H
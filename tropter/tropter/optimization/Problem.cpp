@@ -15,11 +15,43 @@
 // ----------------------------------------------------------------------------
 #include "ProblemDecorator_double.h"
 #include "ProblemDecorator_adouble.h"
+#include <tropter/SparsityPattern.h>
 #include <tropter/Exception.hpp>
 
+#include <iomanip>
+
+using Eigen::VectorXd;
+
 namespace tropter {
 namespace optimization {
 
+void EvaluationStatistics::print(std::ostream& stream) const {
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+    stream << "[tropter] Evaluation statistics:\n"
+           << "  " << std::left << std::setw(20) << "function"
+           << std::right << std::setw(10) << "calls"
+           << std::setw(14) << "time (s)" << "\n";
+    stream << std::fixed << std::setprecision(4);
+    auto row = [&stream](const std::string& name, int count, double time) {
+        stream << "  " << std::left << std::setw(20) << name << std::right;
+        if (count >= 0) stream << std::setw(10) << count;
+        else            stream << std::setw(10) << "";
+        stream << std::setw(14) << time << "\n";
+    };
+    row("objective", num_objective_evals, objective_time);
+    row("gradient", num_gradient_evals, gradient_time);
+    row("constraints", num_constraints_evals, constraints_time);
+    row("jacobian", num_jacobian_evals, jacobian_time);
+    row("hessian", num_hessian_evals, hessian_time);
+    row("sparsity detection", -1, sparsity_detection_time);
+    row("  coloring", -1, coloring_time);
+    row("recovery", -1, recovery_time);
+    stream.flags(flags);
+    stream.precision(precision);
+    stream << std::flush;
+}
+
 void ProblemDecorator::set_verbosity(int verbosity) {
     TROPTER_VALUECHECK(verbosity == 0 || verbosity == 1,
             "verbosity", verbosity, "0 or 1");
@@ -38,6 +70,68 @@ void ProblemDecorator::set_findiff_hessian_mode(std::string value) {
     m_findiff_hessian_mode = std::move(value);
 }
 
+void ProblemDecorator::set_findiff_jacobian_constant_detection(bool value) {
+    m_findiff_jacobian_constant_detection = value;
+}
+
+void ProblemDecorator::calc_automatic_scaling(const VectorXd& x,
+        const SparsityCoordinates& jacobian_sparsity,
+        double& objective_scaling,
+        VectorXd& variable_scaling,
+        VectorXd& constraint_scaling) const {
+    const double min_scaling = 1e-8;
+    const double max_scaling = 1e8;
+    auto clamp = [&](double value) {
+        return std::min(std::max(value, min_scaling), max_scaling);
+    };
+    const unsigned num_variables = get_num_variables();
+    const unsigned num_constraints = get_num_constraints();
+    TROPTER_THROW_IF(x.size() != num_variables,
+            "Expected %i variables, but got %i.", num_variables, x.size());
+
+    // Variables.
+    // ----------
+    const auto& lower = get_variable_lower_bounds();
+    const auto& upper = get_variable_upper_bounds();
+    variable_scaling = VectorXd::Ones(num_variables);
+    for (unsigned ivar = 0; ivar < num_variables; ++ivar) {
+        const double width = upper[ivar] - lower[ivar];
+        if (std::isfinite(width) && width > 0) {
+            variable_scaling[ivar] = clamp(1.0 / width);
+        }
+    }
+
+    // Objective.
+    // ----------
+    // The derivative with respect to the scaled variable x_s = s * x is
+    // (df/dx) / s.
+    VectorXd gradient(num_variables);
+    calc_gradient(num_variables, x.data(), true, gradient.data());
+    const double max_gradient = gradient.size() ?
+            gradient.cwiseQuotient(variable_scaling).cwiseAbs().maxCoeff() : 0;
+    objective_scaling = max_gradient > 1 ? clamp(1.0 / max_gradient) : 1.0;
+
+    // Constraints.
+    // ------------
+    constraint_scaling = VectorXd::Ones(num_constraints);
+    const auto num_jacobian_nonzeros = (unsigned)jacobian_sparsity.row.size();
+    if (num_jacobian_nonzeros == 0) return;
+    VectorXd jacobian(num_jacobian_nonzeros);
+    calc_jacobian(num_variables, x.data(), false, num_jacobian_nonzeros,
+            jacobian.data());
+    VectorXd row_max = VectorXd::Zero(num_constraints);
+    for (unsigned inz = 0; inz < num_jacobian_nonzeros; ++inz) {
+        const auto& irow = jacobian_sparsity.row[inz];
+        const auto& icol = jacobian_sparsity.col[inz];
+        row_max[irow] = std::max(row_max[irow],
+                std::abs(jacobian[inz] / variable_scaling[icol]));
+    }
+    for (unsigned icon = 0; icon < num_constraints; ++icon) {
+        if (row_max[icon] > 0) constraint_scaling[icon] =
+                clamp(1.0 / row_max[icon]);
+    }
+}
+
 // Explicit instantiation.
 
 template class Problem<double>;
@@ -19,6 +19,7 @@
 #include <tropter/common.h>
 #include "AbstractProblem.h"
 #include "ProblemDecorator.h"
+#include <Eigen/SparseCore>
 #include <memory>
 
 namespace tropter {
@@ -64,6 +65,39 @@ public:
     virtual void calc_constraints(const VectorX<T>& variables,
             Eigen::Ref<VectorX<T>> constr) const;
 
+    /// Override this function to compute the gradient of the objective
+    /// function yourself (only used when the scalar type is double). Return
+    /// false (the default) to have the gradient computed with finite
+    /// differences instead. If you return true, the Hessian of the objective
+    /// is computed by finite differences of this gradient rather than of the
+    /// objective.
+    /// @param variables
+    ///     This holds the values of the variables at the current iteration of
+    ///     the optimization problem.
+    /// @param gradient
+    ///     Store the gradient in this vector, which has `num_variables`
+    ///     elements and is set to zero before this function is called.
+    virtual bool calc_gradient(const VectorX<T>& variables,
+            VectorX<T>& gradient) const;
+
+    /// Override this function to compute the Jacobian of the constraints
+    /// yourself (only used when the scalar type is double). Return false
+    /// (the default) to have the Jacobian computed with finite differences
+    /// instead. If you return true, the Hessian of the constraints is
+    /// computed by finite differences of this Jacobian (contracted with the
+    /// multipliers) rather than of the constraints. The sparsity pattern is
+    /// still detected from the constraint function; entries outside of
+    /// that pattern are ignored.
+    /// @param variables
+    ///     This holds the values of the variables at the current iteration of
+    ///     the optimization problem.
+    /// @param jacobian
+    ///     Append the (row, column, value) of the nonzero entries of the
+    ///     Jacobian to this vector, which is empty before this function is
+    ///     called. Values for duplicate entries are summed.
+    virtual bool calc_jacobian(const VectorX<T>& variables,
+            std::vector<Eigen::Triplet<T>>& jacobian) const;
+
     /// Create an interface to this problem that can provide the derivatives
     /// of the objective and constraint functions. This is for use by the
     /// optimization solver, but users might call this if they are interested
@@ -72,7 +106,6 @@ public:
             const override final;
 
     // TODO can override to provide custom derivatives.
-    //virtual void gradient(const std::vector<T>& x, std::vector<T>& grad) const;
     //virtual void jacobian(const std::vector<T>& x, TODO) const;
     //virtual void hessian() const;
 };
@@ -94,6 +127,17 @@ void Problem<T>::calc_constraints(const VectorX<T>&,
         Eigen::Ref<VectorX<T>>) const
 {}
 
+template<typename T>
+bool Problem<T>::calc_gradient(const VectorX<T>&, VectorX<T>&) const {
+    return false;
+}
+
+template<typename T>
+bool Problem<T>::calc_jacobian(const VectorX<T>&,
+        std::vector<Eigen::Triplet<T>>&) const {
+    return false;
+}
+
 /// We must specialize this template for each scalar type.
 /// @ingroup optimization
 template<typename T>
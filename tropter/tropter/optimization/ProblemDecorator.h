@@ -27,6 +27,34 @@ struct SparsityCoordinates;
 
 namespace optimization {
 
+/// The number of calls to, and the cumulative wall-clock time (in seconds)
+/// spent in, each of the functions that a ProblemDecorator provides to a
+/// solver. The sparsity detection time includes the time spent on graph
+/// coloring. The recovery time is the time spent recovering the nonzeros of
+/// the Jacobian and Hessian from compressed (seeded) evaluations, and is
+/// included in the Jacobian and Hessian times. Coloring and recovery are
+/// only timed separately with finite differences; with automatic
+/// differentiation, ADOL-C performs them within the sparsity detection and
+/// derivative times.
+/// @ingroup optimization
+struct EvaluationStatistics {
+    int num_objective_evals = 0;
+    int num_gradient_evals = 0;
+    int num_constraints_evals = 0;
+    int num_jacobian_evals = 0;
+    int num_hessian_evals = 0;
+    double objective_time = 0;
+    double gradient_time = 0;
+    double constraints_time = 0;
+    double jacobian_time = 0;
+    double hessian_time = 0;
+    double sparsity_detection_time = 0;
+    double coloring_time = 0;
+    double recovery_time = 0;
+    /// Print a table of the counts and times.
+    void print(std::ostream& stream = std::cout) const;
+};
+
 /// This class provides an interface of the OptimizationProblem to the
 /// OptimizationSolvers.
 /// In general, users do not use this class directly.
@@ -95,6 +123,31 @@ public:
             double obj_factor,
             unsigned num_constraints, const double* lambda, bool new_lambda,
             unsigned num_nonzeros, double* nonzeros) const = 0;
+    /// Compute scale factors for the objective, variables, and constraints
+    /// that a solver can apply internally (e.g., IPOPT's "user-scaling").
+    /// Each variable is scaled by the inverse of the width of its bounds
+    /// (or 1 if either bound is infinite or the bounds are equal). Each
+    /// constraint is scaled so that the largest element of its row of the
+    /// Jacobian (with respect to the scaled variables), evaluated at the
+    /// provided variables, has magnitude 1. The objective is scaled down if
+    /// its gradient (with respect to the scaled variables) is larger than 1.
+    /// All scale factors are clamped to [1e-8, 1e8].
+    /// You must call calc_sparsity() first, and provide the Jacobian
+    /// sparsity pattern it produced.
+    void calc_automatic_scaling(const Eigen::VectorXd& variables,
+            const SparsityCoordinates& jacobian_sparsity,
+            double& objective_scaling,
+            Eigen::VectorXd& variable_scaling,
+            Eigen::VectorXd& constraint_scaling) const;
+
+    /// The number of calls to, and time spent in, each function since the
+    /// last call to reset_statistics().
+    const EvaluationStatistics& get_statistics() const
+    {   return m_statistics; }
+    /// Set all counts and times to 0. Solvers call this at the start of each
+    /// optimization.
+    void reset_statistics() const { m_statistics = EvaluationStatistics(); }
+
     /// 0 for silent, 1 for verbose.
     void set_verbosity(int verbosity);
     /// @copydoc set_verbosity()
@@ -114,20 +167,49 @@ public:
     ///  - "slow": Slower mode to be used only for debugging. Each nonzero of
     ///    the Hessian of the Lagrangian is computed separately.
     void set_findiff_hessian_mode(std::string value);
+    /// Detect the entries of the Jacobian of the constraints that are
+    /// constant by comparing the Jacobian at the iterate provided to
+    /// calc_sparsity() with the Jacobian at a random iterate within the
+    /// bounds. Constant entries are computed once, and only the remaining
+    /// entries are perturbed when evaluating the Jacobian, which often
+    /// requires fewer seeds (default: false). Entries of piecewise functions
+    /// (e.g., contact) that happen to be equal at both iterates are wrongly
+    /// treated as constant, so only enable this if the constraints are
+    /// smooth. Constant entries that the problem declares (see
+    /// AbstractProblem::calc_sparsity_constant_jacobian()) are used
+    /// regardless of this setting.
+    void set_findiff_jacobian_constant_detection(bool value);
     /// @copydoc set_findiff_hessian_step_size()
     double get_findiff_hessian_step_size() const;
     /// @copydoc set_findiff_hessian_mode()
     const std::string& get_findiff_hessian_mode() const;
+    /// @copydoc set_findiff_jacobian_constant_detection()
+    bool get_findiff_jacobian_constant_detection() const;
     /// @}
 
+    /// Whether all entries of the Jacobian of the constraints are constant
+    /// (e.g., all constraints are linear), in which case solvers can skip
+    /// re-evaluating it. This is only valid after calling calc_sparsity(),
+    /// and is only ever true when using finite differences.
+    bool get_jacobian_is_constant() const { return m_jacobian_is_constant; }
+
 protected:
     template<typename ...Types>
     void print(const std::string& format_string, Types... args) const;
+    /// Derived classes update the counts and times in their implementations
+    /// of calc_objective(), etc.; use ScopedTimer for the times.
+    EvaluationStatistics& upd_statistics() const { return m_statistics; }
+    /// Derived classes set this in their implementations of calc_sparsity().
+    void set_jacobian_is_constant(bool value) const
+    {   m_jacobian_is_constant = value; }
 private:
     const AbstractProblem& m_problem;
+    mutable EvaluationStatistics m_statistics;
     int m_verbosity = 1;
     double m_findiff_hessian_step_size = 1e-5;
     std::string m_findiff_hessian_mode = "fast";
+    bool m_findiff_jacobian_constant_detection = false;
+    mutable bool m_jacobian_is_constant = false;
 };
 
 inline int ProblemDecorator::get_verbosity() const
@@ -136,6 +218,8 @@ inline double ProblemDecorator::get_findiff_hessian_step_size() const
 {   return m_findiff_hessian_step_size; }
 inline const std::string& ProblemDecorator::get_findiff_hessian_mode() const
 {   return m_findiff_hessian_mode; }
+inline bool ProblemDecorator::get_findiff_jacobian_constant_detection() const
+{   return m_findiff_jacobian_constant_detection; }
 template<typename ...Types>
 inline void ProblemDecorator::print(
         const std::string& format_string, Types... args) const {
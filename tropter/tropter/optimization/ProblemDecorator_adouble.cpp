@@ -16,6 +16,7 @@
 #include "ProblemDecorator_adouble.h"
 #include <tropter/SparsityPattern.h>
 #include <tropter/Exception.hpp>
+#include <tropter/utilities.h>
 
 #ifdef _MSC_VER
 // Ignore warnings from ADOL-C headers.
@@ -82,6 +83,7 @@ calc_sparsity(const Eigen::VectorXd& x,
         bool provide_hessian_sparsity,
         SparsityCoordinates& hessian_sparsity) const
 {
+    ScopedTimer timer(upd_statistics().sparsity_detection_time);
     const auto& num_variables = get_num_variables();
     assert(x.size() == num_variables);
     const auto& num_constraints = get_num_constraints();
@@ -183,6 +185,9 @@ calc_objective(unsigned num_variables, const double* x,
         bool /*new_x*/,
         double& obj_value) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_objective_evals;
+    ScopedTimer timer(stats.objective_time);
     int status = ::function(m_objective_tag,
             1, // number of dependent variables.
             num_variables, // number of independent variables.
@@ -201,6 +206,9 @@ calc_constraints(unsigned num_variables, const double* variables,
         bool /*new_variables*/,
         unsigned num_constraints, double* constr) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_constraints_evals;
+    ScopedTimer timer(stats.constraints_time);
     // Evaluate the constraints tape.
     int status = ::function(m_constraints_tag,
             num_constraints, // number of dependent variables.
@@ -216,6 +224,9 @@ void Problem<adouble>::Decorator::
 calc_gradient(unsigned num_variables, const double* x, bool /*new_x*/,
         double* grad) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_gradient_evals;
+    ScopedTimer timer(stats.gradient_time);
     int status = ::gradient(m_objective_tag, num_variables, x, grad);
     assert(status); // TODO error codes can be -2,-1,0,1,2,3; improve assert!
 }
@@ -224,6 +235,9 @@ void Problem<adouble>::Decorator::
 calc_jacobian(unsigned num_variables, const double* x, bool /*new_x*/,
         unsigned /*num_nonzeros*/, double* jacobian_values) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_jacobian_evals;
+    ScopedTimer timer(stats.jacobian_time);
     int repeated_call = 1; // We already have the sparsity structure.
     int status = ::sparse_jac(m_constraints_tag, get_num_constraints(),
             num_variables, repeated_call, x,
@@ -245,6 +259,9 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x,
         bool /*new_lambda TODO */,
         unsigned /*num_nonzeros*/, double* hessian_values) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_hessian_evals;
+    ScopedTimer timer(stats.hessian_time);
     // TODO if not new_x, then do NOT re-eval objective()!!!
 
     int repeated_call = 1;
@@ -15,8 +15,12 @@
 // ----------------------------------------------------------------------------
 #include "ProblemDecorator_double.h"
 #include <tropter/Exception.hpp>
+#include <tropter/utilities.h>
 #include "internal/GraphColoring.h"
 
+#include <algorithm>
+#include <map>
+
 //#if defined(TROPTER_WITH_OPENMP) && _OPENMP
 //    // TODO only include ifdef _OPENMP
 //    #include <omp.h>
@@ -60,24 +64,46 @@ calc_sparsity(const Eigen::VectorXd& variables,
         bool provide_hessian_sparsity,
         SparsityCoordinates& hessian_sparsity_coordinates) const
 {
+    ScopedTimer timer(upd_statistics().sparsity_detection_time);
     const auto num_vars = get_num_variables();
     m_x_working = VectorXd::Zero(num_vars);
 
     // Gradient.
     // =========
-    // Determine the indicies of the variables used in the objective function
-    // (conservative estimate of the indicies of the gradient that are nonzero).
-    std::function<double(const VectorXd&)> calc_objective =
-            [this](const VectorXd& vars) {
-                double obj_value = 0;
-                m_problem.calc_objective(vars, obj_value);
-                return obj_value;
-            };
-    SparsityPattern gradient_sparsity =
-            calc_gradient_sparsity_with_perturbation(variables,
-                    calc_objective);
-    m_gradient_nonzero_indices =
-            gradient_sparsity.convert_to_CompressedRowSparsity()[0];
+    // Determine the indicies of the variables used in the objective function,
+    // either from the problem or by perturbing each variable (conservative
+    // estimate of the indicies of the gradient that are nonzero).
+    m_gradient_nonzero_indices.clear();
+    if (m_problem.calc_sparsity_gradient(variables,
+            m_gradient_nonzero_indices)) {
+        // Sort and remove duplicates.
+        SparsityPattern gradient_sparsity(num_vars,
+                m_gradient_nonzero_indices);
+        m_gradient_nonzero_indices =
+                gradient_sparsity.convert_to_CompressedRowSparsity()[0];
+        print("Using the gradient sparsity provided by the problem "
+                "(%i nonzeros).", (int)m_gradient_nonzero_indices.size());
+    } else {
+        std::function<double(const VectorXd&)> calc_objective =
+                [this](const VectorXd& vars) {
+                    double obj_value = 0;
+                    m_problem.calc_objective(vars, obj_value);
+                    return obj_value;
+                };
+        SparsityPattern gradient_sparsity =
+                calc_gradient_sparsity_with_perturbation(variables,
+                        calc_objective);
+        m_gradient_nonzero_indices =
+                gradient_sparsity.convert_to_CompressedRowSparsity()[0];
+    }
+
+    // Determine if the problem computes the gradient itself.
+    m_gradient_working = VectorXd::Zero(num_vars);
+    m_problem_provides_gradient =
+            m_problem.calc_gradient(variables, m_gradient_working);
+    if (m_problem_provides_gradient) {
+        print("Using the gradient provided by the problem.");
+    }
 
     // Jacobian.
     // =========
@@ -98,7 +124,10 @@ calc_sparsity(const Eigen::VectorXd& variables,
             calc_jacobian_sparsity_with_perturbation(variables,
                     num_jac_rows, calc_constraints, constr_names, var_names);
 
-    m_jacobian_coloring.reset(new JacobianColoring(jacobian_sparsity));
+    {
+        ScopedTimer coloring_timer(upd_statistics().coloring_time);
+        m_jacobian_coloring.reset(new JacobianColoring(jacobian_sparsity));
+    }
     m_jacobian_coloring->get_coordinate_format(jacobian_sparsity_coordinates);
     int num_jacobian_seeds = (int)m_jacobian_coloring->get_seed_matrix().cols();
     print("Number of seeds for Jacobian: %i", num_jacobian_seeds);
@@ -109,6 +138,40 @@ calc_sparsity(const Eigen::VectorXd& variables,
     m_constr_neg.resize(num_jac_rows);
     m_jacobian_compressed.resize(num_jac_rows, num_jacobian_seeds);
 
+    // Determine if the problem computes the Jacobian itself.
+    m_jacobian_triplets.clear();
+    m_problem_provides_jacobian =
+            m_problem.calc_jacobian(variables, m_jacobian_triplets);
+    if (m_problem_provides_jacobian) {
+        m_jacobian_coordinates = jacobian_sparsity_coordinates;
+        print("Using the Jacobian provided by the problem.");
+    }
+
+    // Constant entries.
+    // -----------------
+    // These are only used if we compute the Jacobian with finite
+    // differences.
+    m_jacobian_variable_coloring.reset();
+    set_jacobian_is_constant(false);
+    const bool use_findiff_jacobian = !m_problem_provides_jacobian;
+    SparsityPattern constant_sparsity(num_jac_rows, num_vars);
+    if (use_findiff_jacobian && m_problem.calc_sparsity_constant_jacobian(
+            variables, constant_sparsity)) {
+        TROPTER_THROW_IF(
+                constant_sparsity.get_num_rows() != (int)num_jac_rows ||
+                constant_sparsity.get_num_cols() != (int)num_vars,
+                "Expected sparsity pattern of constant Jacobian entries to "
+                "have dimensions %i x %i, but it has dimensions %i x %i.",
+                num_jac_rows, num_vars, constant_sparsity.get_num_rows(),
+                constant_sparsity.get_num_cols());
+        calc_sparsity_constant_jacobian(variables,
+                jacobian_sparsity_coordinates, &constant_sparsity);
+    } else if (use_findiff_jacobian &&
+            get_findiff_jacobian_constant_detection()) {
+        calc_sparsity_constant_jacobian(variables,
+                jacobian_sparsity_coordinates, nullptr);
+    }
+
     // Hessian.
     // ========
     if (provide_hessian_sparsity) {
@@ -129,6 +192,121 @@ calc_sparsity(const Eigen::VectorXd& variables,
 }
 
 
+void Problem<double>::Decorator::
+calc_sparsity_constant_jacobian(const VectorXd& x,
+        const SparsityCoordinates& coords,
+        const SparsityPattern* declared_constant_sparsity) const {
+    const auto num_jac_rows = get_num_constraints();
+    const auto num_vars = get_num_variables();
+    const int num_nonzeros = (int)coords.row.size();
+
+    // The values of all entries at x.
+    const auto& seed = m_jacobian_coloring->get_seed_matrix();
+    calc_jacobian_compressed(x, seed, m_jacobian_compressed);
+    VectorXd values(num_nonzeros);
+    m_jacobian_coloring->recover(m_jacobian_compressed, values.data());
+
+    std::vector<bool> is_constant(num_nonzeros);
+    if (declared_constant_sparsity) {
+        const auto rows =
+                declared_constant_sparsity->convert_to_CompressedRowSparsity();
+        for (int inz = 0; inz < num_nonzeros; ++inz) {
+            const auto& row = rows[coords.row[inz]];
+            is_constant[inz] =
+                    std::binary_search(row.begin(), row.end(), coords.col[inz]);
+        }
+    } else {
+        // An entry is constant if it has the same value at a different
+        // iterate. Variables with an infinite bound are shifted from x.
+        VectorXd x_other = make_random_iterate_within_bounds();
+        for (Eigen::Index i = 0; i < x_other.size(); ++i) {
+            if (!std::isfinite(x_other[i])) x_other[i] = x[i] + 1.0;
+        }
+        calc_jacobian_compressed(x_other, seed, m_jacobian_compressed);
+        VectorXd values_other(num_nonzeros);
+        m_jacobian_coloring->recover(m_jacobian_compressed,
+                values_other.data());
+        for (int inz = 0; inz < num_nonzeros; ++inz) {
+            const double a = values[inz];
+            const double b = values_other[inz];
+            is_constant[inz] = std::abs(a - b) <=
+                    1e-6 * std::max({1.0, std::abs(a), std::abs(b)});
+        }
+    }
+
+    m_jacobian_constant_values = VectorXd::Zero(num_nonzeros);
+    std::vector<Eigen::Triplet<double>> constant_triplets;
+    std::vector<unsigned int> variable_rows;
+    std::vector<unsigned int> variable_cols;
+    for (int inz = 0; inz < num_nonzeros; ++inz) {
+        if (is_constant[inz]) {
+            m_jacobian_constant_values[inz] = values[inz];
+            constant_triplets.emplace_back(coords.row[inz], coords.col[inz],
+                    values[inz]);
+        } else {
+            variable_rows.push_back(coords.row[inz]);
+            variable_cols.push_back(coords.col[inz]);
+        }
+    }
+    const int num_constant = (int)constant_triplets.size();
+    print("Number of constant entries in the Jacobian: %i of %i",
+            num_constant, num_nonzeros);
+    if (num_constant == 0) return;
+    if (variable_rows.empty()) {
+        set_jacobian_is_constant(true);
+        return;
+    }
+
+    {
+        ScopedTimer coloring_timer(upd_statistics().coloring_time);
+        m_jacobian_variable_coloring.reset(new JacobianColoring(
+                SparsityPattern(num_jac_rows, num_vars, variable_rows,
+                        variable_cols)));
+    }
+
+    // Map the entries of the new coloring to the entries of the full
+    // Jacobian.
+    std::map<std::pair<unsigned int, unsigned int>, int> full_indices;
+    for (int inz = 0; inz < num_nonzeros; ++inz) {
+        if (!is_constant[inz]) {
+            full_indices[{coords.row[inz], coords.col[inz]}] = inz;
+        }
+    }
+    SparsityCoordinates variable_coords;
+    m_jacobian_variable_coloring->get_coordinate_format(variable_coords);
+    const auto num_variable_nonzeros = variable_coords.row.size();
+    m_jacobian_variable_indices.resize(num_variable_nonzeros);
+    for (size_t inz = 0; inz < num_variable_nonzeros; ++inz) {
+        m_jacobian_variable_indices[inz] = full_indices.at(
+                {variable_coords.row[inz], variable_coords.col[inz]});
+    }
+    m_jacobian_variable_values.resize(num_variable_nonzeros);
+
+    // Perturbing variables that only appear in constant entries would only
+    // change the constant part of the compressed Jacobian.
+    m_jacobian_variable_seed = m_jacobian_variable_coloring->get_seed_matrix();
+    std::vector<bool> has_variable_entry(num_vars, false);
+    for (const auto& icol : variable_cols) has_variable_entry[icol] = true;
+    for (int ivar = 0; ivar < (int)num_vars; ++ivar) {
+        if (!has_variable_entry[ivar]) {
+            m_jacobian_variable_seed.row(ivar).setZero();
+        }
+    }
+    Eigen::SparseMatrix<double> constant_jacobian(num_jac_rows, num_vars);
+    constant_jacobian.setFromTriplets(constant_triplets.begin(),
+            constant_triplets.end());
+    m_jacobian_constant_compressed =
+            constant_jacobian * m_jacobian_variable_seed;
+    const auto num_seeds = m_jacobian_variable_seed.cols();
+    m_jacobian_compressed.resize(num_jac_rows, num_seeds);
+    int num_nonzero_seeds = 0;
+    for (Eigen::Index iseed = 0; iseed < num_seeds; ++iseed) {
+        if (!m_jacobian_variable_seed.col(iseed).isZero()) ++num_nonzero_seeds;
+    }
+    print("Number of seeds for variable entries of Jacobian: %i",
+            num_nonzero_seeds);
+}
+
 void Problem<double>::Decorator::
 calc_sparsity_hessian_lagrangian(const VectorXd& x,
         SparsityCoordinates& hessian_sparsity_coordinates) const {
@@ -176,17 +354,19 @@ calc_sparsity_hessian_lagrangian(const VectorXd& x,
                         gradient_sparsity);
     }
 
-    // Create GraphColoring objects.
-    m_hescon_coloring.reset(new HessianColoring(hescon_sparsity));
-    m_hesobj_coloring.reset(new HessianColoring(hesobj_sparsity));
-    m_hesobj_coloring->get_coordinate_format(m_hesobj_indices);
-
     // Sparsity of Hessian of Lagrangian.
     // ----------------------------------
     SymmetricSparsityPattern hessian_sparsity = hescon_sparsity;
     hessian_sparsity.add_in_nonzeros(hesobj_sparsity);
 
-    m_hessian_coloring.reset(new HessianColoring(hessian_sparsity));
+    // Create GraphColoring objects.
+    {
+        ScopedTimer coloring_timer(upd_statistics().coloring_time);
+        m_hescon_coloring.reset(new HessianColoring(hescon_sparsity));
+        m_hesobj_coloring.reset(new HessianColoring(hesobj_sparsity));
+        m_hessian_coloring.reset(new HessianColoring(hessian_sparsity));
+    }
+    m_hesobj_coloring->get_coordinate_format(m_hesobj_indices);
     m_hessian_coloring->get_coordinate_format(hessian_sparsity_coordinates);
 
     //hessian_sparsity.write("DEBUG_findiff_hessian_lagrangian_sparsity.csv");
@@ -198,6 +378,9 @@ calc_objective(unsigned num_variables, const double* variables,
         bool /*new_x*/,
         double& obj_value) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_objective_evals;
+    ScopedTimer timer(stats.objective_time);
     // TODO avoid copy.
     const VectorXd xvec = Eigen::Map<const VectorXd>(variables, num_variables);
     m_problem.calc_objective(xvec, obj_value);
@@ -208,6 +391,9 @@ calc_constraints(unsigned num_variables, const double* variables,
         bool /*new_variables*/,
         unsigned num_constraints, double* constr) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_constraints_evals;
+    ScopedTimer timer(stats.constraints_time);
     // TODO avoid copy.
     m_x_working = Eigen::Map<const VectorXd>(variables, num_variables);
     VectorXd constrvec(num_constraints); // TODO avoid copy.
@@ -221,12 +407,23 @@ void Problem<double>::Decorator::
 calc_gradient(unsigned num_variables, const double* x, bool /*new_x*/,
         double* grad) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_gradient_evals;
+    ScopedTimer timer(stats.gradient_time);
     m_x_working = Eigen::Map<const VectorXd>(x, num_variables);
 
     // TODO use a better estimate for this step size.
     const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
     const double two_eps = 2 * eps;
 
+    if (m_problem_provides_gradient) {
+        m_gradient_working.setZero();
+        m_problem.calc_gradient(m_x_working, m_gradient_working);
+        std::copy(m_gradient_working.data(),
+                m_gradient_working.data() + num_variables, grad);
+        return;
+    }
+
     // We only compute the entries that are nonzero, and we must make sure
     // all other entries are 0.
     std::fill(grad, grad + num_variables, 0);
@@ -261,15 +458,70 @@ void Problem<double>::Decorator::
 calc_jacobian(unsigned num_variables, const double* variables, bool /*new_x*/,
         unsigned /*num_nonzeros*/, double* jacobian_values) const
 {
+    auto& stats = upd_statistics();
+    ++stats.num_jacobian_evals;
+    ScopedTimer timer(stats.jacobian_time);
     // TODO give error message that sparsity() must be called first.
 
+    if (m_problem_provides_jacobian) {
+        m_x_working = Eigen::Map<const VectorXd>(variables, num_variables);
+        calc_jacobian_from_problem(m_x_working);
+        // Only the entries in the sparsity pattern are reported.
+        const auto& rows = m_jacobian_coordinates.row;
+        const auto& cols = m_jacobian_coordinates.col;
+        for (int inz = 0; inz < (int)rows.size(); ++inz) {
+            jacobian_values[inz] =
+                    m_jacobian_sparse.coeff(rows[inz], cols[inz]);
+        }
+        return;
+    }
+
+    if (get_jacobian_is_constant()) {
+        std::copy(m_jacobian_constant_values.data(),
+                m_jacobian_constant_values.data() +
+                        m_jacobian_constant_values.size(),
+                jacobian_values);
+        return;
+    }
+
+    // TODO avoid copy.
+    m_x_working = Eigen::Map<const VectorXd>(variables, num_variables);
+
+    if (m_jacobian_variable_coloring) {
+        // Only perturb to obtain the variable entries, then fill in the
+        // constant entries.
+        calc_jacobian_compressed(m_x_working, m_jacobian_variable_seed,
+                m_jacobian_compressed);
+        ScopedTimer recovery_timer(stats.recovery_time);
+        m_jacobian_compressed -= m_jacobian_constant_compressed;
+        m_jacobian_variable_coloring->recover(m_jacobian_compressed,
+                m_jacobian_variable_values.data());
+        std::copy(m_jacobian_constant_values.data(),
+                m_jacobian_constant_values.data() +
+                        m_jacobian_constant_values.size(),
+                jacobian_values);
+        for (int inz = 0; inz < (int)m_jacobian_variable_indices.size();
+                ++inz) {
+            jacobian_values[m_jacobian_variable_indices[inz]] =
+                    m_jacobian_variable_values[inz];
+        }
+        return;
+    }
+
+    calc_jacobian_compressed(m_x_working,
+            m_jacobian_coloring->get_seed_matrix(), m_jacobian_compressed);
+    ScopedTimer recovery_timer(stats.recovery_time);
+    m_jacobian_coloring->recover(m_jacobian_compressed, jacobian_values);
+}
+
+void Problem<double>::Decorator::
+calc_jacobian_compressed(const VectorXd& x0, const Eigen::MatrixXd& seed,
+        Eigen::MatrixXd& jacobian_compressed) const {
     // TODO scale by magnitude of x.
     const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
     const double two_eps = 2 * eps;
     // Number of perturbation directions.
-    const auto& seed = m_jacobian_coloring->get_seed_matrix();
     const Eigen::Index num_seeds = seed.cols();
-    Eigen::Map<const VectorXd> x0(variables, num_variables);
 
     // Compute the dense "compressed Jacobian" using the directions ColPack
     // told us to use.
@@ -277,16 +529,18 @@ calc_jacobian(unsigned num_variables, const double* variables, bool /*new_x*/,
     //#pragma omp parallel for firstprivate(m_constr_pos, m_constr_neg)
     for (Eigen::Index iseed = 0; iseed < num_seeds; ++iseed) {
         const auto direction = seed.col(iseed);
+        if (direction.isZero()) {
+            jacobian_compressed.col(iseed).setZero();
+            continue;
+        }
         // Perturb x in the positive direction.
         m_problem.calc_constraints(x0 + eps * direction, m_constr_pos);
         // Perturb x in the negative direction.
         m_problem.calc_constraints(x0 - eps * direction, m_constr_neg);
         // Compute central difference.
-        m_jacobian_compressed.col(iseed) =
+        jacobian_compressed.col(iseed) =
                 (m_constr_pos - m_constr_neg) / two_eps;
     }
-
-    m_jacobian_coloring->recover(m_jacobian_compressed, jacobian_values);
 }
 
 void Problem<double>::Decorator::
@@ -295,6 +549,9 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x_raw,
         unsigned num_constraints, const double* lambda_raw,
         bool new_lambda,
         unsigned num_hes_nonzeros, double* hessian_values_raw) const {
+    auto& stats = upd_statistics();
+    ++stats.num_hessian_evals;
+    ScopedTimer timer(stats.hessian_time);
 
     // TODO remove this string comparison.
     if (get_findiff_hessian_mode() == "slow") {
@@ -304,17 +561,48 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x_raw,
         return;
     }
 
-    //using namespace std::chrono;
-    //auto start = high_resolution_clock::now();
+    // TODO m_x_working = Eigen::Map<const VectorXd>(xraw, num_variables);
+    Eigen::Map<const VectorXd> x0(x_raw, num_variables);
 
+    Eigen::Map<const VectorXd> lambda(lambda_raw, num_constraints);
+
+    // Hessian of constraints.
+    // -----------------------
+    Eigen::SparseMatrix<double> hessian;
+    if (m_problem_provides_jacobian) {
+        calc_hessian_constraints_from_jacobian(x0, lambda, hessian);
+    } else {
+        calc_hessian_constraints(x0, lambda, hessian);
+    }
 
+    // Add in Hessian of objective.
+    // ----------------------------
+    if (obj_factor) {
+        Eigen::VectorXd hesobj_vec;
+        if (m_problem_provides_gradient) {
+            calc_hessian_objective_from_gradient(x0, hesobj_vec);
+        } else {
+            calc_hessian_objective(x0, hesobj_vec);
+        }
+        Eigen::SparseMatrix<double> hesobj;
+        m_hesobj_coloring->convert(hesobj_vec.data(), hesobj);
+        hessian += obj_factor * hesobj;
+    }
+
+    // Convert the SparseMatrix into coordinate format.
+    m_hessian_coloring->convert(hessian, hessian_values_raw);
+}
+
+void Problem<double>::Decorator::
+calc_hessian_constraints(const VectorXd& x0,
+        const Eigen::Map<const VectorXd>& lambda,
+        Eigen::SparseMatrix<double>& hessian) const {
     // Bohme book has guidelines for step size (section 9.2.4.4).
     const double& eps = get_findiff_hessian_step_size();
     const double eps_squared = eps * eps;
-    // TODO m_x_working = Eigen::Map<const VectorXd>(xraw, num_variables);
-    Eigen::Map<const VectorXd> x0(x_raw, num_variables);
-
-    Eigen::Map<const VectorXd> lambda(lambda_raw, num_constraints);
+    const auto num_variables = x0.size();
+    const auto num_constraints = lambda.size();
+    auto& stats = upd_statistics();
 
     // TODO reuse perturbations between the Jacobian and Hessian calculations
     // (if step size is the same).
@@ -330,8 +618,6 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x_raw,
     const Eigen::Index num_jac_seeds = jac_seed.cols();
     int num_jac_nonzeros = m_jacobian_coloring->get_num_nonzeros();
 
-    // Hessian of constraints.
-    // -----------------------
     // Allocate memory (TODO preallocate once in calc_sparsity()).
     // Compressed Hessian of constraints.
     Eigen::MatrixXd hescon_c(num_variables, num_hescon_seeds);
@@ -362,6 +648,7 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x_raw,
         }
 
         // Recover (uncompress).
+        ScopedTimer recovery_timer(stats.recovery_time);
         Eigen::VectorXd Bgunc_coeffs(num_jac_nonzeros);
         m_jacobian_coloring->recover(hescon_cc, Bgunc_coeffs.data());
         // TODO preallocate:
@@ -373,31 +660,49 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x_raw,
 
     // Convert the compressed Hessian of constraints into a SparseMatrix, for
     // ease of combining with Hessian of objective.
-    Eigen::SparseMatrix<double> hessian;
+    ScopedTimer recovery_timer(stats.recovery_time);
     m_hescon_coloring->recover(hescon_c, hessian);
+}
 
-    //m_time_hescon +=
-    //        duration_cast<duration<double>>(high_resolution_clock::now() -
-    //                start).count();
-    //start = high_resolution_clock::now();
+void Problem<double>::Decorator::
+calc_hessian_constraints_from_jacobian(const VectorXd& x0,
+        const Eigen::Map<const VectorXd>& lambda,
+        Eigen::SparseMatrix<double>& hessian) const {
+    // Each seed is a direction in which we perturb the variables; the
+    // directional derivative of lambda^T * Jacobian in that direction is a
+    // column of the compressed Hessian.
+    const auto& seed = m_hescon_coloring->get_seed_matrix();
+    const auto num_seeds = seed.cols();
+    Eigen::MatrixXd hescon_c(x0.size(), num_seeds);
 
-    // Add in Hessian of objective.
-    // ----------------------------
-    if (obj_factor) {
-        Eigen::VectorXd hesobj_vec;
-        calc_hessian_objective(x0, hesobj_vec);
-        Eigen::SparseMatrix<double> hesobj;
-        m_hesobj_coloring->convert(hesobj_vec.data(), hesobj);
-        hessian += obj_factor * hesobj;
+    const double eps = get_findiff_hessian_step_size();
+    const double two_eps = 2 * eps;
+    VectorXd x(x0);
+    for (Eigen::Index iseed = 0; iseed < num_seeds; ++iseed) {
+        const auto direction = seed.col(iseed);
+        // Perform a central difference.
+        x.noalias() += eps * direction;
+        calc_jacobian_from_problem(x);
+        hescon_c.col(iseed) = m_jacobian_sparse.transpose() * lambda;
+        x.noalias() = x0 - eps * direction;
+        calc_jacobian_from_problem(x);
+        hescon_c.col(iseed) -= m_jacobian_sparse.transpose() * lambda;
+        // Restore the original value.
+        x = x0;
+        hescon_c.col(iseed) /= two_eps;
     }
 
-    //m_time_hesobj +=
-    //        duration_cast<duration<double>>(high_resolution_clock::now() -
-    //                start).count();
-    //std::cout << "DEBUG " << m_time_hescon << " " << m_time_hesobj << std::endl;
+    ScopedTimer recovery_timer(upd_statistics().recovery_time);
+    m_hescon_coloring->recover(hescon_c, hessian);
+}
 
-    // Convert the SparseMatrix into coordinate format.
-    m_hessian_coloring->convert(hessian, hessian_values_raw);
+void Problem<double>::Decorator::
+calc_jacobian_from_problem(const VectorXd& x) const {
+    m_jacobian_triplets.clear();
+    m_problem.calc_jacobian(x, m_jacobian_triplets);
+    m_jacobian_sparse.resize(get_num_constraints(), get_num_variables());
+    m_jacobian_sparse.setFromTriplets(m_jacobian_triplets.begin(),
+            m_jacobian_triplets.end());
 }
 
 void Problem<double>::Decorator::
@@ -484,6 +789,40 @@ calc_hessian_objective(const VectorXd& x0,
     // }
 }
 
+void Problem<double>::Decorator::
+calc_hessian_objective_from_gradient(const VectorXd& x0,
+        VectorXd& hesobj_values) const {
+    // Each seed is a direction in which we perturb the variables; the
+    // directional derivative of the gradient in that direction is a column of
+    // the compressed Hessian.
+    const auto& seed = m_hesobj_coloring->get_seed_matrix();
+    const auto num_seeds = seed.cols();
+    m_hesobj_compressed.resize(x0.size(), num_seeds);
+    m_gradient_pos.resize(x0.size());
+    m_gradient_neg.resize(x0.size());
+
+    const double eps = get_findiff_hessian_step_size();
+    const double two_eps = 2 * eps;
+    VectorXd x(x0);
+    for (Eigen::Index iseed = 0; iseed < num_seeds; ++iseed) {
+        const auto direction = seed.col(iseed);
+        // Perform a central difference.
+        x.noalias() += eps * direction;
+        m_gradient_pos.setZero();
+        m_problem.calc_gradient(x, m_gradient_pos);
+        x.noalias() = x0 - eps * direction;
+        m_gradient_neg.setZero();
+        m_problem.calc_gradient(x, m_gradient_neg);
+        // Restore the original value.
+        x = x0;
+        m_hesobj_compressed.col(iseed) =
+                (m_gradient_pos - m_gradient_neg) / two_eps;
+    }
+
+    hesobj_values.resize(m_hesobj_indices.row.size());
+    m_hesobj_coloring->recover(m_hesobj_compressed, hesobj_values.data());
+}
+
 void Problem<double>::Decorator::
 calc_hessian_lagrangian_slow(unsigned num_variables, const double* x_raw,
         bool /*new_x*/, double obj_factor,
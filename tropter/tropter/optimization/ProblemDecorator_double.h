@@ -73,9 +73,41 @@ private:
 
     void calc_sparsity_hessian_lagrangian(
             const Eigen::VectorXd&, SparsityCoordinates&) const;
-
+    /// Determine which entries of the Jacobian (with coordinates
+    /// jacobian_sparsity_coordinates) are constant, either from the
+    /// declared pattern or (if it is null) by comparing the Jacobian at x
+    /// and at a random iterate, and create m_jacobian_variable_coloring for
+    /// the remaining entries.
+    void calc_sparsity_constant_jacobian(const Eigen::VectorXd& x,
+            const SparsityCoordinates& jacobian_sparsity_coordinates,
+            const SparsityPattern* declared_constant_sparsity) const;
+
+    /// Compute the compressed Jacobian with central differences in the
+    /// direction of each column of the seed; columns of the seed that are
+    /// zero produce zero columns.
+    void calc_jacobian_compressed(const Eigen::VectorXd& x0,
+            const Eigen::MatrixXd& seed,
+            Eigen::MatrixXd& jacobian_compressed) const;
+
+    /// Compute the Hessian of lambda^T * constraints with finite differences
+    /// of the constraints (using m_hescon_coloring and m_jacobian_coloring).
+    void calc_hessian_constraints(const Eigen::VectorXd& x0,
+            const Eigen::Map<const Eigen::VectorXd>& lambda,
+            Eigen::SparseMatrix<double>& hessian) const;
+    /// Compute the Hessian of lambda^T * constraints with finite
+    /// differences of the Jacobian provided by the problem (using
+    /// m_hescon_coloring).
+    void calc_hessian_constraints_from_jacobian(const Eigen::VectorXd& x0,
+            const Eigen::Map<const Eigen::VectorXd>& lambda,
+            Eigen::SparseMatrix<double>& hessian) const;
+    /// Store the Jacobian provided by the problem in m_jacobian_sparse.
+    void calc_jacobian_from_problem(const Eigen::VectorXd& x) const;
     void calc_hessian_objective(const Eigen::VectorXd& x0,
             Eigen::VectorXd& hesobj_values) const;
+    /// Compute the Hessian of the objective with finite differences of the
+    /// gradient provided by the problem (using m_hesobj_coloring).
+    void calc_hessian_objective_from_gradient(const Eigen::VectorXd& x0,
+            Eigen::VectorXd& hesobj_values) const;
     void calc_lagrangian(
             const Eigen::VectorXd& variables,
             double obj_factor,
@@ -96,6 +128,13 @@ private:
     // The indices of the variables used in the objective function
     // (conservative estimate of the indicies of the gradient that are nonzero).
     mutable std::vector<unsigned int> m_gradient_nonzero_indices;
+    // Does the problem compute the gradient itself (Problem::calc_gradient())?
+    mutable bool m_problem_provides_gradient = false;
+    // Working memory.
+    mutable Eigen::VectorXd m_gradient_working;
+    mutable Eigen::VectorXd m_gradient_pos;
+    mutable Eigen::VectorXd m_gradient_neg;
+    mutable Eigen::MatrixXd m_hesobj_compressed;
 
     // Jacobian.
     // ---------
@@ -104,11 +143,37 @@ private:
     // Jacobian (to pass to the optimization solver) after computing finite
     // differences.
     mutable std::unique_ptr<JacobianColoring> m_jacobian_coloring;
+    // Does the problem compute the Jacobian itself (Problem::calc_jacobian())?
+    mutable bool m_problem_provides_jacobian = false;
+    // The coordinates of the Jacobian entries we report, in order.
+    mutable SparsityCoordinates m_jacobian_coordinates;
+    mutable std::vector<Eigen::Triplet<double>> m_jacobian_triplets;
+    mutable Eigen::SparseMatrix<double> m_jacobian_sparse;
     // Working memory.
     // TODO this could be a column vector unless we are using parallelization.
     mutable Eigen::VectorXd m_constr_pos;
     mutable Eigen::VectorXd m_constr_neg;
     mutable Eigen::MatrixXd m_jacobian_compressed;
+    // Constant entries.
+    // The entries of the Jacobian that do not depend on the variables are
+    // computed once, in calc_sparsity(). This coloring is for the remaining
+    // (variable) entries; it is null if there are no constant entries or if
+    // all entries are constant.
+    mutable std::unique_ptr<JacobianColoring> m_jacobian_variable_coloring;
+    // The seed of m_jacobian_variable_coloring, without perturbations of
+    // variables that only appear in constant entries.
+    mutable Eigen::MatrixXd m_jacobian_variable_seed;
+    // The constant part of the compressed Jacobian (the constant entries
+    // times m_jacobian_variable_seed), which we subtract before recovering
+    // the variable entries.
+    mutable Eigen::MatrixXd m_jacobian_constant_compressed;
+    // All entries of the Jacobian, in the coordinate order of
+    // m_jacobian_coloring, with the variable entries set to 0.
+    mutable Eigen::VectorXd m_jacobian_constant_values;
+    // The index among all entries of each entry of
+    // m_jacobian_variable_coloring.
+    mutable std::vector<int> m_jacobian_variable_indices;
+    mutable Eigen::VectorXd m_jacobian_variable_values;
 
     // Hessian/Lagrangian.
     // -------------------
@@ -20,6 +20,11 @@
 #include <tropter/SparsityPattern.h>
 #include <tropter/Exception.hpp>
 
+#include <cmath>
+#include <fstream>
+#include <utility>
+#include <vector>
+
 using Eigen::VectorXd;
 
 using namespace tropter;
@@ -29,6 +34,8 @@ Solver::Solver(
         const AbstractProblem& problem)
         : m_problem(problem.make_decorator()) {}
 
+Solver::~Solver() = default;
+
 void Solver::set_verbosity(int verbosity) {
     TROPTER_VALUECHECK(verbosity == 0 || verbosity == 1,
             "verbosity", verbosity, "0 or 1");
@@ -77,12 +84,39 @@ const std::string& Solver::get_sparsity_detection() const {
     return m_sparsity_detection;
 }
 
+void Solver::set_automatic_scaling(bool v) {
+    m_automatic_scaling = v;
+}
+bool Solver::get_automatic_scaling() const {
+    return m_automatic_scaling;
+}
+
+void Solver::set_iteration_callback(IterationCallback callback) {
+    m_iteration_callback = std::move(callback);
+}
+void Solver::set_iteration_log_file(std::string filepath) {
+    m_iteration_log_file = std::move(filepath);
+}
+const std::string& Solver::get_iteration_log_file() const {
+    return m_iteration_log_file;
+}
+void Solver::set_max_wall_time(Optional<double> v) {
+    TROPTER_VALUECHECK(!v || *v > 0, "max_wall_time", *v, "positive");
+    m_max_wall_time = v;
+}
+Optional<double> Solver::get_max_wall_time() const {
+    return m_max_wall_time;
+}
+
 void Solver::set_findiff_hessian_mode(std::string v) {
     m_problem->set_findiff_hessian_mode(std::move(v));
 }
 void Solver::set_findiff_hessian_step_size(double v) {
     m_problem->set_findiff_hessian_step_size(v);
 }
+void Solver::set_findiff_jacobian_constant_detection(bool v) {
+    m_problem->set_findiff_jacobian_constant_detection(v);
+}
 
 void Solver::print_option_values(std::ostream& stream) const {
     const std::string unset("<unset>");
@@ -108,6 +142,18 @@ void Solver::print_option_values(std::ostream& stream) const {
     else                         stream << unset;
     stream << "\n";
 
+    stream << "  automatic scaling: " << m_automatic_scaling << "\n";
+
+    stream << "  max wall time: ";
+    if (m_max_wall_time) stream << m_max_wall_time.value();
+    else                 stream << unset;
+    stream << "\n";
+
+    stream << "  iteration log file: ";
+    if (!m_iteration_log_file.empty()) stream << m_iteration_log_file;
+    else                               stream << unset;
+    stream << "\n";
+
     std::vector<std::string> available_options_string;
     std::vector<std::string> available_options_int;
     std::vector<std::string> available_options_real;
@@ -171,13 +217,55 @@ Solver::optimize(const Eigen::VectorXd& variables) const
     TROPTER_THROW_IF(variables.size() != m_problem->get_num_variables(),
             "Expected guess to have %i elements, but it has %i elements.",
             m_problem->get_num_variables(), variables.size() );
-    return optimize_impl(variables);
+    m_problem->reset_statistics();
+    Solution solution = optimize_impl(variables);
+    collect_statistics(solution);
+    return solution;
 }
 
 Solution
 Solver::optimize() const {
     m_problem->validate();
-    return optimize_impl(m_problem->make_initial_guess_from_bounds());
+    const VectorXd guess = m_problem->make_initial_guess_from_bounds();
+    m_problem->reset_statistics();
+    Solution solution = optimize_impl(guess);
+    collect_statistics(solution);
+    return solution;
+}
+
+Solution
+Solver::optimize(const Solution& guess) const {
+    m_problem->validate();
+    const auto num_variables = m_problem->get_num_variables();
+    const auto num_constraints = m_problem->get_num_constraints();
+    TROPTER_THROW_IF(guess.variables.size() != num_variables,
+            "Expected guess to have %i elements, but it has %i elements.",
+            num_variables, guess.variables.size());
+    m_problem->reset_statistics();
+    if (!guess.has_multipliers()) {
+        Solution solution = optimize_impl(guess.variables);
+        collect_statistics(solution);
+        return solution;
+    }
+    TROPTER_THROW_IF(
+            guess.variable_lower_multipliers.size() != num_variables ||
+            guess.variable_upper_multipliers.size() != num_variables,
+            "Expected the variable bound multipliers in the guess to have "
+            "%i elements, but they have %i (lower) and %i (upper) elements.",
+            num_variables, guess.variable_lower_multipliers.size(),
+            guess.variable_upper_multipliers.size());
+    TROPTER_THROW_IF(guess.constraint_multipliers.size() != num_constraints,
+            "Expected the constraint multipliers in the guess to have %i "
+            "elements, but they have %i elements.",
+            num_constraints, guess.constraint_multipliers.size());
+    Solution solution = optimize_warm_start_impl(guess);
+    collect_statistics(solution);
+    return solution;
+}
+
+void Solver::collect_statistics(Solution& solution) const {
+    solution.statistics = m_problem->get_statistics();
+    if (m_verbosity) solution.statistics.print();
 }
 
 void Solver::calc_sparsity(const Eigen::VectorXd guess,
@@ -205,3 +293,103 @@ void Solver::calc_sparsity(const Eigen::VectorXd guess,
 
 
 
+
+namespace {
+/// The columns of the iteration log file.
+std::vector<std::pair<const char*, double>> iteration_log_columns(
+        const IterationInfo& info) {
+    return {{"iteration", info.iteration},
+            {"restoration_phase", info.restoration_phase},
+            {"objective", info.objective},
+            {"primal_infeasibility", info.primal_infeasibility},
+            {"dual_infeasibility", info.dual_infeasibility},
+            {"barrier_parameter", info.barrier_parameter},
+            {"step_norm", info.step_norm},
+            {"regularization", info.regularization},
+            {"primal_step_size", info.primal_step_size},
+            {"dual_step_size", info.dual_step_size},
+            {"num_line_search_trials", info.num_line_search_trials},
+            {"elapsed_time", info.elapsed_time},
+            {"objective_time", info.objective_time},
+            {"gradient_time", info.gradient_time},
+            {"constraints_time", info.constraints_time},
+            {"jacobian_time", info.jacobian_time},
+            {"hessian_time", info.hessian_time}};
+}
+} // namespace
+
+void Solver::begin_iteration_monitoring() const {
+    m_iteration_log.reset();
+    if (m_iteration_log_file.empty()) return;
+    m_iteration_log.reset(new std::ofstream(m_iteration_log_file));
+    TROPTER_THROW_IF(!*m_iteration_log, "Could not open iteration log file "
+            "'%s'.", m_iteration_log_file);
+    const std::string json = ".json";
+    m_iteration_log_is_json = m_iteration_log_file.size() > json.size() &&
+            m_iteration_log_file.compare(m_iteration_log_file.size()
+                    - json.size(), json.size(), json) == 0;
+    m_iteration_log_num_rows = 0;
+    m_iteration_log->precision(10);
+    if (m_iteration_log_is_json) {
+        // An array with one object per iteration.
+        *m_iteration_log << "[";
+    } else {
+        const auto columns = iteration_log_columns(IterationInfo());
+        for (int i = 0; i < (int)columns.size(); ++i) {
+            *m_iteration_log << (i ? "," : "") << columns[i].first;
+        }
+        *m_iteration_log << std::endl;
+    }
+}
+
+bool Solver::monitor_iteration(const IterationInfo& info) const {
+    if (m_iteration_log) {
+        const auto columns = iteration_log_columns(info);
+        if (m_iteration_log_is_json) {
+            *m_iteration_log << (m_iteration_log_num_rows ? ",\n {" : "\n {");
+            for (int i = 0; i < (int)columns.size(); ++i) {
+                *m_iteration_log << (i ? ", \"" : "\"") << columns[i].first
+                        << "\": ";
+                // JSON does not have NaN.
+                if (std::isfinite(columns[i].second)) {
+                    *m_iteration_log << columns[i].second;
+                } else {
+                    *m_iteration_log << "null";
+                }
+            }
+            *m_iteration_log << "}";
+        } else {
+            for (int i = 0; i < (int)columns.size(); ++i) {
+                *m_iteration_log << (i ? "," : "") << columns[i].second;
+            }
+            *m_iteration_log << "\n";
+        }
+        ++m_iteration_log_num_rows;
+    }
+    if (m_iteration_callback && !m_iteration_callback(info)) {
+        if (m_verbosity) {
+            std::cout << "[tropter] Iteration callback requested to stop the "
+                    "optimization at iteration " << info.iteration << "."
+                    << std::endl;
+        }
+        return false;
+    }
+    if (m_max_wall_time && info.elapsed_time > m_max_wall_time.value()) {
+        if (m_verbosity) {
+            std::cout << "[tropter] Stopping the optimization because the "
+                    "elapsed time (" << info.elapsed_time << " s) exceeds "
+                    "max_wall_time (" << m_max_wall_time.value() << " s)."
+                    << std::endl;
+        }
+        return false;
+    }
+    return true;
+}
+
+void Solver::end_iteration_monitoring() const {
+    if (m_iteration_log && m_iteration_log_is_json) {
+        *m_iteration_log << "\n]" << std::endl;
+    }
+    // Closes the file.
+    m_iteration_log.reset();
+}
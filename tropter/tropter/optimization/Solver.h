@@ -17,8 +17,11 @@
 // ----------------------------------------------------------------------------
 
 #include <tropter/common.h>
+#include "ProblemDecorator.h"
 #include <Eigen/Dense>
 
+#include <functional>
+#include <iosfwd>
 #include <memory>
 #include <unordered_map>
 
@@ -30,8 +33,6 @@ namespace optimization {
 
 class AbstractProblem;
 
-class ProblemDecorator;
-
 struct Solution {
     Eigen::VectorXd variables;
     double objective = std::numeric_limits<double>::quiet_NaN();
@@ -39,8 +40,68 @@ struct Solution {
     /// Number of solver iterations at which this solution was obtained.
     int num_iterations = -1;
     std::string status;
+    /// @name Multipliers (dual variables)
+    /// These are empty if the solver does not provide them. When used as a
+    /// guess (see Solver::optimize(const Solution&)), empty vectors mean
+    /// that the solver should initialize the multipliers itself.
+    /// @{
+    /// Multipliers for the lower bounds on the variables.
+    Eigen::VectorXd variable_lower_multipliers;
+    /// Multipliers for the upper bounds on the variables.
+    Eigen::VectorXd variable_upper_multipliers;
+    /// Multipliers for the constraints.
+    Eigen::VectorXd constraint_multipliers;
+    /// @}
+    /// The number of calls to, and time spent in, the objective, constraint,
+    /// and derivative functions during the optimization (including sparsity
+    /// detection).
+    EvaluationStatistics statistics;
+    /// Does this solution contain the multipliers for the variable bounds and
+    /// the constraints?
+    bool has_multipliers() const {
+        return variable_lower_multipliers.size() ||
+                variable_upper_multipliers.size() ||
+                constraint_multipliers.size();
+    }
 };
 
+/// Information about one iteration of the optimization solver, provided to
+/// the callback set with Solver::set_iteration_callback() and written to the
+/// file set with Solver::set_iteration_log_file(). The quantities are as
+/// reported by the solver (see IPOPT's documentation for
+/// intermediate_callback()); they are NaN if the solver does not provide them.
+struct IterationInfo {
+    int iteration = -1;
+    /// Is the solver in its restoration phase (trying to reduce the
+    /// infeasibility, ignoring the objective)?
+    bool restoration_phase = false;
+    double objective = std::numeric_limits<double>::quiet_NaN();
+    /// Maximum (unscaled) constraint violation.
+    double primal_infeasibility = std::numeric_limits<double>::quiet_NaN();
+    double dual_infeasibility = std::numeric_limits<double>::quiet_NaN();
+    double barrier_parameter = std::numeric_limits<double>::quiet_NaN();
+    /// Infinity norm of the primal step.
+    double step_norm = std::numeric_limits<double>::quiet_NaN();
+    double regularization = std::numeric_limits<double>::quiet_NaN();
+    double primal_step_size = std::numeric_limits<double>::quiet_NaN();
+    double dual_step_size = std::numeric_limits<double>::quiet_NaN();
+    int num_line_search_trials = -1;
+    /// @name Wall-clock time (seconds)
+    /// The time spent in each function is cumulative since the start of the
+    /// optimization.
+    /// @{
+    double elapsed_time = 0;
+    double objective_time = 0;
+    double gradient_time = 0;
+    double constraints_time = 0;
+    double jacobian_time = 0;
+    double hessian_time = 0;
+    /// @}
+};
+
+/// Return false to stop the optimization.
+using IterationCallback = std::function<bool(const IterationInfo&)>;
+
 /// The OptimizationSolver class contains some generic options that are
 /// common across different concrete solvers. To learn how the different
 /// solves interpret these generic options, view the documentaiton for the
@@ -51,7 +112,7 @@ class Solver {
 public:
     /// Provide the problem to solve.
     Solver(const AbstractProblem& problem);
-    virtual ~Solver() = default;
+    virtual ~Solver();
     /// Optimize the optimization problem.
     /// @param[in] guess
     ///     Initial guess to the problem; the length must match the number of
@@ -66,6 +127,13 @@ public:
     /// OptimizationProblemProxy::make_initial_guess_from_bounds()).
     /// @returns The value of the objective function evaluated at the solution.
     Solution optimize() const;
+    /// Optimize the optimization problem, starting from a previous solution
+    /// (warm start). The variables in the guess are used as the initial
+    /// guess; if the guess also contains multipliers, solvers that support
+    /// warm starts (IPOPTSolver) use them to initialize the dual variables.
+    /// The multipliers must either all be empty or all have the correct
+    /// length.
+    Solution optimize(const Solution& guess) const;
 
     /// @name Set common options
     /// @{
@@ -94,10 +162,39 @@ public:
     ///   - "random": perturb about a random point.
     void set_sparsity_detection(std::string v);
 
+    /// Scale the variables, constraints, and objective using factors
+    /// computed from the variable bounds and the Jacobian at the initial
+    /// guess (see ProblemDecorator::calc_automatic_scaling()). The scaling
+    /// is applied within the solver; the problem's functions and the
+    /// solution are not affected. Currently, this is only used by
+    /// IPOPTSolver, for which this sets "nlp_scaling_method" to
+    /// "user-scaling" (default: false).
+    void set_automatic_scaling(bool value);
+
+    /// Provide a function that is called at the end of each iteration of the
+    /// optimization solver. Return false from the function to stop the
+    /// optimization (e.g., if the infeasibility has stalled); the solution
+    /// is then unsuccessful. Currently, this is only used by IPOPTSolver.
+    void set_iteration_callback(IterationCallback callback);
+    /// Write the IterationInfo for each iteration to a file with this name:
+    /// a JSON array of objects if the name ends with ".json" (with null for
+    /// NaN), and CSV otherwise. Set to an empty string (default) to not write
+    /// a file.
+    /// Currently, this is only used by IPOPTSolver.
+    void set_iteration_log_file(std::string filepath);
+    /// Stop the optimization if it has taken longer than this many seconds
+    /// of wall-clock time; the solution is then unsuccessful. This is
+    /// checked at the end of each iteration. Unlike IPOPT's max_cpu_time,
+    /// this measures elapsed time. Currently, this is only used by
+    /// IPOPTSolver.
+    void set_max_wall_time(Optional<double> seconds);
+
     /// @copydoc ProblemDecorator::set_findiff_hessian_mode()
     void set_findiff_hessian_mode(std::string v);
     /// @copydoc ProblemDecorator::set_findiff_hessian_step_size()
     void set_findiff_hessian_step_size(double value);
+    /// @copydoc ProblemDecorator::set_findiff_jacobian_constant_detection()
+    void set_findiff_jacobian_constant_detection(bool value);
     /// @}
 
     /// @name Set solver-specific advanced options.
@@ -138,10 +235,20 @@ public:
     /// @copydoc set_hessian_approximation()
     Optional<std::string> get_hessian_approximation() const;
     const std::string& get_sparsity_detection() const;
+    /// @copydoc set_automatic_scaling()
+    bool get_automatic_scaling() const;
+    /// @copydoc set_iteration_log_file()
+    const std::string& get_iteration_log_file() const;
+    /// @copydoc set_max_wall_time()
+    Optional<double> get_max_wall_time() const;
     /// @}
 
 protected:
     virtual Solution optimize_impl(const Eigen::VectorXd& guess) const = 0;
+    /// Solvers that can make use of the multipliers in the guess should
+    /// override this function. By default, the multipliers are ignored.
+    virtual Solution optimize_warm_start_impl(const Solution& guess) const
+    {   return optimize_impl(guess.variables); }
     virtual void get_available_options(
             std::vector<std::string>& options_string,
             std::vector<std::string>& options_int,
@@ -160,6 +267,16 @@ protected:
             SparsityCoordinates& jacobian_sparsity,
             bool provide_hessian_sparsity,
             SparsityCoordinates& hessian_sparsity) const;
+
+    /// Call this before the first iteration; this opens the iteration log
+    /// file, if any.
+    void begin_iteration_monitoring() const;
+    /// Call this at the end of each iteration. This writes to the iteration
+    /// log file, invokes the iteration callback, and checks the wall time.
+    /// @returns false if the optimization should stop.
+    bool monitor_iteration(const IterationInfo& info) const;
+    /// Call this after the optimization; this closes the iteration log file.
+    void end_iteration_monitoring() const;
     /// @}
 
 
@@ -178,12 +295,23 @@ protected:
     {   return m_advanced_options_real; }
 
 private:
-    int m_verbosity;
+    /// Copy the problem's evaluation statistics into the solution, and print
+    /// them if verbose.
+    void collect_statistics(Solution& solution) const;
+
+    int m_verbosity = 1;
     Optional<int> m_max_iterations;
     Optional<double> m_convergence_tolerance;
     Optional<double> m_constraint_tolerance;
     Optional<std::string> m_hessian_approximation;
     std::string m_sparsity_detection = "initial-guess";
+    bool m_automatic_scaling = false;
+    IterationCallback m_iteration_callback;
+    std::string m_iteration_log_file;
+    Optional<double> m_max_wall_time;
+    mutable std::unique_ptr<std::ofstream> m_iteration_log;
+    mutable bool m_iteration_log_is_json = false;
+    mutable int m_iteration_log_num_rows = 0;
 
     OptionsMap<std::string> m_advanced_options_string;
     OptionsMap<int> m_advanced_options_int;
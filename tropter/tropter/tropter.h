@@ -25,11 +25,13 @@
 #include "tropter/optimization/AbstractProblem.h"
 #include "tropter/optimization/Problem.h"
 #include "tropter/optimization/Solver.h"
+#include "tropter/optimization/PresolvedProblem.h"
 #include "optimization/SNOPTSolver.h"
 #include "optimization/IPOPTSolver.h"
 
 #include "tropter/optimalcontrol/Iterate.h"
 #include "tropter/optimalcontrol/Problem.h"
+#include "tropter/optimalcontrol/StaticProblem.h"
 #include "optimalcontrol/DirectCollocation.h"
 
 #include "optimalcontrol/transcription/Trapezoidal.h"
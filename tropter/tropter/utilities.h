@@ -16,12 +16,30 @@
 // limitations under the License.
 // ----------------------------------------------------------------------------
 
+#include <chrono>
 #include <string>
 
 namespace tropter {
 /// Format a string in the style of sprintf.
 std::string format(const char* format, ...);
 
+/// Add the wall-clock time (in seconds) between the construction and
+/// destruction of this object to the provided total. This is cheap enough to
+/// use for profiling every call to a solver callback.
+class ScopedTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+    explicit ScopedTimer(double& total)
+            : m_total(total), m_start(Clock::now()) {}
+    ~ScopedTimer() {
+        m_total += std::chrono::duration<double>(
+                Clock::now() - m_start).count();
+    }
+private:
+    double& m_total;
+    Clock::time_point m_start;
+};
+
 } //namespace tropter
 
 #endif // TROPTER_UTILITIES_H_